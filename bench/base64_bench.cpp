@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <QByteArray>
+#include <QString>
+
+#include "protocol/base64_codec.h"
+#include "simd/base64.h"
+
+namespace {
+
+QByteArray makeImage(int size)
+{
+    QByteArray image(size, Qt::Uninitialized);
+    for (int i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<char>((i * 131 + (i >> 7)) & 0xFF);
+    }
+    return image;
+}
+
+void imageSizes(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->Arg(100 * 1024)->Arg(1024 * 1024)->Arg(5 * 1024 * 1024);
+}
+
+void BM_Base64EncodeQt(benchmark::State& state)
+{
+    const QByteArray image = makeImage(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(QString::fromLatin1(image.toBase64()));
+    }
+    state.SetBytesProcessed(state.iterations() * image.size());
+}
+BENCHMARK(BM_Base64EncodeQt)->Apply(imageSizes);
+
+void BM_Base64EncodeCodec(benchmark::State& state)
+{
+    const QByteArray image = makeImage(static_cast<int>(state.range(0)));
+    state.SetLabel(common::simd::base64KernelName());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(common::Base64Codec::encodeToString(image));
+    }
+    state.SetBytesProcessed(state.iterations() * image.size());
+}
+BENCHMARK(BM_Base64EncodeCodec)->Apply(imageSizes);
+
+void BM_Base64DecodeQt(benchmark::State& state)
+{
+    const QByteArray image = makeImage(static_cast<int>(state.range(0)));
+    const QString encoded = QString::fromLatin1(image.toBase64());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(QByteArray::fromBase64(encoded.toLatin1()));
+    }
+    state.SetBytesProcessed(state.iterations() * image.size());
+}
+BENCHMARK(BM_Base64DecodeQt)->Apply(imageSizes);
+
+void BM_Base64DecodeCodec(benchmark::State& state)
+{
+    const QByteArray image = makeImage(static_cast<int>(state.range(0)));
+    const QString encoded = common::Base64Codec::encodeToString(image);
+    state.SetLabel(common::simd::base64KernelName());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(common::Base64Codec::decode(encoded));
+    }
+    state.SetBytesProcessed(state.iterations() * image.size());
+}
+BENCHMARK(BM_Base64DecodeCodec)->Apply(imageSizes);
+
+}
@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+#include "protocol/ad_create_message.h"
+#include "protocol/json_frame_parser.h"
+#include "protocol/message.h"
+#include "simd/json_scan.h"
+
+namespace {
+
+QByteArray makeAdCreateFrame(int imageBytes)
+{
+    QByteArray image(imageBytes, Qt::Uninitialized);
+    for (int i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<char>((i * 131) & 0xFF);
+    }
+    common::Message message = common::AdCreateMessage::createRequest(QStringLiteral("Benchmark camera"),
+                                                                     QStringLiteral("Mirrorless body with two lenses"),
+                                                                     QStringLiteral("Electronics"),
+                                                                     1200,
+                                                                     image);
+    message.setSessionToken(QStringLiteral("00000000-0000-0000-0000-000000000000"));
+    return message.serialize();
+}
+
+void BM_FrameParseQJsonDocument(benchmark::State& state)
+{
+    const QByteArray frame = makeAdCreateFrame(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(frame, &error);
+        benchmark::DoNotOptimize(doc.object());
+    }
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_FrameParseQJsonDocument)->Arg(0)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+void BM_FrameParseJsonFrameParser(benchmark::State& state)
+{
+    const QByteArray frame = makeAdCreateFrame(static_cast<int>(state.range(0)));
+    state.SetLabel(common::simd::jsonScanKernelName());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(common::JsonFrameParser::parseObjectFast(frame.constData(), frame.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_FrameParseJsonFrameParser)->Arg(0)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+}
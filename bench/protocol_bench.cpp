@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStringList>
+
+#include "protocol/command_utils.h"
+#include "protocol/message.h"
+
+namespace {
+
+common::Message makeAdListResponse(int adCount)
+{
+    QJsonArray ads;
+    for (int i = 0; i < adCount; ++i) {
+        ads.append(QJsonObject{{QStringLiteral("id"), i + 1},
+                               {QStringLiteral("title"), QStringLiteral("Advertisement %1").arg(i)},
+                               {QStringLiteral("category"), QStringLiteral("Electronics")},
+                               {QStringLiteral("priceTokens"), 100 + i},
+                               {QStringLiteral("sellerUsername"), QStringLiteral("seller%1").arg(i % 17)},
+                               {QStringLiteral("status"), QStringLiteral("approved")},
+                               {QStringLiteral("createdAt"), QStringLiteral("2024-01-01 10:00:00")},
+                               {QStringLiteral("updatedAt"), QStringLiteral("2024-01-01 10:00:00")},
+                               {QStringLiteral("hasImage"), i % 2 == 0}});
+    }
+
+    return common::Message::makeSuccess(common::Command::AdListResult,
+                                        QJsonObject{{QStringLiteral("ads"), ads},
+                                                    {QStringLiteral("count"), adCount}},
+                                        QStringLiteral("req-1"),
+                                        QStringLiteral("00000000-0000-0000-0000-000000000000"),
+                                        QStringLiteral("Advertisements loaded"));
+}
+
+void BM_MessageSerialize(benchmark::State& state)
+{
+    const common::Message message = makeAdListResponse(static_cast<int>(state.range(0)));
+    qint64 bytes = 0;
+    for (auto _ : state) {
+        const QByteArray serialized = message.serialize();
+        bytes += serialized.size();
+        benchmark::DoNotOptimize(serialized.constData());
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_MessageSerialize)->Arg(1)->Arg(50)->Arg(500);
+
+void BM_MessageDeserialize(benchmark::State& state)
+{
+    const QByteArray serialized = makeAdListResponse(static_cast<int>(state.range(0))).serialize();
+    for (auto _ : state) {
+        auto message = common::Message::deserialize(serialized);
+        benchmark::DoNotOptimize(message);
+    }
+    state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+BENCHMARK(BM_MessageDeserialize)->Arg(1)->Arg(50)->Arg(500);
+
+void BM_CommandFromString(benchmark::State& state)
+{
+    QStringList commandStrings;
+    for (int value = static_cast<int>(common::Command::Unknown);
+         value <= static_cast<int>(common::Command::SystemNotification);
+         ++value) {
+        commandStrings.append(common::commandToString(static_cast<common::Command>(value)));
+    }
+
+    for (auto _ : state) {
+        for (const QString& commandString : std::as_const(commandStrings)) {
+            benchmark::DoNotOptimize(common::commandFromString(commandString));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * commandStrings.size());
+}
+BENCHMARK(BM_CommandFromString);
+
+}
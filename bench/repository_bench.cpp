@@ -0,0 +1,470 @@
+#include <benchmark/benchmark.h>
+
+#include <QDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+#include <iterator>
+#include <map>
+#include <memory>
+
+#include "ads/catalog_index.h"
+#include "ads/catalog_version.h"
+#include "protocol/base64_codec.h"
+#include "repository/sqlite_ad_repository.h"
+#include "repository/sqlite_wallet_repository.h"
+#include "simd/column_filter.h"
+
+namespace {
+
+constexpr int kSeededAdCount = 2000;
+constexpr int kSeededUserCount = 50;
+constexpr int kTopUpsPerUser = 20;
+
+const char* const kCategories[] = {"Electronics", "Home", "Clothing", "Books", "Sports"};
+
+struct RepositoryFixture {
+    QTemporaryDir directory;
+    CatalogVersion catalogVersion;
+    std::unique_ptr<SqliteAdRepository> adRepository;
+    std::unique_ptr<SqliteWalletRepository> walletRepository;
+    QVector<int> adIds;
+
+    RepositoryFixture()
+    {
+        const QString databasePath = QDir(directory.path()).filePath(QStringLiteral("bench.db"));
+        adRepository = std::make_unique<SqliteAdRepository>(databasePath, &catalogVersion);
+        walletRepository = std::make_unique<SqliteWalletRepository>(databasePath, &catalogVersion);
+
+        const QByteArray imageBytes(4096, '\x7f');
+        adIds.reserve(kSeededAdCount);
+        for (int i = 0; i < kSeededAdCount; ++i) {
+            AdRepository::NewAd ad;
+            ad.title = QStringLiteral("Benchmark item %1").arg(i);
+            ad.description = QStringLiteral("Seeded advertisement used by kalanet_bench");
+            ad.category = QString::fromLatin1(kCategories[i % std::size(kCategories)]);
+            ad.priceTokens = 10 + (i * 37) % 5000;
+            ad.sellerUsername = QStringLiteral("seller%1").arg(i % kSeededUserCount);
+            ad.imageBytes = i % 3 == 0 ? imageBytes : QByteArray();
+
+            const int adId = adRepository->createPendingAd(ad);
+            if (i % 10 != 0) {
+                adRepository->updateStatus(adId, AdRepository::AdModerationStatus::Approved, QStringLiteral("seed"));
+            }
+            adIds.append(adId);
+        }
+
+        for (int user = 0; user < kSeededUserCount; ++user) {
+            for (int i = 0; i < kTopUpsPerUser; ++i) {
+                walletRepository->topUp(QStringLiteral("buyer%1").arg(user), 100);
+            }
+        }
+    }
+};
+
+RepositoryFixture& repositoryFixture()
+{
+    static RepositoryFixture fixture;
+    return fixture;
+}
+
+constexpr int kLargeImageAdCount = 10000;
+constexpr int kLargeImageBytes = 500 * 1024;
+
+// Catalog shaped like production: every approved ad carries a 500 KB image,
+// kept in the image store beside the database rather than in the ads table.
+struct LargeImageFixture {
+    QTemporaryDir directory;
+    CatalogVersion catalogVersion;
+    std::unique_ptr<SqliteAdRepository> adRepository;
+    QString connectionName = QStringLiteral("kalanet_bench_large_images");
+
+    LargeImageFixture()
+    {
+        const QString databasePath = QDir(directory.path()).filePath(QStringLiteral("large_images.db"));
+        adRepository = std::make_unique<SqliteAdRepository>(databasePath, &catalogVersion);
+
+        QByteArray imageBytes(kLargeImageBytes, '\0');
+        for (int i = 0; i < kLargeImageAdCount; ++i) {
+            imageBytes[0] = static_cast<char>(i);
+            imageBytes[1] = static_cast<char>(i >> 8);
+
+            AdRepository::NewAd ad;
+            ad.title = QStringLiteral("Large image item %1").arg(i);
+            ad.description = QStringLiteral("Seeded advertisement with a full-size image");
+            ad.category = QString::fromLatin1(kCategories[i % std::size(kCategories)]);
+            ad.priceTokens = 10 + (i * 37) % 5000;
+            ad.sellerUsername = QStringLiteral("seller%1").arg(i % kSeededUserCount);
+            ad.imageBytes = imageBytes;
+            adRepository->createPendingAd(ad);
+        }
+
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+        db.setDatabaseName(databasePath);
+        db.open();
+        QSqlQuery approve(db);
+        approve.exec(QStringLiteral("UPDATE ads SET status = 'approved';"));
+    }
+
+    ~LargeImageFixture()
+    {
+        QSqlDatabase::database(connectionName).close();
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+};
+
+LargeImageFixture& largeImageFixture()
+{
+    static LargeImageFixture fixture;
+    return fixture;
+}
+
+// Text-only catalog for search benchmarks, bulk-loaded through a raw
+// connection so the FTS triggers index every row. Titles mix a handful of
+// common words; every description carries a unique sku token.
+struct SearchFixture {
+    QTemporaryDir directory;
+    std::unique_ptr<SqliteAdRepository> adRepository;
+    QString connectionName;
+
+    explicit SearchFixture(int adCount)
+        : connectionName(QStringLiteral("kalanet_bench_search_%1").arg(adCount))
+    {
+        const QString databasePath = QDir(directory.path()).filePath(QStringLiteral("search.db"));
+        adRepository = std::make_unique<SqliteAdRepository>(databasePath);
+
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+        db.setDatabaseName(databasePath);
+        db.open();
+        QSqlQuery categories(db);
+        categories.exec(QStringLiteral(
+            "INSERT OR IGNORE INTO categories (name) "
+            "VALUES ('Electronics'), ('Home'), ('Clothing'), ('Books'), ('Sports');"));
+
+        QSqlQuery seed(db);
+        seed.prepare(QStringLiteral(
+            "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < :count), "
+            "seeded(i, category) AS ("
+            "    SELECT i, CASE i % 5 WHEN 0 THEN 'Electronics' WHEN 1 THEN 'Home' WHEN 2 THEN 'Clothing' "
+            "                         WHEN 3 THEN 'Books' ELSE 'Sports' END FROM n) "
+            "INSERT INTO ads (title, description, category, category_id, price_tokens, seller_username, status) "
+            "SELECT 'Item ' || i || ' ' "
+            "       || CASE i % 7 WHEN 0 THEN 'vintage' WHEN 1 THEN 'leather' WHEN 2 THEN 'wireless' "
+            "                     WHEN 3 THEN 'wooden' WHEN 4 THEN 'compact' WHEN 5 THEN 'classic' ELSE 'portable' END "
+            "       || ' ' "
+            "       || CASE i % 5 WHEN 0 THEN 'lamp' WHEN 1 THEN 'chair' WHEN 2 THEN 'headphones' "
+            "                     WHEN 3 THEN 'jacket' ELSE 'camera' END, "
+            "       'Seeded listing sku' || i || ' in good condition', "
+            "       category, (SELECT id FROM categories WHERE name = category), "
+            "       10 + (i * 37) % 5000, 'seller' || (i % 50), 'approved' "
+            "FROM seeded;"));
+        seed.bindValue(QStringLiteral(":count"), adCount);
+        db.transaction();
+        seed.exec();
+        db.commit();
+    }
+
+    ~SearchFixture()
+    {
+        QSqlDatabase::database(connectionName).close();
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+};
+
+SearchFixture& searchFixture(int adCount)
+{
+    static std::map<int, std::unique_ptr<SearchFixture>> fixtures;
+    auto& fixture = fixtures[adCount];
+    if (!fixture) {
+        fixture = std::make_unique<SearchFixture>(adCount);
+    }
+    return *fixture;
+}
+
+QString searchTerm(int kind)
+{
+    return kind == 0 ? QStringLiteral("sku4242") : QStringLiteral("wirel");
+}
+
+void BM_AdListApproved(benchmark::State& state)
+{
+    RepositoryFixture& fixture = repositoryFixture();
+    AdRepository::AdListFilters filters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.adRepository->listApprovedAds(filters));
+    }
+}
+BENCHMARK(BM_AdListApproved)->Unit(benchmark::kMillisecond);
+
+void BM_AdListApprovedFiltered(benchmark::State& state)
+{
+    RepositoryFixture& fixture = repositoryFixture();
+    AdRepository::AdListFilters filters;
+    filters.nameContains = QStringLiteral("item 1");
+    filters.category = QStringLiteral("Books");
+    filters.minPriceTokens = 100;
+    filters.maxPriceTokens = 4000;
+    filters.sortField = AdRepository::AdListSortField::PriceTokens;
+    filters.sortOrder = AdRepository::SortOrder::Asc;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.adRepository->listApprovedAds(filters));
+    }
+}
+BENCHMARK(BM_AdListApprovedFiltered)->Unit(benchmark::kMillisecond);
+
+// Detail path for one image-bearing ad: the row lookup, the mapped image and
+// the base64 encoding the response carries.
+void BM_AdDetailLargeImage(benchmark::State& state)
+{
+    LargeImageFixture& fixture = largeImageFixture();
+    int adId = 0;
+    for (auto _ : state) {
+        adId = adId % kLargeImageAdCount + 1;
+        const auto ad = fixture.adRepository->findApprovedAdById(adId);
+        const auto image = fixture.adRepository->openImage(ad->imageSha256);
+        benchmark::DoNotOptimize(common::Base64Codec::encodeToString(image->bytes()));
+    }
+    state.SetBytesProcessed(state.iterations() * kLargeImageBytes);
+}
+BENCHMARK(BM_AdDetailLargeImage)->Unit(benchmark::kMicrosecond);
+
+void BM_AdListApprovedLargeImages(benchmark::State& state)
+{
+    LargeImageFixture& fixture = largeImageFixture();
+    AdRepository::AdListFilters filters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.adRepository->listApprovedAds(filters));
+    }
+    state.SetItemsProcessed(state.iterations() * kLargeImageAdCount);
+}
+BENCHMARK(BM_AdListApprovedLargeImages)->Unit(benchmark::kMillisecond);
+
+// One 50-row page that starts state.range(0) rows into the 10k catalog; the
+// keyset cursor keeps the cost flat with depth.
+void BM_AdListApprovedPage(benchmark::State& state)
+{
+    LargeImageFixture& fixture = largeImageFixture();
+    AdRepository::AdListFilters filters;
+    filters.sortField = AdRepository::AdListSortField::PriceTokens;
+    filters.limit = static_cast<int>(state.range(0));
+    if (filters.limit > 0) {
+        const auto prefix = fixture.adRepository->listApprovedAds(filters);
+        filters.after = AdRepository::AdListCursor{prefix.constLast().priceTokens, prefix.constLast().id};
+    }
+
+    filters.limit = 50;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.adRepository->listApprovedAds(filters));
+    }
+    state.SetItemsProcessed(state.iterations() * filters.limit);
+}
+BENCHMARK(BM_AdListApprovedPage)->Arg(0)->Arg(2500)->Arg(9900);
+
+// Search as it worked before FTS: substring LIKE on title and description,
+// newest first. range(0) is the catalog size, range(1) picks a rare (0) or
+// common (1) term.
+void BM_AdSearchLike(benchmark::State& state)
+{
+    SearchFixture& fixture = searchFixture(static_cast<int>(state.range(0)));
+    QSqlDatabase db = QSqlDatabase::database(fixture.connectionName);
+    const QString pattern = QStringLiteral("%") + searchTerm(static_cast<int>(state.range(1))) + QStringLiteral("%");
+    for (auto _ : state) {
+        QSqlQuery query(db);
+        query.prepare(QStringLiteral(
+            "SELECT id, title, category, price_tokens, seller_username, status, created_at, updated_at "
+            "FROM ads WHERE status = 'approved' AND (title LIKE :text OR description LIKE :text) "
+            "ORDER BY created_at DESC, id DESC LIMIT 51;"));
+        query.bindValue(QStringLiteral(":text"), pattern);
+        query.exec();
+        int rows = 0;
+        while (query.next()) {
+            ++rows;
+        }
+        benchmark::DoNotOptimize(rows);
+    }
+}
+BENCHMARK(BM_AdSearchLike)
+    ->Args({100000, 0})->Args({100000, 1})->Args({1000000, 0})->Args({1000000, 1})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_AdSearchFullText(benchmark::State& state)
+{
+    SearchFixture& fixture = searchFixture(static_cast<int>(state.range(0)));
+    AdRepository::AdListFilters filters;
+    filters.nameContains = searchTerm(static_cast<int>(state.range(1)));
+    filters.sortField = AdRepository::AdListSortField::Relevance;
+    filters.limit = 51;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.adRepository->listApprovedAds(filters));
+    }
+}
+BENCHMARK(BM_AdSearchFullText)
+    ->Args({100000, 0})->Args({100000, 1})->Args({1000000, 0})->Args({1000000, 1})
+    ->Unit(benchmark::kMillisecond);
+
+struct CatalogIndexFixture {
+    CatalogIndex index;
+
+    CatalogIndexFixture()
+    {
+        index.load(*searchFixture(1000000).adRepository);
+    }
+};
+
+CatalogIndex& catalogIndex()
+{
+    static CatalogIndexFixture fixture;
+    return fixture.index;
+}
+
+// range(0): 0 = newest first, 1 = one category by price, 2 = one category in
+// a narrow price band.
+AdRepository::AdListFilters catalogListFilters(int kind)
+{
+    AdRepository::AdListFilters filters;
+    filters.limit = 51;
+    if (kind >= 1) {
+        filters.category = QStringLiteral("Books");
+        filters.sortField = AdRepository::AdListSortField::PriceTokens;
+        filters.sortOrder = AdRepository::SortOrder::Asc;
+    }
+    if (kind == 2) {
+        filters.minPriceTokens = 1200;
+        filters.maxPriceTokens = 1210;
+    }
+    return filters;
+}
+
+void BM_AdListApprovedSql(benchmark::State& state)
+{
+    SearchFixture& fixture = searchFixture(1000000);
+    const AdRepository::AdListFilters filters = catalogListFilters(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.adRepository->listApprovedAds(filters));
+    }
+}
+BENCHMARK(BM_AdListApprovedSql)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+void BM_CatalogIndexList(benchmark::State& state)
+{
+    CatalogIndex& index = catalogIndex();
+    const AdRepository::AdListFilters filters = catalogListFilters(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.list(filters));
+    }
+    state.SetLabel(common::simd::columnFilterKernelName());
+}
+BENCHMARK(BM_CatalogIndexList)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+// Same pages with category and price-bucket counts over the 1M-row catalog.
+void BM_CatalogIndexListWithFacets(benchmark::State& state)
+{
+    CatalogIndex& index = catalogIndex();
+    const AdRepository::AdListFilters filters = catalogListFilters(static_cast<int>(state.range(0)));
+    AdRepository::AdListFacets facets;
+    facets.priceBounds = {100, 500, 1000, 5000};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.list(filters, &facets));
+    }
+}
+BENCHMARK(BM_CatalogIndexListWithFacets)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
+
+// SQL fallback for text searches, which the index does not serve.
+void BM_AdCountFacetsSql(benchmark::State& state)
+{
+    SearchFixture& fixture = searchFixture(1000000);
+    AdRepository::AdListFilters filters;
+    filters.nameContains = searchTerm(1);
+    AdRepository::AdListFacets facets;
+    facets.priceBounds = {100, 500, 1000, 5000};
+    for (auto _ : state) {
+        fixture.adRepository->countApprovedFacets(filters, facets);
+        benchmark::DoNotOptimize(facets.priceBucketCounts.data());
+    }
+}
+BENCHMARK(BM_AdCountFacetsSql)->Unit(benchmark::kMillisecond);
+
+void BM_AdFindApprovedById(benchmark::State& state)
+{
+    RepositoryFixture& fixture = repositoryFixture();
+    int index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.adRepository->findApprovedAdById(fixture.adIds.at(index % fixture.adIds.size())));
+        ++index;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AdFindApprovedById);
+
+// One shop page of ads: N single-row lookups against one IN (...) multi-get.
+void BM_AdDetailPageOneByOne(benchmark::State& state)
+{
+    RepositoryFixture& fixture = repositoryFixture();
+    const QVector<int> page = fixture.adIds.mid(0, static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        for (const int adId : page) {
+            benchmark::DoNotOptimize(fixture.adRepository->findApprovedAdById(adId));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * page.size());
+}
+BENCHMARK(BM_AdDetailPageOneByOne)->Arg(50)->Unit(benchmark::kMicrosecond);
+
+void BM_AdDetailPageMultiGet(benchmark::State& state)
+{
+    RepositoryFixture& fixture = repositoryFixture();
+    const QVector<int> page = fixture.adIds.mid(0, static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            fixture.adRepository->findAdsByIds(page, AdRepository::AdFieldSet::Detail, true));
+    }
+    state.SetItemsProcessed(state.iterations() * page.size());
+}
+BENCHMARK(BM_AdDetailPageMultiGet)->Arg(50)->Unit(benchmark::kMicrosecond);
+
+// Steady state for the statement cache: every call after the first reuses
+// the prepared wallet statements, so hit_rate should sit at ~1.
+void BM_WalletGetBalance(benchmark::State& state)
+{
+    RepositoryFixture& fixture = repositoryFixture();
+    QStringList usernames;
+    for (int user = 0; user < kSeededUserCount; ++user) {
+        usernames.append(QStringLiteral("buyer%1").arg(user));
+    }
+
+    const StatementCache::Stats before = fixture.walletRepository->statementStats();
+    int index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.walletRepository->getBalance(usernames.at(index % kSeededUserCount)));
+        ++index;
+    }
+    const StatementCache::Stats after = fixture.walletRepository->statementStats();
+
+    const double lookups = static_cast<double>((after.hits - before.hits) + (after.misses - before.misses));
+    state.counters["hit_rate"] = lookups > 0 ? static_cast<double>(after.hits - before.hits) / lookups : 0.0;
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WalletGetBalance);
+
+void BM_WalletTransactionHistory(benchmark::State& state)
+{
+    RepositoryFixture& fixture = repositoryFixture();
+    int index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.walletRepository->transactionHistory(QStringLiteral("buyer%1").arg(index % kSeededUserCount), 100));
+        ++index;
+    }
+}
+BENCHMARK(BM_WalletTransactionHistory);
+
+void BM_WalletValidateDiscountCode(benchmark::State& state)
+{
+    RepositoryFixture& fixture = repositoryFixture();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.walletRepository->validateDiscountCode(QStringLiteral("OFF10"), 1000));
+    }
+}
+BENCHMARK(BM_WalletValidateDiscountCode);
+
+}
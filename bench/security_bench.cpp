@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include "security/captcha_service.h"
+#include "security/password_hasher.h"
+#include "simd/sha256.h"
+
+namespace {
+
+void BM_PasswordHash(benchmark::State& state)
+{
+    const QString password = QStringLiteral("correct horse battery staple");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHasher::hash(password));
+    }
+}
+BENCHMARK(BM_PasswordHash)->Unit(benchmark::kMillisecond);
+
+void BM_PasswordVerify(benchmark::State& state)
+{
+    const QString password = QStringLiteral("correct horse battery staple");
+    const QString stored = PasswordHasher::hash(password);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHasher::verify(password, stored));
+    }
+}
+BENCHMARK(BM_PasswordVerify)->Unit(benchmark::kMillisecond);
+
+void BM_PasswordVerifyLegacy(benchmark::State& state)
+{
+    const QString password = QStringLiteral("correct horse battery staple");
+    const QString stored = QStringLiteral("knet_sha256$120000$000102030405060708090a0b0c0d0e0f$"
+                                          "00000000000000000000000000000000"
+                                          "00000000000000000000000000000000");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHasher::verify(password, stored));
+    }
+}
+BENCHMARK(BM_PasswordVerifyLegacy)->Unit(benchmark::kMillisecond);
+
+void BM_Pbkdf2HmacSha256(benchmark::State& state)
+{
+    const QByteArray password("correct horse battery staple");
+    const QByteArray salt(16, '\x5a');
+    const auto iterations = static_cast<unsigned int>(state.range(0));
+    unsigned char derived[32];
+    for (auto _ : state) {
+        common::simd::pbkdf2HmacSha256(reinterpret_cast<const unsigned char*>(password.constData()),
+                                       static_cast<std::size_t>(password.size()),
+                                       reinterpret_cast<const unsigned char*>(salt.constData()),
+                                       static_cast<std::size_t>(salt.size()),
+                                       iterations,
+                                       derived,
+                                       sizeof(derived));
+        benchmark::DoNotOptimize(derived);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(common::simd::sha256KernelName());
+}
+BENCHMARK(BM_Pbkdf2HmacSha256)->Arg(10000)->Arg(310000)->Unit(benchmark::kMillisecond);
+
+void BM_CaptchaCreateChallenge(benchmark::State& state)
+{
+    static CaptchaService captchaService(1 << 20, 1 << 20);
+    // One connection per thread, so each challenge replaces the previous one.
+    const QString client = QStringLiteral("bench-%1").arg(state.thread_index());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(captchaService.createChallenge(QStringLiteral("login"), client, client));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CaptchaCreateChallenge)->Iterations(20000)->Threads(1)->Threads(4);
+
+// One login round trip per challenge: issue, then consume with a wrong answer
+// so nothing stays outstanding. Each iteration is a burst of 100k challenges.
+void BM_CaptchaIssueAndVerifyBurst(benchmark::State& state)
+{
+    static CaptchaService captchaService;
+    const int burst = static_cast<int>(state.range(0));
+    const QString scope = QStringLiteral("login");
+    const QString client = QStringLiteral("bench-%1").arg(state.thread_index());
+    for (auto _ : state) {
+        for (int i = 0; i < burst; ++i) {
+            const auto challenge = captchaService.createChallenge(scope, client, client);
+            if (challenge.has_value()) {
+                benchmark::DoNotOptimize(captchaService.verifyAndConsume(challenge->nonce, -1, scope));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_CaptchaIssueAndVerifyBurst)->Arg(100000)->Threads(1)->Threads(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}
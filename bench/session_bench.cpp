@@ -0,0 +1,150 @@
+#include <benchmark/benchmark.h>
+
+#include <QDir>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include "auth/session_service.h"
+#include "repository/sqlite_session_repository.h"
+
+namespace {
+
+constexpr int kSessionCount = 10000;
+
+struct SessionFixture {
+    SessionService service;
+    QStringList tokens;
+
+    SessionFixture()
+    {
+        tokens.reserve(kSessionCount);
+        for (int i = 0; i < kSessionCount; ++i) {
+            tokens.append(service.createSession(QStringLiteral("user%1").arg(i), QStringLiteral("User")));
+        }
+    }
+};
+
+SessionFixture& sessionFixture()
+{
+    static SessionFixture fixture;
+    return fixture;
+}
+
+void BM_SessionValidate(benchmark::State& state)
+{
+    SessionFixture& fixture = sessionFixture();
+    int index = state.thread_index() * 7919;
+    SessionService::SessionInfo info;
+    for (auto _ : state) {
+        const QString& token = fixture.tokens.at(index % kSessionCount);
+        benchmark::DoNotOptimize(fixture.service.validateSession(token, &info));
+        ++index;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SessionValidate)->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+
+void BM_SessionValidateWithChurn(benchmark::State& state)
+{
+    SessionFixture& fixture = sessionFixture();
+    int index = state.thread_index() * 7919;
+    SessionService::SessionInfo info;
+    for (auto _ : state) {
+        if (state.thread_index() == 0 && (index & 63) == 0) {
+            const QString token = fixture.service.createSession(QStringLiteral("churn"), QStringLiteral("User"));
+            fixture.service.invalidateSession(token);
+        } else {
+            benchmark::DoNotOptimize(fixture.service.validateSession(fixture.tokens.at(index % kSessionCount), &info));
+        }
+        ++index;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SessionValidateWithChurn)->Threads(4)->Threads(16)->UseRealTime();
+
+void BM_SessionMixedContention(benchmark::State& state)
+{
+    SessionFixture& fixture = sessionFixture();
+    int index = state.thread_index() * 7919;
+    SessionService::SessionInfo info;
+    for (auto _ : state) {
+        if ((index & 255) == 0) {
+            if (state.thread_index() % 4 == 0) {
+                const QString token = fixture.service.createSession(QStringLiteral("churn%1").arg(state.thread_index()),
+                                                                    QStringLiteral("User"));
+                fixture.service.invalidateSession(fixture.service.refreshSession(token));
+            } else if (state.thread_index() == 1) {
+                benchmark::DoNotOptimize(fixture.service.activeUsernames());
+            }
+        }
+        benchmark::DoNotOptimize(fixture.service.validateSession(fixture.tokens.at(index % kSessionCount), &info));
+        ++index;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SessionMixedContention)->Threads(16)->UseRealTime();
+
+// Simulates a restart: sessions written through the write-behind queue are
+// revalidated by a fresh service, each loading lazily on first use.
+void BM_SessionRestartToSteadyState(benchmark::State& state)
+{
+    const int sessionCount = static_cast<int>(state.range(0));
+    QTemporaryDir directory;
+    SqliteSessionRepository repository(QDir(directory.path()).filePath(QStringLiteral("sessions.db")));
+
+    QStringList tokens;
+    {
+        SessionService before(SessionService::kDefaultIdleTimeoutSecs,
+                              SessionService::kDefaultAbsoluteTimeoutSecs,
+                              nullptr,
+                              &repository);
+        tokens.reserve(sessionCount);
+        for (int i = 0; i < sessionCount; ++i) {
+            tokens.append(before.createSession(QStringLiteral("user%1").arg(i), QStringLiteral("User")));
+        }
+        before.flushPendingWrites();
+    }
+
+    SessionService::SessionInfo info;
+    for (auto _ : state) {
+        SessionService restarted(SessionService::kDefaultIdleTimeoutSecs,
+                                 SessionService::kDefaultAbsoluteTimeoutSecs,
+                                 nullptr,
+                                 &repository);
+        for (const QString& token : std::as_const(tokens)) {
+            benchmark::DoNotOptimize(restarted.validateSession(token, &info));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sessionCount);
+}
+BENCHMARK(BM_SessionRestartToSteadyState)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+void BM_SessionWriteBehindFlush(benchmark::State& state)
+{
+    const int batchSize = static_cast<int>(state.range(0));
+    QTemporaryDir directory;
+    SqliteSessionRepository repository(QDir(directory.path()).filePath(QStringLiteral("sessions.db")));
+    SessionService service(SessionService::kDefaultIdleTimeoutSecs,
+                           SessionService::kDefaultAbsoluteTimeoutSecs,
+                           nullptr,
+                           &repository);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        QStringList tokens;
+        for (int i = 0; i < batchSize; ++i) {
+            tokens.append(service.createSession(QStringLiteral("user%1").arg(i), QStringLiteral("User")));
+        }
+        service.flushPendingWrites();
+        for (const QString& token : std::as_const(tokens)) {
+            service.invalidateSession(token);
+        }
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(service.flushPendingWrites());
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_SessionWriteBehindFlush)->Arg(16)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+}
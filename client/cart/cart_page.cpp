@@ -126,8 +126,8 @@ cart_page::~cart_page()
 void cart_page::refreshFromServer()
 {
     AuthClient* client = AuthClient::instance();
-    client->sendMessage(client->withSession(common::Command::CartList));
-    client->sendMessage(client->withSession(common::Command::WalletBalance));
+    client->sendBatch({client->withSession(common::Command::CartList),
+                       client->withSession(common::Command::WalletBalance)});
 }
 
 void cart_page::setItems(const QVector<CartItemData> &newItems)
@@ -6,6 +6,7 @@
 #include "../profile/profile_page.h"
 #include "../shop/shop_page.h"
 #include "../network/auth_client.h"
+#include "../network/ad_uploader.h"
 
 #include <QDateTime>
 #include <QApplication>
@@ -13,6 +14,7 @@
 #include <QLayoutItem>
 
 #include "protocol/ad_create_message.h"
+#include "protocol/ad_upload_message.h"
 
 client_main_window::client_main_window(QWidget *parent)
     : QMainWindow(parent),
@@ -93,14 +95,30 @@ void client_main_window::wireNavigation()
         showPage(ProfilePage);
     });
 
+    adUploader = new AdUploader(this);
+    connect(adUploader, &AdUploader::failed, this, [this](const QString& message) {
+        QMessageBox::warning(this, QStringLiteral("Ad submission failed"), message);
+    });
+
     connect(newAdPageWidget,
             &new_ad_page::submitAdRequested,
             this,
-            [](const QString& title,
-               const QString& description,
-               const QString& category,
-               int priceTokens,
-               const QByteArray& imageBytes) {
+            [this](const QString& title,
+                   const QString& description,
+                   const QString& category,
+                   int priceTokens,
+                   const QByteArray& imageBytes) {
+                if (imageBytes.size() > common::AdUploadMessage::kChunkBytes) {
+                    if (adUploader->isBusy()) {
+                        QMessageBox::information(this,
+                                                 QStringLiteral("Upload in progress"),
+                                                 QStringLiteral("Please wait for the current image upload to finish."));
+                        return;
+                    }
+                    adUploader->start(title, description, category, priceTokens, imageBytes);
+                    return;
+                }
+
                 const common::Message request = common::AdCreateMessage::createRequest(
                     title,
                     description,
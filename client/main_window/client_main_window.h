@@ -9,6 +9,7 @@ class cart_page;
 class profile_page;
 class new_ad_page;
 class how_it_works_page;
+class AdUploader;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -58,6 +59,7 @@ private:
     profile_page *profilePageWidget = nullptr;
     new_ad_page *newAdPageWidget = nullptr;
     how_it_works_page *howItWorksPageWidget = nullptr;
+    AdUploader *adUploader = nullptr;
 
 
     void setupClock();
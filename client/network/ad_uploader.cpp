@@ -0,0 +1,179 @@
+#include "ad_uploader.h"
+
+#include "auth_client.h"
+
+#include <QCryptographicHash>
+
+#include "protocol/ad_upload_message.h"
+
+AdUploader::AdUploader(QObject* parent)
+    : QObject(parent)
+{
+    AuthClient* client = AuthClient::instance();
+    connect(client, &AuthClient::adUploadInitResultReceived, this, &AdUploader::onInitResult);
+    connect(client, &AuthClient::adUploadChunkResultReceived, this, &AdUploader::onChunkResult);
+    connect(client, &AuthClient::loginResultReceived, this, &AdUploader::onLoginResult);
+    connect(client, &AuthClient::adCreateResultReceived, this, &AdUploader::onAdCreateResult);
+}
+
+bool AdUploader::isBusy() const
+{
+    return active_;
+}
+
+void AdUploader::start(const QString& title,
+                       const QString& description,
+                       const QString& category,
+                       int priceTokens,
+                       const QByteArray& imageBytes)
+{
+    reset();
+
+    title_ = title;
+    description_ = description;
+    category_ = category;
+    priceTokens_ = priceTokens;
+    imageBytes_ = imageBytes;
+    imageSha256_ = QString::fromLatin1(
+        QCryptographicHash::hash(imageBytes_, QCryptographicHash::Sha256).toHex());
+    active_ = true;
+
+    sendInit();
+}
+
+void AdUploader::onInitResult(bool success,
+                              const QString& message,
+                              common::ErrorCode errorCode,
+                              const QJsonObject& payload)
+{
+    if (!active_ || committing_) {
+        return;
+    }
+
+    if (!success) {
+        if (errorCode == common::ErrorCode::AuthSessionExpired) {
+            return;
+        }
+        if (errorCode == common::ErrorCode::NotFound && !uploadId_.isEmpty()) {
+            uploadId_.clear();
+            sendInit();
+            return;
+        }
+        fail(message);
+        return;
+    }
+
+    uploadId_ = payload.value(QStringLiteral("uploadId")).toString();
+    chunkSize_ = payload.value(QStringLiteral("chunkSize")).toInt(common::AdUploadMessage::kChunkBytes);
+    if (chunkSize_ <= 0) {
+        chunkSize_ = common::AdUploadMessage::kChunkBytes;
+    }
+
+    const int nextChunkIndex = payload.value(QStringLiteral("nextChunkIndex")).toInt(0);
+    if (static_cast<qint64>(nextChunkIndex) * chunkSize_ >= imageBytes_.size()) {
+        sendCommit();
+        return;
+    }
+    sendChunk(nextChunkIndex);
+}
+
+void AdUploader::onChunkResult(bool success,
+                               const QString& message,
+                               common::ErrorCode errorCode,
+                               const QJsonObject& payload)
+{
+    if (!active_ || committing_) {
+        return;
+    }
+
+    const QString uploadId = payload.value(QStringLiteral("uploadId")).toString();
+    if (!uploadId.isEmpty() && uploadId != uploadId_) {
+        return;
+    }
+
+    if (!success) {
+        if (errorCode == common::ErrorCode::AuthSessionExpired) {
+            return;
+        }
+        if (errorCode == common::ErrorCode::NotFound) {
+            uploadId_.clear();
+            sendInit();
+            return;
+        }
+        fail(message);
+        return;
+    }
+
+    const qint64 receivedBytes = static_cast<qint64>(payload.value(QStringLiteral("receivedBytes")).toDouble(0));
+    emit progressChanged(receivedBytes, imageBytes_.size());
+
+    const int nextChunkIndex = payload.value(QStringLiteral("nextChunkIndex")).toInt(0);
+    if (receivedBytes >= imageBytes_.size()) {
+        sendCommit();
+        return;
+    }
+    sendChunk(nextChunkIndex);
+}
+
+void AdUploader::onLoginResult(bool success)
+{
+    if (success && active_ && !committing_) {
+        sendInit();
+    }
+}
+
+void AdUploader::onAdCreateResult()
+{
+    if (committing_) {
+        reset();
+    }
+}
+
+void AdUploader::sendInit()
+{
+    const common::Message request = common::AdUploadMessage::createInitRequest(title_,
+                                                                               description_,
+                                                                               category_,
+                                                                               priceTokens_,
+                                                                               imageBytes_.size(),
+                                                                               imageSha256_,
+                                                                               uploadId_);
+    AuthClient::instance()->sendMessage(AuthClient::instance()->withSession(request.command(), request.payload()));
+}
+
+void AdUploader::sendChunk(int chunkIndex)
+{
+    const qint64 offset = static_cast<qint64>(chunkIndex) * chunkSize_;
+    const common::Message request = common::AdUploadMessage::createChunkRequest(
+        uploadId_,
+        chunkIndex,
+        imageBytes_.mid(offset, chunkSize_));
+    AuthClient::instance()->sendMessage(AuthClient::instance()->withSession(request.command(), request.payload()));
+}
+
+void AdUploader::sendCommit()
+{
+    committing_ = true;
+    const common::Message request = common::AdUploadMessage::createCommitRequest(uploadId_);
+    AuthClient::instance()->sendMessage(AuthClient::instance()->withSession(request.command(), request.payload()));
+}
+
+void AdUploader::fail(const QString& message)
+{
+    reset();
+    emit failed(message.isEmpty() ? QStringLiteral("Image upload failed") : message);
+}
+
+void AdUploader::reset()
+{
+    title_.clear();
+    description_.clear();
+    category_.clear();
+    priceTokens_ = 0;
+    imageBytes_.clear();
+    imageSha256_.clear();
+    uploadId_.clear();
+    chunkSize_ = 0;
+    active_ = false;
+    committing_ = false;
+}
@@ -0,0 +1,61 @@
+#ifndef KALANET_AD_UPLOADER_H
+#define KALANET_AD_UPLOADER_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+
+#include "protocol/error_codes.h"
+
+class AdUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AdUploader(QObject* parent = nullptr);
+
+    bool isBusy() const;
+    void start(const QString& title,
+               const QString& description,
+               const QString& category,
+               int priceTokens,
+               const QByteArray& imageBytes);
+
+signals:
+    void progressChanged(qint64 sentBytes, qint64 totalBytes);
+    void failed(const QString& message);
+
+private slots:
+    void onInitResult(bool success,
+                      const QString& message,
+                      common::ErrorCode errorCode,
+                      const QJsonObject& payload);
+    void onChunkResult(bool success,
+                       const QString& message,
+                       common::ErrorCode errorCode,
+                       const QJsonObject& payload);
+    void onLoginResult(bool success);
+    void onAdCreateResult();
+
+private:
+    void sendInit();
+    void sendChunk(int chunkIndex);
+    void sendCommit();
+    void fail(const QString& message);
+    void reset();
+
+    QString title_;
+    QString description_;
+    QString category_;
+    int priceTokens_ = 0;
+    QByteArray imageBytes_;
+    QString imageSha256_;
+
+    QString uploadId_;
+    int chunkSize_ = 0;
+    bool active_ = false;
+    bool committing_ = false;
+};
+
+#endif // KALANET_AD_UPLOADER_H
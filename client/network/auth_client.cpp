@@ -73,6 +73,21 @@ void AuthClient::sendMessage(const common::Message& message)
     connectIfNeeded();
 }
 
+void AuthClient::sendBatch(const QList<common::Message>& messages)
+{
+    if (messages.size() == 1) {
+        sendMessage(messages.first());
+        return;
+    }
+
+    QJsonArray requests;
+    for (common::Message message : messages) {
+        message.setSessionToken({});
+        requests.append(message.toJson());
+    }
+    sendMessage(withSession(common::Command::Batch, QJsonObject{{QStringLiteral("requests"), requests}}));
+}
+
 void AuthClient::sendFramed(const common::Message& message)
 {
     const QByteArray payload = common::Serializer::serialize(message);
@@ -127,123 +142,174 @@ void AuthClient::onReadyRead()
         buffer_.remove(0, expectedSize_);
         expectedSize_ = -1;
 
-        const common::Message message = common::Serializer::deserialize(payloadBytes);
-        const QJsonObject payload = message.payload();
-        const bool success = messageSuccess(message);
-        const QString statusMessage = message.statusMessage().isEmpty()
-                                          ? payload.value(QStringLiteral("message")).toString()
-                                          : message.statusMessage();
-
-        switch (message.command()) {
-        case common::Command::LoginResult:
-            if (success) {
-                sessionToken_ = message.sessionToken().isEmpty()
-                                    ? payload.value(QStringLiteral("sessionToken")).toString()
-                                    : message.sessionToken();
-                username_ = payload.value(QStringLiteral("username")).toString();
-                fullName_ = payload.value(QStringLiteral("fullName")).toString();
-            } else {
-                sessionToken_.clear();
-                username_.clear();
-                fullName_.clear();
-            }
-            emit loginResultReceived(success,
-                                     statusMessage,
-                                     payload.value(QStringLiteral("fullName")).toString(),
-                                     payload.value(QStringLiteral("role")).toString());
-            break;
-
-        case common::Command::SignupResult:
-            emit signupResultReceived(success, statusMessage);
-            break;
-
-        case common::Command::CaptchaChallengeResult:
-            emit captchaChallengeReceived(success,
-                                         statusMessage,
-                                         payload.value(QStringLiteral("scope")).toString(),
-                                         payload.value(QStringLiteral("challenge")).toString(),
-                                         payload.value(QStringLiteral("nonce")).toString(),
-                                         payload.value(QStringLiteral("expiresAt")).toString());
-            break;
-
-        case common::Command::AdCreateResult:
-            emit adCreateResultReceived(success, statusMessage, payload.value(QStringLiteral("adId")).toInt(-1));
-            break;
-
-        case common::Command::AdListResult:
-            emit adListReceived(success, statusMessage, payload.value(QStringLiteral("ads")).toArray());
-            break;
-
-        case common::Command::AdDetailResult:
-            emit adDetailResultReceived(success, statusMessage, payload);
-            break;
+        handleMessage(common::Serializer::deserialize(payloadBytes));
+    }
+}
 
-        case common::Command::CartListResult:
-            emit cartListReceived(success, statusMessage, payload.value(QStringLiteral("items")).toArray());
+void AuthClient::handleMessage(const common::Message& message)
+{
+    const QJsonObject payload = message.payload();
+    const bool success = messageSuccess(message);
+    const QString statusMessage = message.statusMessage().isEmpty()
+                                      ? payload.value(QStringLiteral("message")).toString()
+                                      : message.statusMessage();
+
+    switch (message.command()) {
+    case common::Command::LoginResult:
+        if (success) {
+            sessionToken_ = message.sessionToken().isEmpty()
+                                ? payload.value(QStringLiteral("sessionToken")).toString()
+                                : message.sessionToken();
+            username_ = payload.value(QStringLiteral("username")).toString();
+            fullName_ = payload.value(QStringLiteral("fullName")).toString();
+        } else {
+            sessionToken_.clear();
+            username_.clear();
+            fullName_.clear();
+        }
+        emit loginResultReceived(success,
+                                 statusMessage,
+                                 payload.value(QStringLiteral("fullName")).toString(),
+                                 payload.value(QStringLiteral("role")).toString());
+        break;
+
+    case common::Command::SignupResult:
+        emit signupResultReceived(success, statusMessage);
+        break;
+
+    case common::Command::CaptchaChallengeResult:
+        emit captchaChallengeReceived(success,
+                                     statusMessage,
+                                     payload.value(QStringLiteral("scope")).toString(),
+                                     payload.value(QStringLiteral("challenge")).toString(),
+                                     payload.value(QStringLiteral("nonce")).toString(),
+                                     payload.value(QStringLiteral("expiresAt")).toString());
+        break;
+
+    case common::Command::AdCreateResult:
+        emit adCreateResultReceived(success, statusMessage, payload.value(QStringLiteral("adId")).toInt(-1));
+        break;
+
+    case common::Command::AdUploadInitResult:
+        emit adUploadInitResultReceived(success, statusMessage, message.errorCode(), payload);
+        break;
+
+    case common::Command::AdUploadChunkResult:
+        emit adUploadChunkResultReceived(success, statusMessage, message.errorCode(), payload);
+        break;
+
+    case common::Command::AdListResult:
+        if (success && payload.value(QStringLiteral("notModified")).toBool(false)) {
+            emit adListNotModified(payload.value(QStringLiteral("catalogVersion")).toString());
             break;
-
-        case common::Command::CartAddItemResult:
-            emit cartAddItemResultReceived(success,
+        }
+        emit adListReceived(success,
+                            statusMessage,
+                            payload.value(QStringLiteral("ads")).toArray(),
+                            payload.value(QStringLiteral("catalogVersion")).toString(),
+                            payload.value(QStringLiteral("after")).toString(),
+                            payload.value(QStringLiteral("nextCursor")).toString(),
+                            payload.value(QStringLiteral("facets")).toObject());
+        break;
+
+    case common::Command::AdDetailBatchResult:
+        emit adDetailBatchReceived(success,
+                                   statusMessage,
+                                   payload.value(QStringLiteral("ads")).toArray(),
+                                   payload.value(QStringLiteral("missingIds")).toArray(),
+                                   payload.value(QStringLiteral("deferredIds")).toArray());
+        break;
+
+    case common::Command::AdThumbnailBatchResult:
+        emit adThumbnailBatchReceived(success, statusMessage, payload.value(QStringLiteral("thumbnails")).toArray());
+        break;
+
+    case common::Command::CartListResult:
+        emit cartListReceived(success, statusMessage, payload.value(QStringLiteral("items")).toArray());
+        break;
+
+    case common::Command::CartAddItemResult:
+        emit cartAddItemResultReceived(success,
+                                       statusMessage,
+                                       payload.value(QStringLiteral("adId")).toInt(-1),
+                                       payload.value(QStringLiteral("added")).toBool(false));
+        break;
+
+    case common::Command::CartRemoveItemResult:
+        emit cartRemoveItemResultReceived(success, statusMessage, payload.value(QStringLiteral("adId")).toInt(-1));
+        break;
+
+    case common::Command::CartClearResult:
+        emit cartClearResultReceived(success, statusMessage);
+        break;
+
+    case common::Command::WalletBalanceResult:
+        emit walletBalanceReceived(success, statusMessage, payload.value(QStringLiteral("balanceTokens")).toInt(0));
+        break;
+
+    case common::Command::WalletTopUpResult:
+        emit walletTopUpResultReceived(success, statusMessage, payload.value(QStringLiteral("balanceTokens")).toInt(0));
+        break;
+
+    case common::Command::BuyResult:
+        emit buyResultReceived(success,
+                              statusMessage,
+                              payload.value(QStringLiteral("balanceTokens")).toInt(0),
+                              payload.value(QStringLiteral("soldAdIds")).toArray());
+        break;
+
+    case common::Command::DiscountCodeValidateResult:
+        emit discountCodeValidationReceived(success,
                                            statusMessage,
-                                           payload.value(QStringLiteral("adId")).toInt(-1),
-                                           payload.value(QStringLiteral("added")).toBool(false));
-            break;
-
-        case common::Command::CartRemoveItemResult:
-            emit cartRemoveItemResultReceived(success, statusMessage, payload.value(QStringLiteral("adId")).toInt(-1));
-            break;
-
-        case common::Command::CartClearResult:
-            emit cartClearResultReceived(success, statusMessage);
-            break;
-
-        case common::Command::WalletBalanceResult:
-            emit walletBalanceReceived(success, statusMessage, payload.value(QStringLiteral("balanceTokens")).toInt(0));
-            break;
-
-        case common::Command::WalletTopUpResult:
-            emit walletTopUpResultReceived(success, statusMessage, payload.value(QStringLiteral("balanceTokens")).toInt(0));
-            break;
-
-        case common::Command::BuyResult:
-            emit buyResultReceived(success,
-                                  statusMessage,
-                                  payload.value(QStringLiteral("balanceTokens")).toInt(0),
-                                  payload.value(QStringLiteral("soldAdIds")).toArray());
-            break;
-
-        case common::Command::DiscountCodeValidateResult:
-            emit discountCodeValidationReceived(success,
-                                               statusMessage,
-                                               payload.value(QStringLiteral("valid")).toBool(false),
-                                               payload.value(QStringLiteral("discountTokens")).toInt(0),
-                                               payload.value(QStringLiteral("totalTokens")).toInt(0),
-                                               payload.value(QStringLiteral("code")).toString());
-            break;
-
-        case common::Command::ProfileHistoryResult:
-            emit profileHistoryReceived(success, statusMessage, payload);
-            break;
+                                           payload.value(QStringLiteral("valid")).toBool(false),
+                                           payload.value(QStringLiteral("discountTokens")).toInt(0),
+                                           payload.value(QStringLiteral("totalTokens")).toInt(0),
+                                           payload.value(QStringLiteral("code")).toString());
+        break;
+
+    case common::Command::ProfileHistoryResult:
+        emit profileHistoryReceived(success, statusMessage, payload);
+        break;
+
+    case common::Command::ProfileUpdateResult:
+        if (success) {
+            const QString reissuedToken = message.sessionToken().isEmpty()
+                                              ? payload.value(QStringLiteral("sessionToken")).toString()
+                                              : message.sessionToken();
+            if (!reissuedToken.isEmpty()) {
+                sessionToken_ = reissuedToken;
+            }
+        }
+        emit profileUpdateResultReceived(success, statusMessage, payload);
+        break;
 
-        case common::Command::ProfileUpdateResult:
-            emit profileUpdateResultReceived(success, statusMessage, payload);
-            break;
+    case common::Command::WalletAdjustNotify:
+        sendMessage(withSession(common::Command::WalletBalance));
+        break;
 
-        case common::Command::WalletAdjustNotify:
-            sendMessage(withSession(common::Command::WalletBalance));
-            break;
+    case common::Command::AdStatusNotify:
+        emit adStatusNotifyReceived(payload.value(QStringLiteral("soldAdIds")).toArray(),
+                                    payload.value(QStringLiteral("status")).toString());
+        break;
 
-        case common::Command::AdStatusNotify:
-            emit adStatusNotifyReceived(payload.value(QStringLiteral("soldAdIds")).toArray(),
-                                        payload.value(QStringLiteral("status")).toString());
+    case common::Command::BatchResult:
+        if (!success) {
+            emit networkError(statusMessage.isEmpty() ? QStringLiteral("Batch request failed") : statusMessage);
             break;
+        }
+        for (const QJsonValue& value : payload.value(QStringLiteral("responses")).toArray()) {
+            const auto response = common::Message::fromJson(value.toObject());
+            if (response) {
+                handleMessage(*response);
+            }
+        }
+        break;
 
-        case common::Command::Error:
-            emit networkError(statusMessage.isEmpty() ? QStringLiteral("Unknown protocol error") : statusMessage);
-            break;
+    case common::Command::Error:
+        emit networkError(statusMessage.isEmpty() ? QStringLiteral("Unknown protocol error") : statusMessage);
+        break;
 
-        default:
-            break;
-        }
+    default:
+        break;
     }
 }
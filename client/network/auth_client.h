@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QTcpSocket>
 #include <QByteArray>
+#include <QList>
 #include <QQueue>
 #include <QJsonArray>
 #include <QJsonObject>
@@ -18,6 +19,7 @@ public:
     static AuthClient* instance();
 
     void sendMessage(const common::Message& message);
+    void sendBatch(const QList<common::Message>& messages);
     void connectIfNeeded();
     bool isConnected() const;
 
@@ -40,13 +42,35 @@ signals:
                                 const QString& message,
                                 int adId);
 
+    void adUploadInitResultReceived(bool success,
+                                    const QString& message,
+                                    common::ErrorCode errorCode,
+                                    const QJsonObject& payload);
+
+    void adUploadChunkResultReceived(bool success,
+                                     const QString& message,
+                                     common::ErrorCode errorCode,
+                                     const QJsonObject& payload);
+
     void adListReceived(bool success,
                         const QString& message,
-                        const QJsonArray& ads);
+                        const QJsonArray& ads,
+                        const QString& catalogVersion,
+                        const QString& afterCursor,
+                        const QString& nextCursor,
+                        const QJsonObject& facets);
 
-    void adDetailResultReceived(bool success,
-                                const QString& message,
-                                const QJsonObject& ad);
+    void adListNotModified(const QString& catalogVersion);
+
+    void adDetailBatchReceived(bool success,
+                               const QString& message,
+                               const QJsonArray& ads,
+                               const QJsonArray& missingIds,
+                               const QJsonArray& deferredIds);
+
+    void adThumbnailBatchReceived(bool success,
+                                  const QString& message,
+                                  const QJsonArray& thumbnails);
 
     void cartListReceived(bool success,
                           const QString& message,
@@ -108,6 +132,7 @@ private:
     explicit AuthClient(QObject* parent = nullptr);
 
     void sendFramed(const common::Message& message);
+    void handleMessage(const common::Message& message);
     static bool messageSuccess(const common::Message& message);
 
 private slots:
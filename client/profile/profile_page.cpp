@@ -94,7 +94,7 @@ profile_page::profile_page(QWidget *parent)
     connect(AuthClient::instance(), &AuthClient::captchaChallengeReceived, this,
             [this](bool success, const QString& message, const QString& scope,
                    const QString& challengeText, const QString& nonce, const QString&) {
-                if (scope != QStringLiteral("wallet_top_up")) {
+                if (scope != QStringLiteral("wallet_topup")) {
                     return;
                 }
                 if (!success) {
@@ -166,9 +166,9 @@ void profile_page::setupTables()
 void profile_page::refreshFromServer()
 {
     AuthClient* client = AuthClient::instance();
-    client->sendMessage(client->withSession(common::Command::ProfileHistory,
-                                                QJsonObject{{QStringLiteral("username"), client->username()}}));
-    client->sendMessage(client->withSession(common::Command::WalletBalance));
+    client->sendBatch({client->withSession(common::Command::ProfileHistory,
+                                           QJsonObject{{QStringLiteral("username"), client->username()}}),
+                       client->withSession(common::Command::WalletBalance)});
 }
 
 void profile_page::refreshPurchasesTable()
@@ -256,7 +256,7 @@ void profile_page::on_btnChangePassword_clicked()
 void profile_page::on_btnRefreshCaptcha_clicked()
 {
     AuthClient::instance()->sendMessage(common::Message(common::Command::CaptchaChallenge,
-                                                        QJsonObject{{QStringLiteral("scope"), QStringLiteral("wallet_top_up")}}));
+                                                        QJsonObject{{QStringLiteral("scope"), QStringLiteral("wallet_topup")}}));
 }
 
 void profile_page::on_btnAddTokens_clicked()
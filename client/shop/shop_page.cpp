@@ -2,6 +2,7 @@
 #include "ui_shop_page.h"
 
 #include "../network/auth_client.h"
+#include "protocol/base64_codec.h"
 
 #include <QDialog>
 #include <QFrame>
@@ -13,10 +14,23 @@
 #include <QPlainTextEdit>
 #include <QPixmap>
 #include <QPushButton>
+#include <QScrollBar>
+#include <QSet>
+#include <QSignalBlocker>
 #include <QTableWidgetItem>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <utility>
 
+namespace {
+constexpr int kAdsPageSize = 50;
+constexpr int kThumbnailBatchSize = 100;
+constexpr int kDetailBatchSize = 50;
+constexpr int kThumbnailRetryMs = 1000;
+constexpr int kThumbnailWidth = 72;
+constexpr int kThumbnailHeight = 54;
+}
+
 shop_page::shop_page(QWidget *parent)
     : QWidget(parent),
       ui(new Ui::shop_page)
@@ -26,45 +40,93 @@ shop_page::shop_page(QWidget *parent)
     setupAdsTable();
 
     connect(AuthClient::instance(), &AuthClient::adListReceived, this,
-            [this](bool success, const QString& message, const QJsonArray& ads) {
+            [this](bool success, const QString& message, const QJsonArray& ads, const QString& version,
+                   const QString& afterCursor, const QString& nextCursor, const QJsonObject& facets) {
+                const bool isNextPage = !afterCursor.isEmpty();
+                if (isNextPage && afterCursor != pendingAdsCursor) {
+                    // Page of a listing that was reloaded while it was in flight.
+                    return;
+                }
+                // Failures carry no payload, so a failed next page only shows
+                // up as a request that was still waiting on a cursor.
+                const bool nextPageFailed = !success && !pendingAdsCursor.isEmpty();
+                pendingAdsCursor.clear();
+
+                if (nextPageFailed) {
+                    // Relevance cursors lapse once the catalog changes; start
+                    // the listing again from the first page.
+                    nextAdsCursor.clear();
+                    fetchAdsFromServer();
+                    return;
+                }
                 if (!success) {
+                    if (!isNextPage) {
+                        catalogVersion.clear();
+                    }
                     QMessageBox::warning(this, QStringLiteral("Shop"), message);
                     return;
                 }
 
-                allAds.clear();
-                adDetails.clear();
+                nextAdsCursor = nextCursor;
+                if (!isNextPage) {
+                    catalogVersion = version;
+                    allAds.clear();
+                    filteredIndices.clear();
+                    applyListFacets(facets);
+                }
+
+                const int firstRow = filteredIndices.size();
+                QHash<int, AdDetailData> retainedDetails;
                 for (const QJsonValue& value : ads) {
                     const QJsonObject ad = value.toObject();
-                    allAds.push_back({ad.value(QStringLiteral("id")).toInt(-1),
+                    const int adId = ad.value(QStringLiteral("id")).toInt(-1);
+                    const auto cached = adDetails.constFind(adId);
+                    if (!isNextPage && cached != adDetails.cend() && cached->loaded) {
+                        retainedDetails.insert(adId, cached.value());
+                    }
+                    allAds.push_back({adId,
                                       ad.value(QStringLiteral("title")).toString(),
                                       ad.value(QStringLiteral("category")).toString(),
                                       ad.value(QStringLiteral("priceTokens")).toInt(0),
                                       ad.value(QStringLiteral("sellerUsername")).toString(),
-                                      ad.value(QStringLiteral("status")).toString()});
+                                      ad.value(QStringLiteral("status")).toString(),
+                                      ad.value(QStringLiteral("hasImage")).toBool(false)});
+                    if (passesFilters(allAds.constLast())) {
+                        filteredIndices.push_back(allAds.size() - 1);
+                    }
                 }
 
-                filteredIndices.clear();
-                for (int i = 0; i < allAds.size(); ++i) {
-                    if (passesFilters(allAds[i])) {
-                        filteredIndices.push_back(i);
-                    }
+                if (isNextPage) {
+                    appendAdsRows(firstRow);
+                } else {
+                    adDetails = std::move(retainedDetails);
+                    refreshAdsTable();
                 }
-                refreshAdsTable();
+
+                // A short first page may not fill the viewport, so no scroll
+                // event would ever ask for the rest.
+                QTimer::singleShot(0, this, &shop_page::loadMoreAdsIfNeeded);
             });
 
-    connect(AuthClient::instance(), &AuthClient::adDetailResultReceived, this,
-            [this](bool success, const QString& message, const QJsonObject& ad) {
-                const int adId = ad.value(QStringLiteral("id")).toInt(-1);
-                if (adId <= 0) {
-                    return;
-                }
+    connect(AuthClient::instance(), &AuthClient::adListNotModified, this,
+            [this](const QString&) { loadMoreAdsIfNeeded(); });
 
-                AdDetailData& detail = adDetails[adId];
-                detail.requested = false;
+    connect(ui->twAds->verticalScrollBar(), &QScrollBar::valueChanged, this,
+            [this](int) { loadMoreAdsIfNeeded(); });
 
+    connect(AuthClient::instance(), &AuthClient::adDetailBatchReceived, this,
+            [this](bool success, const QString& message, const QJsonArray& ads, const QJsonArray& missingIds,
+                   const QJsonArray& deferredIds) {
+                const QVector<int> batchIds = inFlightDetailBatches.isEmpty() ? QVector<int>{}
+                                                                              : inFlightDetailBatches.takeFirst();
                 if (!success) {
-                    if (pendingPreviewAdId == adId) {
+                    for (const int adId : batchIds) {
+                        const auto detail = adDetails.find(adId);
+                        if (detail != adDetails.end()) {
+                            detail->requested = false;
+                        }
+                    }
+                    if (pendingPreviewAdId > 0) {
                         pendingPreviewAdId = -1;
                         QMessageBox::warning(this, QStringLiteral("Preview"),
                                              message.isEmpty() ? QStringLiteral("Could not load ad preview") : message);
@@ -72,15 +134,91 @@ shop_page::shop_page(QWidget *parent)
                     return;
                 }
 
-                detail.loaded = true;
-                detail.description = ad.value(QStringLiteral("description")).toString();
-                detail.imageBytes = QByteArray::fromBase64(ad.value(QStringLiteral("imageBase64")).toString().toLatin1());
+                for (const QJsonValue& value : ads) {
+                    const QJsonObject ad = value.toObject();
+                    const int adId = ad.value(QStringLiteral("id")).toInt(-1);
+                    if (adId <= 0) {
+                        continue;
+                    }
+
+                    AdDetailData& detail = adDetails[adId];
+                    detail.requested = false;
+                    detail.loaded = true;
+                    detail.description = ad.value(QStringLiteral("description")).toString();
+                    detail.imageBytes = common::Base64Codec::decode(ad.value(QStringLiteral("imageBase64")).toString());
+                }
+
+                for (const QJsonValue& value : missingIds) {
+                    const int adId = value.toInt(-1);
+                    adDetails[adId].requested = false;
+                    if (pendingPreviewAdId == adId) {
+                        pendingPreviewAdId = -1;
+                        QMessageBox::warning(this, QStringLiteral("Preview"), QStringLiteral("Advertisement not found"));
+                    }
+                }
+
+                // Left out to keep the response under the frame limit; they go
+                // out again in the next batch.
+                for (const QJsonValue& value : deferredIds) {
+                    const int adId = value.toInt(-1);
+                    if (adId > 0) {
+                        adDetails[adId].requested = false;
+                        requestAdDetail(adId);
+                    }
+                }
+
+                if (pendingPreviewAdId > 0 && adDetails.value(pendingPreviewAdId).loaded) {
+                    showAdPreviewDialog(std::exchange(pendingPreviewAdId, -1));
+                }
+            });
+
+    connect(AuthClient::instance(), &AuthClient::adThumbnailBatchReceived, this,
+            [this](bool success, const QString&, const QJsonArray& thumbnails) {
+                if (!success) {
+                    for (ThumbnailData& thumbnail : adThumbnails) {
+                        thumbnail.requested = false;
+                    }
+                    return;
+                }
+
+                QSet<int> updatedIds;
+                QVector<int> pendingIds;
+                for (const QJsonValue& value : thumbnails) {
+                    const QJsonObject item = value.toObject();
+                    const int adId = item.value(QStringLiteral("id")).toInt(-1);
+                    if (adId <= 0) {
+                        continue;
+                    }
+
+                    ThumbnailData& thumbnail = adThumbnails[adId];
+                    if (item.value(QStringLiteral("pending")).toBool(false)) {
+                        // Still marked requested so redrawn rows do not ask again
+                        // before the retry below.
+                        pendingIds.push_back(adId);
+                        continue;
+                    }
 
-                refreshAdsTable();
+                    thumbnail.requested = false;
+                    thumbnail.loaded = true;
+                    thumbnail.imageBytes = common::Base64Codec::decode(
+                        item.value(QStringLiteral("thumbnailBase64")).toString());
+                    updatedIds.insert(adId);
+                }
+
+                for (int row = 0; row < filteredIndices.size(); ++row) {
+                    const ShopItem& ad = allAds[filteredIndices[row]];
+                    if (updatedIds.contains(ad.adId)) {
+                        setThumbnailCell(row, ad);
+                    }
+                }
 
-                if (pendingPreviewAdId == adId) {
-                    pendingPreviewAdId = -1;
-                    showAdPreviewDialog(adId);
+                if (!pendingIds.isEmpty()) {
+                    QTimer::singleShot(kThumbnailRetryMs, this, [this, pendingIds]() {
+                        for (const int adId : pendingIds) {
+                            adThumbnails[adId].requested = false;
+                            requestThumbnail(adId);
+                        }
+                    });
                 }
             });
 
@@ -135,8 +273,7 @@ shop_page::shop_page(QWidget *parent)
 
     connect(AuthClient::instance(), &AuthClient::adStatusNotifyReceived, this,
             [this](const QJsonArray&, const QString&) {
-                fetchAdsFromServer();
-                fetchCartFromServer();
+                refreshFromServer();
             });
 
     connect(ui->twAds, &QTableWidget::cellDoubleClicked, this,
@@ -190,56 +327,149 @@ void shop_page::refreshAdsTable()
     ui->twAds->setRowCount(filteredIndices.size());
 
     for (int row = 0; row < filteredIndices.size(); ++row) {
-        const ShopItem& ad = allAds[filteredIndices[row]];
-        auto *imageLabel = new QLabel();
-        imageLabel->setAlignment(Qt::AlignCenter);
-        imageLabel->setMinimumSize(72, 54);
-
-        const AdDetailData detail = adDetails.value(ad.adId);
-        if (detail.loaded && !detail.imageBytes.isEmpty()) {
-            QPixmap pixmap;
-            if (pixmap.loadFromData(detail.imageBytes)) {
-                imageLabel->setPixmap(pixmap.scaled(72, 54, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-            } else {
-                imageLabel->setText(QStringLiteral("No image"));
-            }
+        populateAdRow(row, allAds[filteredIndices[row]]);
+    }
+}
+
+void shop_page::appendAdsRows(int firstRow)
+{
+    ui->twAds->setRowCount(filteredIndices.size());
+
+    for (int row = firstRow; row < filteredIndices.size(); ++row) {
+        populateAdRow(row, allAds[filteredIndices[row]]);
+    }
+}
+
+void shop_page::populateAdRow(int row, const ShopItem& ad)
+{
+    setThumbnailCell(row, ad);
+
+    ui->twAds->setItem(row, 1, new QTableWidgetItem(ad.title));
+    ui->twAds->setItem(row, 2, new QTableWidgetItem(ad.category));
+    ui->twAds->setItem(row, 3, new QTableWidgetItem(QString::number(ad.priceTokens) + QStringLiteral(" token")));
+    ui->twAds->setItem(row, 4, new QTableWidgetItem(ad.seller));
+
+    auto *reviewBtn = new QPushButton(QStringLiteral("Review"));
+    reviewBtn->setObjectName(QStringLiteral("btnReviewAd"));
+    reviewBtn->setCursor(Qt::PointingHandCursor);
+    reviewBtn->setMinimumHeight(34);
+    connect(reviewBtn, &QPushButton::clicked, this, [this, ad]() {
+        showAdPreviewDialog(ad.adId);
+    });
+    ui->twAds->setCellWidget(row, 5, reviewBtn);
+
+    auto *addBtn = new QPushButton(QStringLiteral("Add"));
+    addBtn->setObjectName(QStringLiteral("btnAddAd"));
+    addBtn->setCursor(Qt::PointingHandCursor);
+    addBtn->setMinimumHeight(34);
+
+    connect(addBtn, &QPushButton::clicked, this, [this, ad]() {
+        if (ad.adId <= 0) {
+            QMessageBox::warning(this, QStringLiteral("Cart"), QStringLiteral("Invalid ad id."));
+            return;
+        }
+
+        AuthClient::instance()->sendMessage(
+            AuthClient::instance()->withSession(common::Command::CartAddItem,
+                                                QJsonObject{{QStringLiteral("adId"), ad.adId}}));
+    });
+    ui->twAds->setCellWidget(row, 6, addBtn);
+}
+
+void shop_page::setThumbnailCell(int row, const ShopItem& ad)
+{
+    auto *imageLabel = new QLabel();
+    imageLabel->setAlignment(Qt::AlignCenter);
+    imageLabel->setMinimumSize(kThumbnailWidth, kThumbnailHeight);
+
+    const ThumbnailData thumbnail = adThumbnails.value(ad.adId);
+    if (!ad.hasImage || (thumbnail.loaded && thumbnail.imageBytes.isEmpty())) {
+        imageLabel->setText(QStringLiteral("No image"));
+    } else if (thumbnail.loaded) {
+        QPixmap pixmap;
+        if (pixmap.loadFromData(thumbnail.imageBytes)) {
+            imageLabel->setPixmap(pixmap.scaled(kThumbnailWidth, kThumbnailHeight, Qt::KeepAspectRatio, Qt::SmoothTransformation));
         } else {
-            imageLabel->setText(QStringLiteral("Preview"));
-            requestAdDetail(ad.adId);
+            imageLabel->setText(QStringLiteral("No image"));
         }
-        ui->twAds->setCellWidget(row, 0, imageLabel);
-
-        ui->twAds->setItem(row, 1, new QTableWidgetItem(ad.title));
-        ui->twAds->setItem(row, 2, new QTableWidgetItem(ad.category));
-        ui->twAds->setItem(row, 3, new QTableWidgetItem(QString::number(ad.priceTokens) + QStringLiteral(" token")));
-        ui->twAds->setItem(row, 4, new QTableWidgetItem(ad.seller));
-
-        auto *reviewBtn = new QPushButton(QStringLiteral("Review"));
-        reviewBtn->setObjectName(QStringLiteral("btnReviewAd"));
-        reviewBtn->setCursor(Qt::PointingHandCursor);
-        reviewBtn->setMinimumHeight(34);
-        connect(reviewBtn, &QPushButton::clicked, this, [this, ad]() {
-            showAdPreviewDialog(ad.adId);
-        });
-        ui->twAds->setCellWidget(row, 5, reviewBtn);
+    } else {
+        imageLabel->setText(QStringLiteral("Preview"));
+        requestThumbnail(ad.adId);
+    }
+    ui->twAds->setCellWidget(row, 0, imageLabel);
+}
 
-        auto *addBtn = new QPushButton(QStringLiteral("Add"));
-        addBtn->setObjectName(QStringLiteral("btnAddAd"));
-        addBtn->setCursor(Qt::PointingHandCursor);
-        addBtn->setMinimumHeight(34);
+void shop_page::loadMoreAdsIfNeeded()
+{
+    if (nextAdsCursor.isEmpty() || !pendingAdsCursor.isEmpty()) {
+        return;
+    }
 
-        connect(addBtn, &QPushButton::clicked, this, [this, ad]() {
-            if (ad.adId <= 0) {
-                QMessageBox::warning(this, QStringLiteral("Cart"), QStringLiteral("Invalid ad id."));
-                return;
-            }
+    const QScrollBar* scrollBar = ui->twAds->verticalScrollBar();
+    if (scrollBar->maximum() > 0 && scrollBar->value() < scrollBar->maximum() - scrollBar->pageStep() / 2) {
+        return;
+    }
 
-            AuthClient::instance()->sendMessage(
-                AuthClient::instance()->withSession(common::Command::CartAddItem,
-                                                    QJsonObject{{QStringLiteral("adId"), ad.adId}}));
-        });
-        ui->twAds->setCellWidget(row, 6, addBtn);
+    pendingAdsCursor = nextAdsCursor;
+    QJsonObject payload = lastAdListPayload;
+    payload.insert(QStringLiteral("after"), nextAdsCursor);
+    payload.remove(QStringLiteral("facets"));
+    AuthClient::instance()->sendMessage(
+        AuthClient::instance()->withSession(common::Command::AdList, payload));
+}
+
+void shop_page::applyListFacets(const QJsonObject& facets)
+{
+    if (facets.isEmpty()) {
+        return;
     }
+
+    refreshCategoryFilter(facets.value(QStringLiteral("categories")).toArray());
+
+    QStringList bucketLines;
+    for (const QJsonValue& value : facets.value(QStringLiteral("priceBuckets")).toArray()) {
+        const QJsonObject bucket = value.toObject();
+        const int minPrice = bucket.value(QStringLiteral("minPriceTokens")).toInt(0);
+        const int maxPrice = bucket.value(QStringLiteral("maxPriceTokens")).toInt(0);
+        const int count = bucket.value(QStringLiteral("count")).toInt(0);
+        if (maxPrice <= 0) {
+            bucketLines.append(QStringLiteral("%1 and up: %2").arg(minPrice).arg(count));
+        } else if (minPrice <= 0) {
+            bucketLines.append(QStringLiteral("Up to %1: %2").arg(maxPrice).arg(count));
+        } else {
+            bucketLines.append(QStringLiteral("%1 – %2: %3").arg(minPrice).arg(maxPrice).arg(count));
+        }
+    }
+    const QString priceToolTip = bucketLines.join(QLatin1Char('\n'));
+    ui->sbMinPrice->setToolTip(priceToolTip);
+    ui->sbMaxPrice->setToolTip(priceToolTip);
+}
+
+void shop_page::refreshCategoryFilter(const QJsonArray& categories)
+{
+    const QSignalBlocker blocker(ui->cbCategory);
+
+    const QString currentSelection = ui->cbCategory->currentData().toString();
+    ui->cbCategory->clear();
+    ui->cbCategory->addItem(QStringLiteral("All categories"), QString());
+
+    for (const QJsonValue& value : categories) {
+        const QJsonObject category = value.toObject();
+        const QString name = category.value(QStringLiteral("name")).toString();
+        ui->cbCategory->addItem(QStringLiteral("%1 (%2)")
+                                    .arg(name)
+                                    .arg(category.value(QStringLiteral("count")).toInt(0)),
+                                name);
+    }
+
+    // A category with no results under the other filters keeps its entry
+    // while it is selected.
+    int index = ui->cbCategory->findData(currentSelection);
+    if (index < 0) {
+        ui->cbCategory->addItem(currentSelection, currentSelection);
+        index = ui->cbCategory->count() - 1;
+    }
+    ui->cbCategory->setCurrentIndex(index);
 }
 
 void shop_page::refreshCartPreview()
@@ -293,9 +523,60 @@ void shop_page::requestAdDetail(int adId)
     }
 
     detail.requested = true;
-    AuthClient::instance()->sendMessage(
-        AuthClient::instance()->withSession(common::Command::AdDetail,
-                                            QJsonObject{{QStringLiteral("adId"), adId}}));
+    queuedDetailIds.push_back(adId);
+    if (queuedDetailIds.size() == 1) {
+        QTimer::singleShot(0, this, &shop_page::flushAdDetailRequests);
+    }
+}
+
+// Details asked for in the same event-loop pass share one AdDetailBatch request.
+void shop_page::flushAdDetailRequests()
+{
+    const QVector<int> adIds = std::exchange(queuedDetailIds, {});
+    for (qsizetype first = 0; first < adIds.size(); first += kDetailBatchSize) {
+        QJsonArray batch;
+        const QVector<int> batchIds = adIds.mid(first, kDetailBatchSize);
+        for (const int adId : batchIds) {
+            batch.append(adId);
+        }
+        inFlightDetailBatches.append(batchIds);
+        AuthClient::instance()->sendMessage(
+            AuthClient::instance()->withSession(common::Command::AdDetailBatch,
+                                                QJsonObject{{QStringLiteral("adIds"), batch}}));
+    }
+}
+
+// Rows drawn in the same event-loop pass share one AdThumbnailBatch request.
+void shop_page::requestThumbnail(int adId)
+{
+    if (adId <= 0) {
+        return;
+    }
+
+    ThumbnailData& thumbnail = adThumbnails[adId];
+    if (thumbnail.loaded || thumbnail.requested) {
+        return;
+    }
+
+    thumbnail.requested = true;
+    queuedThumbnailIds.push_back(adId);
+    if (queuedThumbnailIds.size() == 1) {
+        QTimer::singleShot(0, this, &shop_page::flushThumbnailRequests);
+    }
+}
+
+void shop_page::flushThumbnailRequests()
+{
+    const QVector<int> adIds = std::exchange(queuedThumbnailIds, {});
+    for (qsizetype first = 0; first < adIds.size(); first += kThumbnailBatchSize) {
+        QJsonArray batch;
+        for (const int adId : adIds.mid(first, kThumbnailBatchSize)) {
+            batch.append(adId);
+        }
+        AuthClient::instance()->sendMessage(
+            AuthClient::instance()->withSession(common::Command::AdThumbnailBatch,
+                                                QJsonObject{{QStringLiteral("adIds"), batch}}));
+    }
 }
 
 void shop_page::showAdPreviewDialog(int adId)
@@ -437,15 +718,20 @@ QJsonObject shop_page::buildAdListPayload() const
     QJsonObject payload;
     payload.insert(QStringLiteral("name"), ui->leSearchName->text().trimmed());
 
-    const QString selectedCategory = ui->cbCategory->currentText().trimmed();
-    if (!selectedCategory.isEmpty() && selectedCategory != QStringLiteral("All categories")) {
+    const QString selectedCategory = ui->cbCategory->currentData().toString();
+    if (!selectedCategory.isEmpty()) {
         payload.insert(QStringLiteral("category"), selectedCategory);
     }
 
     payload.insert(QStringLiteral("minPriceTokens"), ui->sbMinPrice->value());
     payload.insert(QStringLiteral("maxPriceTokens"), ui->sbMaxPrice->value());
-    payload.insert(QStringLiteral("sortBy"), QStringLiteral("createdAt"));
+    payload.insert(QStringLiteral("sortBy"), ui->leSearchName->text().trimmed().isEmpty()
+                                                 ? QStringLiteral("createdAt")
+                                                 : QStringLiteral("relevance"));
     payload.insert(QStringLiteral("sortOrder"), QStringLiteral("desc"));
+    payload.insert(QStringLiteral("limit"), kAdsPageSize);
+    // Counts for the category and price filters arrive with the first page.
+    payload.insert(QStringLiteral("facets"), true);
     return payload;
 }
 
@@ -456,8 +742,8 @@ bool shop_page::passesFilters(const ShopItem& ad) const
         return false;
     }
 
-    const QString selectedCategory = ui->cbCategory->currentText().trimmed();
-    if (!selectedCategory.isEmpty() && selectedCategory != QStringLiteral("All categories") && ad.category != selectedCategory) {
+    const QString selectedCategory = ui->cbCategory->currentData().toString();
+    if (!selectedCategory.isEmpty() && ad.category.compare(selectedCategory, Qt::CaseInsensitive) != 0) {
         return false;
     }
 
@@ -473,10 +759,21 @@ bool shop_page::passesFilters(const ShopItem& ad) const
     return true;
 }
 
+common::Message shop_page::buildAdListRequest()
+{
+    const QJsonObject filters = buildAdListPayload();
+    QJsonObject payload = filters;
+    if (!catalogVersion.isEmpty() && filters == lastAdListPayload) {
+        payload.insert(QStringLiteral("ifVersion"), catalogVersion);
+    }
+    lastAdListPayload = filters;
+    pendingAdsCursor.clear();
+    return AuthClient::instance()->withSession(common::Command::AdList, payload);
+}
+
 void shop_page::fetchAdsFromServer()
 {
-    AuthClient::instance()->sendMessage(
-        AuthClient::instance()->withSession(common::Command::AdList, buildAdListPayload()));
+    AuthClient::instance()->sendMessage(buildAdListRequest());
 }
 
 void shop_page::fetchCartFromServer()
@@ -486,8 +783,9 @@ void shop_page::fetchCartFromServer()
 
 void shop_page::refreshFromServer()
 {
-    fetchAdsFromServer();
-    fetchCartFromServer();
+    AuthClient* client = AuthClient::instance();
+    client->sendBatch({buildAdListRequest(),
+                       client->withSession(common::Command::CartList)});
 }
 
 void shop_page::on_btnRefreshAds_clicked()
@@ -5,10 +5,13 @@
 #include <QString>
 #include <QVector>
 
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QHash>
 #include <QByteArray>
 
+#include "protocol/message.h"
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
     class shop_page;
@@ -26,6 +29,7 @@ public:
         int priceTokens = 0;
         QString seller;
         QString status;
+        bool hasImage = false;
     };
 
     struct AdDetailData {
@@ -51,6 +55,12 @@ private slots:
     void on_btnBackToMenu_clicked();
 
 private:
+    struct ThumbnailData {
+        QByteArray imageBytes;
+        bool requested = false;
+        bool loaded = false;
+    };
+
     struct CartPreviewItem {
         int adId = -1;
         QString title;
@@ -59,12 +69,22 @@ private:
 
     void setupAdsTable();
     void refreshAdsTable();
+    void appendAdsRows(int firstRow);
+    void populateAdRow(int row, const ShopItem& ad);
+    void setThumbnailCell(int row, const ShopItem& ad);
+    void loadMoreAdsIfNeeded();
+    void applyListFacets(const QJsonObject& facets);
+    void refreshCategoryFilter(const QJsonArray& categories);
     void refreshCartPreview();
     void requestAdDetail(int adId);
+    void flushAdDetailRequests();
+    void requestThumbnail(int adId);
+    void flushThumbnailRequests();
     void showAdPreviewDialog(int adId);
     void fetchAdsFromServer();
     void fetchCartFromServer();
     QJsonObject buildAdListPayload() const;
+    common::Message buildAdListRequest();
     bool passesFilters(const ShopItem& ad) const;
 
 private:
@@ -74,7 +94,17 @@ private:
     QVector<int> filteredIndices;
     QVector<CartPreviewItem> cartPreviewItems;
     QHash<int, AdDetailData> adDetails;
+    QHash<int, ThumbnailData> adThumbnails;
+    QVector<int> queuedThumbnailIds;
+    QVector<int> queuedDetailIds;
+    // Ids of each AdDetailBatch still waiting for its result. Results come
+    // back in request order and carry no ids when they fail.
+    QList<QVector<int>> inFlightDetailBatches;
     int pendingPreviewAdId = -1;
+    QString catalogVersion;
+    QJsonObject lastAdListPayload;
+    QString nextAdsCursor;
+    QString pendingAdsCursor;
 };
 
 #endif // KALANET_SHOP_PAGE_H
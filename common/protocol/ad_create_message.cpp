@@ -1,4 +1,5 @@
 #include "protocol/ad_create_message.h"
+#include "protocol/base64_codec.h"
 
 #include <QJsonObject>
 
@@ -17,7 +18,7 @@ Message AdCreateMessage::createRequest(const QString& title,
     payload.insert(QStringLiteral("description"), description);
     payload.insert(QStringLiteral("category"), category);
     payload.insert(QStringLiteral("priceTokens"), priceTokens);
-    payload.insert(QStringLiteral("imageBase64"), QString::fromLatin1(imageBytes.toBase64()));
+    payload.insert(QStringLiteral("imageBase64"), Base64Codec::encodeToString(imageBytes));
 
     if (!sellerUsername.isEmpty()) {
         payload.insert(QStringLiteral("sellerUsername"), sellerUsername);
@@ -0,0 +1,110 @@
+#include "protocol/ad_upload_message.h"
+#include "protocol/base64_codec.h"
+
+#include <QJsonObject>
+
+namespace common {
+
+Message AdUploadMessage::createInitRequest(const QString& title,
+                                           const QString& description,
+                                           const QString& category,
+                                           int priceTokens,
+                                           qint64 imageSize,
+                                           const QString& imageSha256,
+                                           const QString& uploadId,
+                                           const QString& requestId)
+{
+    QJsonObject payload;
+    payload.insert(QStringLiteral("title"), title);
+    payload.insert(QStringLiteral("description"), description);
+    payload.insert(QStringLiteral("category"), category);
+    payload.insert(QStringLiteral("priceTokens"), priceTokens);
+    payload.insert(QStringLiteral("imageSize"), imageSize);
+    payload.insert(QStringLiteral("imageSha256"), imageSha256);
+
+    if (!uploadId.isEmpty()) {
+        payload.insert(QStringLiteral("uploadId"), uploadId);
+    }
+
+    return Message(Command::AdUploadInit, payload, requestId);
+}
+
+Message AdUploadMessage::createChunkRequest(const QString& uploadId,
+                                            int chunkIndex,
+                                            const QByteArray& chunkBytes,
+                                            const QString& requestId)
+{
+    QJsonObject payload;
+    payload.insert(QStringLiteral("uploadId"), uploadId);
+    payload.insert(QStringLiteral("chunkIndex"), chunkIndex);
+    payload.insert(QStringLiteral("dataBase64"), Base64Codec::encodeToString(chunkBytes));
+
+    return Message(Command::AdUploadChunk, payload, requestId);
+}
+
+Message AdUploadMessage::createCommitRequest(const QString& uploadId,
+                                             const QString& requestId)
+{
+    QJsonObject payload;
+    payload.insert(QStringLiteral("uploadId"), uploadId);
+
+    return Message(Command::AdUploadCommit, payload, requestId);
+}
+
+Message AdUploadMessage::createInitSuccessResponse(const QString& uploadId,
+                                                   int chunkSize,
+                                                   int nextChunkIndex,
+                                                   qint64 receivedBytes,
+                                                   const QString& requestId)
+{
+    QJsonObject payload;
+    payload.insert(QStringLiteral("success"), true);
+    payload.insert(QStringLiteral("uploadId"), uploadId);
+    payload.insert(QStringLiteral("chunkSize"), chunkSize);
+    payload.insert(QStringLiteral("nextChunkIndex"), nextChunkIndex);
+    payload.insert(QStringLiteral("receivedBytes"), receivedBytes);
+
+    return Message::makeSuccess(Command::AdUploadInitResult,
+                                payload,
+                                requestId,
+                                {},
+                                QStringLiteral("Upload session ready"));
+}
+
+Message AdUploadMessage::createChunkSuccessResponse(const QString& uploadId,
+                                                    int chunkIndex,
+                                                    int nextChunkIndex,
+                                                    qint64 receivedBytes,
+                                                    const QString& requestId)
+{
+    QJsonObject payload;
+    payload.insert(QStringLiteral("success"), true);
+    payload.insert(QStringLiteral("uploadId"), uploadId);
+    payload.insert(QStringLiteral("chunkIndex"), chunkIndex);
+    payload.insert(QStringLiteral("nextChunkIndex"), nextChunkIndex);
+    payload.insert(QStringLiteral("receivedBytes"), receivedBytes);
+
+    return Message::makeSuccess(Command::AdUploadChunkResult,
+                                payload,
+                                requestId,
+                                {},
+                                QStringLiteral("Chunk stored"));
+}
+
+Message AdUploadMessage::createFailureResponse(Command command,
+                                               ErrorCode errorCode,
+                                               const QString& reason,
+                                               const QString& uploadId,
+                                               const QString& requestId)
+{
+    QJsonObject payload;
+    payload.insert(QStringLiteral("success"), false);
+    payload.insert(QStringLiteral("message"), reason);
+    if (!uploadId.isEmpty()) {
+        payload.insert(QStringLiteral("uploadId"), uploadId);
+    }
+
+    return Message::makeFailure(command, errorCode, reason, payload, requestId);
+}
+
+} // namespace common
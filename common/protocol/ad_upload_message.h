@@ -0,0 +1,56 @@
+#ifndef COMMON_PROTOCOL_AD_UPLOAD_MESSAGE_H
+#define COMMON_PROTOCOL_AD_UPLOAD_MESSAGE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+#include "protocol/error_codes.h"
+#include "protocol/message.h"
+
+namespace common {
+
+class AdUploadMessage {
+public:
+    static constexpr qint64 kMaxImageBytes = 8 * 1024 * 1024;
+    static constexpr int kChunkBytes = 256 * 1024;
+
+    static Message createInitRequest(const QString& title,
+                                     const QString& description,
+                                     const QString& category,
+                                     int priceTokens,
+                                     qint64 imageSize,
+                                     const QString& imageSha256,
+                                     const QString& uploadId = {},
+                                     const QString& requestId = {});
+
+    static Message createChunkRequest(const QString& uploadId,
+                                      int chunkIndex,
+                                      const QByteArray& chunkBytes,
+                                      const QString& requestId = {});
+
+    static Message createCommitRequest(const QString& uploadId,
+                                       const QString& requestId = {});
+
+    static Message createInitSuccessResponse(const QString& uploadId,
+                                             int chunkSize,
+                                             int nextChunkIndex,
+                                             qint64 receivedBytes,
+                                             const QString& requestId = {});
+
+    static Message createChunkSuccessResponse(const QString& uploadId,
+                                              int chunkIndex,
+                                              int nextChunkIndex,
+                                              qint64 receivedBytes,
+                                              const QString& requestId = {});
+
+    static Message createFailureResponse(Command command,
+                                         ErrorCode errorCode,
+                                         const QString& reason,
+                                         const QString& uploadId = {},
+                                         const QString& requestId = {});
+};
+
+}
+
+#endif // COMMON_PROTOCOL_AD_UPLOAD_MESSAGE_H
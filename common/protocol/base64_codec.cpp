@@ -0,0 +1,33 @@
+#include "protocol/base64_codec.h"
+
+#include "simd/base64.h"
+
+namespace common {
+
+QString Base64Codec::encodeToString(const QByteArray& bytes)
+{
+    const std::size_t length = simd::base64EncodedLength(static_cast<std::size_t>(bytes.size()));
+    QString encoded(static_cast<qsizetype>(length), Qt::Uninitialized);
+    simd::base64Encode(reinterpret_cast<const unsigned char*>(bytes.constData()),
+                       static_cast<std::size_t>(bytes.size()),
+                       reinterpret_cast<char16_t*>(encoded.data()));
+    return encoded;
+}
+
+QByteArray Base64Codec::decode(QStringView text)
+{
+    const std::size_t size = static_cast<std::size_t>(text.size());
+    QByteArray decoded(static_cast<qsizetype>(simd::base64DecodedMaxLength(size)), Qt::Uninitialized);
+    std::size_t decodedSize = 0;
+    if (!simd::base64Decode(reinterpret_cast<const char16_t*>(text.utf16()),
+                            size,
+                            reinterpret_cast<unsigned char*>(decoded.data()),
+                            &decodedSize)) {
+        return QByteArray::fromBase64(text.toLatin1());
+    }
+
+    decoded.truncate(static_cast<qsizetype>(decodedSize));
+    return decoded;
+}
+
+}
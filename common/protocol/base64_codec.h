@@ -0,0 +1,23 @@
+#ifndef COMMON_PROTOCOL_BASE64_CODEC_H
+#define COMMON_PROTOCOL_BASE64_CODEC_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+
+namespace common {
+
+class Base64Codec {
+public:
+    // Encodes directly into the UTF-16 storage of the returned string, so the
+    // value can go into a QJsonObject without a Latin-1 round trip.
+    static QString encodeToString(const QByteArray& bytes);
+
+    // Decodes straight from UTF-16. Input that is not strict RFC 4648 is handed
+    // to QByteArray::fromBase64 so lenient peers keep working.
+    static QByteArray decode(QStringView text);
+};
+
+}
+
+#endif // COMMON_PROTOCOL_BASE64_CODEC_H
@@ -41,8 +41,17 @@ const QHash<Command, QString>& forwardMap()
         { Command::AdListResult, QStringLiteral("ad/list/response") },
         { Command::AdDetail, QStringLiteral("ad/detail/request") },
         { Command::AdDetailResult, QStringLiteral("ad/detail/response") },
+        { Command::AdDetailBatch, QStringLiteral("ad/detail/batch/request") },
+        { Command::AdDetailBatchResult, QStringLiteral("ad/detail/batch/response") },
+        { Command::AdThumbnailBatch, QStringLiteral("ad/thumbnail/batch/request") },
+        { Command::AdThumbnailBatchResult, QStringLiteral("ad/thumbnail/batch/response") },
         { Command::AdStatusUpdate, QStringLiteral("ad/status/update") },
         { Command::AdStatusNotify, QStringLiteral("ad/status/notify") },
+        { Command::AdUploadInit, QStringLiteral("ad/upload/init/request") },
+        { Command::AdUploadInitResult, QStringLiteral("ad/upload/init/response") },
+        { Command::AdUploadChunk, QStringLiteral("ad/upload/chunk/request") },
+        { Command::AdUploadChunkResult, QStringLiteral("ad/upload/chunk/response") },
+        { Command::AdUploadCommit, QStringLiteral("ad/upload/commit/request") },
 
         { Command::CategoryList, QStringLiteral("category/list/request") },
         { Command::CategoryListResult, QStringLiteral("category/list/response") },
@@ -76,6 +85,9 @@ const QHash<Command, QString>& forwardMap()
         { Command::DiscountCodeDelete, QStringLiteral("discount/delete/request") },
         { Command::DiscountCodeDeleteResult, QStringLiteral("discount/delete/response") },
 
+        { Command::Batch, QStringLiteral("system/batch/request") },
+        { Command::BatchResult, QStringLiteral("system/batch/response") },
+
         { Command::SystemNotification, QStringLiteral("system/notify") }
     };
 
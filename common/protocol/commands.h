@@ -39,8 +39,17 @@ namespace common {
         AdListResult,
         AdDetail,
         AdDetailResult,
+        AdDetailBatch,
+        AdDetailBatchResult,
+        AdThumbnailBatch,
+        AdThumbnailBatchResult,
         AdStatusUpdate,
         AdStatusNotify,
+        AdUploadInit,
+        AdUploadInitResult,
+        AdUploadChunk,
+        AdUploadChunkResult,
+        AdUploadCommit,
 
         CategoryList,
         CategoryListResult,
@@ -74,6 +83,9 @@ namespace common {
         DiscountCodeDelete,
         DiscountCodeDeleteResult,
 
+        Batch,
+        BatchResult,
+
         SystemNotification
     };
 
@@ -24,6 +24,7 @@ const QHash<ErrorCode, QString>& forwardMap()
         { ErrorCode::AdNotAvailable, QStringLiteral("AD_NOT_AVAILABLE") },
         { ErrorCode::DuplicateAd, QStringLiteral("DUPLICATE_AD") },
         { ErrorCode::DatabaseError, QStringLiteral("DATABASE_ERROR") },
+        { ErrorCode::ServiceBusy, QStringLiteral("SERVICE_BUSY") },
         { ErrorCode::InternalError, QStringLiteral("INTERNAL_ERROR") }
     };
 
@@ -81,6 +82,7 @@ int errorCodeToStatusCode(ErrorCode code)
     case ErrorCode::AdNotAvailable:
         return 410;
     case ErrorCode::DatabaseError:
+    case ErrorCode::ServiceBusy:
         return 503;
     case ErrorCode::InternalError:
     case ErrorCode::UnknownCommand:
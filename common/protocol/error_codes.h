@@ -21,6 +21,7 @@ namespace common {
         AdNotAvailable,
         DuplicateAd,
         DatabaseError,
+        ServiceBusy,
         InternalError
     };
 
@@ -0,0 +1,412 @@
+#include "protocol/json_frame_parser.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QJsonValue>
+
+#include <charconv>
+#include <cstddef>
+
+#include "simd/json_scan.h"
+
+namespace common {
+
+namespace {
+
+constexpr int kMaxNestingDepth = 1024;
+
+class FastJsonParser
+{
+public:
+    FastJsonParser(const char* data, qsizetype size)
+        : cursor_(data),
+          end_(data + size)
+    {
+    }
+
+    bool parseRootObject(QJsonObject& out)
+    {
+        skipWhitespace();
+        if (cursor_ == end_ || *cursor_ != '{') {
+            return false;
+        }
+        if (!parseObject(out)) {
+            return false;
+        }
+        skipWhitespace();
+        return cursor_ == end_;
+    }
+
+private:
+    void skipWhitespace()
+    {
+        cursor_ += simd::skipWhitespace(cursor_, static_cast<std::size_t>(end_ - cursor_));
+    }
+
+    bool consume(char expected)
+    {
+        skipWhitespace();
+        if (cursor_ == end_ || *cursor_ != expected) {
+            return false;
+        }
+        ++cursor_;
+        return true;
+    }
+
+    bool parseValue(QJsonValue& out)
+    {
+        skipWhitespace();
+        if (cursor_ == end_) {
+            return false;
+        }
+
+        switch (*cursor_) {
+        case '{': {
+            QJsonObject object;
+            if (!parseObject(object)) {
+                return false;
+            }
+            out = object;
+            return true;
+        }
+        case '[': {
+            QJsonArray array;
+            if (!parseArray(array)) {
+                return false;
+            }
+            out = array;
+            return true;
+        }
+        case '"': {
+            QString text;
+            if (!parseString(text)) {
+                return false;
+            }
+            out = text;
+            return true;
+        }
+        case 't':
+            out = true;
+            return parseLiteral("true", 4);
+        case 'f':
+            out = false;
+            return parseLiteral("false", 5);
+        case 'n':
+            out = QJsonValue(QJsonValue::Null);
+            return parseLiteral("null", 4);
+        default:
+            return parseNumber(out);
+        }
+    }
+
+    bool parseObject(QJsonObject& out)
+    {
+        if (++depth_ > kMaxNestingDepth) {
+            return false;
+        }
+        ++cursor_;
+
+        skipWhitespace();
+        if (cursor_ != end_ && *cursor_ == '}') {
+            ++cursor_;
+            --depth_;
+            return true;
+        }
+
+        while (true) {
+            skipWhitespace();
+            if (cursor_ == end_ || *cursor_ != '"') {
+                return false;
+            }
+
+            QString key;
+            if (!parseString(key) || !consume(':')) {
+                return false;
+            }
+
+            QJsonValue value;
+            if (!parseValue(value)) {
+                return false;
+            }
+            out.insert(key, value);
+
+            skipWhitespace();
+            if (cursor_ == end_) {
+                return false;
+            }
+            if (*cursor_ == ',') {
+                ++cursor_;
+                continue;
+            }
+            if (*cursor_ == '}') {
+                ++cursor_;
+                --depth_;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    bool parseArray(QJsonArray& out)
+    {
+        if (++depth_ > kMaxNestingDepth) {
+            return false;
+        }
+        ++cursor_;
+
+        skipWhitespace();
+        if (cursor_ != end_ && *cursor_ == ']') {
+            ++cursor_;
+            --depth_;
+            return true;
+        }
+
+        while (true) {
+            QJsonValue value;
+            if (!parseValue(value)) {
+                return false;
+            }
+            out.append(value);
+
+            skipWhitespace();
+            if (cursor_ == end_) {
+                return false;
+            }
+            if (*cursor_ == ',') {
+                ++cursor_;
+                continue;
+            }
+            if (*cursor_ == ']') {
+                ++cursor_;
+                --depth_;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    static QString decodeSegment(const char* data, std::size_t size, bool ascii)
+    {
+        return ascii ? QString::fromLatin1(data, static_cast<qsizetype>(size))
+                     : QString::fromUtf8(data, static_cast<qsizetype>(size));
+    }
+
+    bool parseString(QString& out)
+    {
+        ++cursor_;
+
+        bool ascii = true;
+        std::size_t length = simd::findStringSpecial(cursor_, static_cast<std::size_t>(end_ - cursor_), &ascii);
+        if (cursor_ + length == end_) {
+            return false;
+        }
+        if (cursor_[length] == '"') {
+            out = decodeSegment(cursor_, length, ascii);
+            cursor_ += length + 1;
+            return true;
+        }
+
+        QString result;
+        result.reserve(static_cast<qsizetype>(length) + 16);
+        while (true) {
+            result.append(decodeSegment(cursor_, length, ascii));
+            cursor_ += length;
+            if (cursor_ == end_) {
+                return false;
+            }
+
+            const char stop = *cursor_;
+            if (stop == '"') {
+                ++cursor_;
+                out = std::move(result);
+                return true;
+            }
+            if (stop != '\\' || !parseEscape(result)) {
+                return false;
+            }
+
+            ascii = true;
+            length = simd::findStringSpecial(cursor_, static_cast<std::size_t>(end_ - cursor_), &ascii);
+        }
+    }
+
+    bool parseEscape(QString& out)
+    {
+        ++cursor_;
+        if (cursor_ == end_) {
+            return false;
+        }
+
+        const char escaped = *cursor_++;
+        switch (escaped) {
+        case '"': out.append(QLatin1Char('"')); return true;
+        case '\\': out.append(QLatin1Char('\\')); return true;
+        case '/': out.append(QLatin1Char('/')); return true;
+        case 'b': out.append(QLatin1Char('\b')); return true;
+        case 'f': out.append(QLatin1Char('\f')); return true;
+        case 'n': out.append(QLatin1Char('\n')); return true;
+        case 'r': out.append(QLatin1Char('\r')); return true;
+        case 't': out.append(QLatin1Char('\t')); return true;
+        case 'u': {
+            char16_t unit = 0;
+            if (!parseHex4(unit)) {
+                return false;
+            }
+            out.append(QChar(unit));
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    bool parseHex4(char16_t& out)
+    {
+        if (end_ - cursor_ < 4) {
+            return false;
+        }
+
+        char16_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char ch = *cursor_++;
+            value = static_cast<char16_t>(value << 4);
+            if (ch >= '0' && ch <= '9') {
+                value = static_cast<char16_t>(value | (ch - '0'));
+            } else if (ch >= 'a' && ch <= 'f') {
+                value = static_cast<char16_t>(value | (ch - 'a' + 10));
+            } else if (ch >= 'A' && ch <= 'F') {
+                value = static_cast<char16_t>(value | (ch - 'A' + 10));
+            } else {
+                return false;
+            }
+        }
+        out = value;
+        return true;
+    }
+
+    bool parseLiteral(const char* literal, int length)
+    {
+        if (end_ - cursor_ < length) {
+            return false;
+        }
+        for (int i = 0; i < length; ++i) {
+            if (cursor_[i] != literal[i]) {
+                return false;
+            }
+        }
+        cursor_ += length;
+        return true;
+    }
+
+    static bool isDigit(char ch)
+    {
+        return ch >= '0' && ch <= '9';
+    }
+
+    bool parseNumber(QJsonValue& out)
+    {
+        const char* start = cursor_;
+        const char* p = cursor_;
+        if (p != end_ && *p == '-') {
+            ++p;
+        }
+        if (p == end_ || !isDigit(*p)) {
+            return false;
+        }
+        if (*p == '0') {
+            ++p;
+        } else {
+            while (p != end_ && isDigit(*p)) {
+                ++p;
+            }
+        }
+
+        bool integral = true;
+        if (p != end_ && *p == '.') {
+            integral = false;
+            ++p;
+            if (p == end_ || !isDigit(*p)) {
+                return false;
+            }
+            while (p != end_ && isDigit(*p)) {
+                ++p;
+            }
+        }
+        if (p != end_ && (*p == 'e' || *p == 'E')) {
+            integral = false;
+            ++p;
+            if (p != end_ && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            if (p == end_ || !isDigit(*p)) {
+                return false;
+            }
+            while (p != end_ && isDigit(*p)) {
+                ++p;
+            }
+        }
+
+        if (integral) {
+            qint64 integer = 0;
+            const auto [ptr, ec] = std::from_chars(start, p, integer);
+            if (ec == std::errc() && ptr == p) {
+                out = integer;
+                cursor_ = p;
+                return true;
+            }
+        }
+
+        double number = 0.0;
+        const auto [ptr, ec] = std::from_chars(start, p, number);
+        if (ec != std::errc() || ptr != p) {
+            return false;
+        }
+        out = number;
+        cursor_ = p;
+        return true;
+    }
+
+    const char* cursor_;
+    const char* end_;
+    int depth_ = 0;
+};
+
+}
+
+std::optional<QJsonObject> JsonFrameParser::parseObjectFast(const char* data, qsizetype size)
+{
+    QJsonObject object;
+    FastJsonParser parser(data, size);
+    if (!parser.parseRootObject(object)) {
+        return std::nullopt;
+    }
+    return object;
+}
+
+std::optional<QJsonObject> JsonFrameParser::parseObject(const QByteArray& bytes, QString* error)
+{
+    if (auto object = parseObjectFast(bytes.constData(), bytes.size())) {
+        return object;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(bytes, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        if (error) {
+            *error = parseError.errorString();
+        }
+        return std::nullopt;
+    }
+
+    if (!doc.isObject()) {
+        if (error) {
+            *error = QStringLiteral("Root JSON is not an object");
+        }
+        return std::nullopt;
+    }
+
+    return doc.object();
+}
+
+}
@@ -0,0 +1,25 @@
+#ifndef COMMON_PROTOCOL_JSON_FRAME_PARSER_H
+#define COMMON_PROTOCOL_JSON_FRAME_PARSER_H
+
+#include <optional>
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+namespace common {
+
+class JsonFrameParser {
+public:
+    // Parses a frame whose root must be a JSON object. Uses the SIMD-assisted
+    // parser and falls back to QJsonDocument for anything it rejects, so error
+    // text and edge-case behaviour match Qt.
+    static std::optional<QJsonObject> parseObject(const QByteArray& bytes, QString* error = nullptr);
+
+    // Fast path only; no QJsonDocument fallback.
+    static std::optional<QJsonObject> parseObjectFast(const char* data, qsizetype size);
+};
+
+}
+
+#endif // COMMON_PROTOCOL_JSON_FRAME_PARSER_H
@@ -4,6 +4,7 @@
 #include <QJsonValue>
 
 #include "protocol/command_utils.h"
+#include "protocol/json_frame_parser.h"
 
 namespace common {
 
@@ -140,23 +141,12 @@ QByteArray Message::serialize() const
 
     std::optional<Message> Message::deserialize(const QByteArray& bytes, QString* error)
 {
-    QJsonParseError parseError;
-    const QJsonDocument doc = QJsonDocument::fromJson(bytes, &parseError);
-    if (parseError.error != QJsonParseError::NoError) {
-        if (error) {
-            *error = parseError.errorString();
-        }
-        return std::nullopt;
-    }
-
-    if (!doc.isObject()) {
-        if (error) {
-            *error = QStringLiteral("Root JSON is not an object");
-        }
+    const std::optional<QJsonObject> object = JsonFrameParser::parseObject(bytes, error);
+    if (!object) {
         return std::nullopt;
     }
 
-    return fromJson(doc.object(), error);
+    return fromJson(*object, error);
 }
 
 
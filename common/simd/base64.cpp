@@ -0,0 +1,446 @@
+#include "simd/base64.h"
+
+#include "simd/cpu_features.h"
+
+#include <array>
+#include <type_traits>
+
+#if defined(KALANET_ENABLE_SIMD) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define KALANET_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// Vector kernels follow Muła and Lemire, "Faster Base64 Encoding and Decoding
+// using AVX2 Instructions" (ACM TWEB 2018): multiply-shift bit unpacking for
+// encoding and nibble lookup tables for validation/translation when decoding.
+
+namespace common::simd {
+
+namespace {
+
+constexpr char kEncodeTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+constexpr std::array<signed char, 256> makeDecodeTable()
+{
+    std::array<signed char, 256> table{};
+    for (auto& entry : table) {
+        entry = -1;
+    }
+    for (int i = 0; i < 64; ++i) {
+        table[static_cast<unsigned char>(kEncodeTable[i])] = static_cast<signed char>(i);
+    }
+    return table;
+}
+
+constexpr std::array<signed char, 256> kDecodeTable = makeDecodeTable();
+
+template <typename Out>
+void encodeScalar(const unsigned char* src, std::size_t size, Out* dst)
+{
+    std::size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        const unsigned int triple = (static_cast<unsigned int>(src[i]) << 16)
+                                    | (static_cast<unsigned int>(src[i + 1]) << 8)
+                                    | static_cast<unsigned int>(src[i + 2]);
+        *dst++ = static_cast<Out>(kEncodeTable[(triple >> 18) & 0x3F]);
+        *dst++ = static_cast<Out>(kEncodeTable[(triple >> 12) & 0x3F]);
+        *dst++ = static_cast<Out>(kEncodeTable[(triple >> 6) & 0x3F]);
+        *dst++ = static_cast<Out>(kEncodeTable[triple & 0x3F]);
+    }
+
+    const std::size_t remaining = size - i;
+    if (remaining == 1) {
+        const unsigned int value = static_cast<unsigned int>(src[i]) << 16;
+        *dst++ = static_cast<Out>(kEncodeTable[(value >> 18) & 0x3F]);
+        *dst++ = static_cast<Out>(kEncodeTable[(value >> 12) & 0x3F]);
+        *dst++ = static_cast<Out>('=');
+        *dst++ = static_cast<Out>('=');
+    } else if (remaining == 2) {
+        const unsigned int value = (static_cast<unsigned int>(src[i]) << 16)
+                                   | (static_cast<unsigned int>(src[i + 1]) << 8);
+        *dst++ = static_cast<Out>(kEncodeTable[(value >> 18) & 0x3F]);
+        *dst++ = static_cast<Out>(kEncodeTable[(value >> 12) & 0x3F]);
+        *dst++ = static_cast<Out>(kEncodeTable[(value >> 6) & 0x3F]);
+        *dst++ = static_cast<Out>('=');
+    }
+}
+
+template <typename In>
+inline int decodeChar(In ch)
+{
+    const auto code = static_cast<std::make_unsigned_t<In>>(ch);
+    if (code > 0xFF) {
+        return -1;
+    }
+    return kDecodeTable[code];
+}
+
+// Decodes a body without padding. Returns false on an invalid character or length.
+template <typename In>
+bool decodeScalar(const In* src, std::size_t size, unsigned char* dst, std::size_t* written)
+{
+    std::size_t out = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const int a = decodeChar(src[i]);
+        const int b = decodeChar(src[i + 1]);
+        const int c = decodeChar(src[i + 2]);
+        const int d = decodeChar(src[i + 3]);
+        if ((a | b | c | d) < 0) {
+            return false;
+        }
+        const unsigned int triple = (static_cast<unsigned int>(a) << 18)
+                                    | (static_cast<unsigned int>(b) << 12)
+                                    | (static_cast<unsigned int>(c) << 6)
+                                    | static_cast<unsigned int>(d);
+        dst[out++] = static_cast<unsigned char>(triple >> 16);
+        dst[out++] = static_cast<unsigned char>(triple >> 8);
+        dst[out++] = static_cast<unsigned char>(triple);
+    }
+
+    const std::size_t remaining = size - i;
+    if (remaining == 1) {
+        return false;
+    }
+    if (remaining >= 2) {
+        const int a = decodeChar(src[i]);
+        const int b = decodeChar(src[i + 1]);
+        const int c = remaining == 3 ? decodeChar(src[i + 2]) : 0;
+        if ((a | b | c) < 0) {
+            return false;
+        }
+        const unsigned int value = (static_cast<unsigned int>(a) << 18)
+                                   | (static_cast<unsigned int>(b) << 12)
+                                   | (static_cast<unsigned int>(c) << 6);
+        dst[out++] = static_cast<unsigned char>(value >> 16);
+        if (remaining == 3) {
+            dst[out++] = static_cast<unsigned char>(value >> 8);
+        }
+    }
+
+    *written += out;
+    return true;
+}
+
+#if defined(KALANET_X86_KERNELS)
+
+__attribute__((target("avx2")))
+inline __m256i encodeTranslateAvx2(__m256i indices)
+{
+    const __m256i lut = _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+                                         65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    __m256i offsets = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    offsets = _mm256_sub_epi8(offsets, _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)));
+    return _mm256_add_epi8(indices, _mm256_shuffle_epi8(lut, offsets));
+}
+
+template <typename Out>
+__attribute__((target("avx2")))
+std::size_t encodeAvx2(const unsigned char* src, std::size_t size, Out* dst)
+{
+    const __m256i shiftLanes = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+    const __m256i reshuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                              14, 15, 13, 14, 11, 12, 10, 11, 8, 9, 7, 8, 5, 6, 4, 5);
+
+    std::size_t consumed = 0;
+    while (size - consumed >= 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + consumed));
+        in = _mm256_permutevar8x32_epi32(in, shiftLanes);
+        in = _mm256_shuffle_epi8(in, reshuffle);
+
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i encoded = encodeTranslateAvx2(_mm256_or_si256(t1, t3));
+
+        if constexpr (sizeof(Out) == 1) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), encoded);
+        } else {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                                _mm256_cvtepu8_epi16(_mm256_castsi256_si128(encoded)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 16),
+                                _mm256_cvtepu8_epi16(_mm256_extracti128_si256(encoded, 1)));
+        }
+
+        consumed += 24;
+        dst += 32;
+    }
+    return consumed;
+}
+
+template <typename In>
+__attribute__((target("avx2")))
+std::size_t decodeAvx2(const In* src, std::size_t size, unsigned char* dst, std::size_t* written)
+{
+    const __m256i lutLo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                           0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                           0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                           0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lutHi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                           0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                           0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                           0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                             0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask2F = _mm256_set1_epi8(0x2F);
+    const __m256i packShuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i packLanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+    std::size_t consumed = 0;
+    std::size_t out = 0;
+    while (size - consumed >= 45) {
+        __m256i str;
+        if constexpr (sizeof(In) == 1) {
+            str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + consumed));
+        } else {
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + consumed));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + consumed + 16));
+            str = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        }
+
+        const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2F);
+        const __m256i loNibbles = _mm256_and_si256(str, mask2F);
+        const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+        if (!_mm256_testz_si256(lo, hi)) {
+            break;
+        }
+
+        const __m256i eq2F = _mm256_cmpeq_epi8(str, mask2F);
+        const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+        str = _mm256_add_epi8(str, roll);
+
+        const __m256i merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_shuffle_epi8(packed, packShuffle);
+        packed = _mm256_permutevar8x32_epi32(packed, packLanes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + out), packed);
+
+        consumed += 32;
+        out += 24;
+    }
+
+    *written += out;
+    return consumed;
+}
+
+__attribute__((target("ssse3")))
+inline __m128i encodeTranslateSsse3(__m128i indices)
+{
+    const __m128i lut = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    __m128i offsets = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    offsets = _mm_sub_epi8(offsets, _mm_cmpgt_epi8(indices, _mm_set1_epi8(25)));
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(lut, offsets));
+}
+
+template <typename Out>
+__attribute__((target("ssse3")))
+std::size_t encodeSsse3(const unsigned char* src, std::size_t size, Out* dst)
+{
+    const __m128i reshuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+
+    std::size_t consumed = 0;
+    while (size - consumed >= 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + consumed));
+        in = _mm_shuffle_epi8(in, reshuffle);
+
+        const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003F03F0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        const __m128i encoded = encodeTranslateSsse3(_mm_or_si128(t1, t3));
+
+        if constexpr (sizeof(Out) == 1) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), encoded);
+        } else {
+            const __m128i zero = _mm_setzero_si128();
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi8(encoded, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpackhi_epi8(encoded, zero));
+        }
+
+        consumed += 12;
+        dst += 16;
+    }
+    return consumed;
+}
+
+template <typename In>
+__attribute__((target("ssse3")))
+std::size_t decodeSsse3(const In* src, std::size_t size, unsigned char* dst, std::size_t* written)
+{
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2F);
+    const __m128i packShuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    std::size_t consumed = 0;
+    std::size_t out = 0;
+    while (size - consumed >= 24) {
+        __m128i str;
+        if constexpr (sizeof(In) == 1) {
+            str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + consumed));
+        } else {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + consumed));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + consumed + 8));
+            str = _mm_packus_epi16(lo, hi);
+        }
+
+        const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+        const __m128i loNibbles = _mm_and_si128(str, mask2F);
+        const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) {
+            break;
+        }
+
+        const __m128i eq2F = _mm_cmpeq_epi8(str, mask2F);
+        const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+        str = _mm_add_epi8(str, roll);
+
+        const __m128i merged = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        packed = _mm_shuffle_epi8(packed, packShuffle);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out), packed);
+
+        consumed += 16;
+        out += 12;
+    }
+
+    *written += out;
+    return consumed;
+}
+
+#endif
+
+enum class Base64Kernel {
+    Scalar,
+    Ssse3,
+    Avx2
+};
+
+Base64Kernel selectKernel()
+{
+#if defined(KALANET_X86_KERNELS)
+    const CpuFeatures& features = cpuFeatures();
+    if (features.avx2) {
+        return Base64Kernel::Avx2;
+    }
+    if (features.ssse3) {
+        return Base64Kernel::Ssse3;
+    }
+#endif
+    return Base64Kernel::Scalar;
+}
+
+Base64Kernel activeKernel()
+{
+    static const Base64Kernel kernel = selectKernel();
+    return kernel;
+}
+
+template <typename Out>
+void encodeDispatch(const unsigned char* src, std::size_t size, Out* dst)
+{
+    std::size_t consumed = 0;
+#if defined(KALANET_X86_KERNELS)
+    switch (activeKernel()) {
+    case Base64Kernel::Avx2:
+        consumed = encodeAvx2(src, size, dst);
+        break;
+    case Base64Kernel::Ssse3:
+        consumed = encodeSsse3(src, size, dst);
+        break;
+    case Base64Kernel::Scalar:
+        break;
+    }
+#endif
+    encodeScalar(src + consumed, size - consumed, dst + (consumed / 3) * 4);
+}
+
+template <typename In>
+bool decodeDispatch(const In* src, std::size_t size, unsigned char* dst, std::size_t* decodedSize)
+{
+    std::size_t body = size;
+    if (body > 0 && src[body - 1] == In('=')) {
+        --body;
+        if (body > 0 && src[body - 1] == In('=')) {
+            --body;
+        }
+        if (size % 4 != 0) {
+            return false;
+        }
+    }
+
+    std::size_t written = 0;
+    std::size_t consumed = 0;
+#if defined(KALANET_X86_KERNELS)
+    switch (activeKernel()) {
+    case Base64Kernel::Avx2:
+        consumed = decodeAvx2(src, body, dst, &written);
+        break;
+    case Base64Kernel::Ssse3:
+        consumed = decodeSsse3(src, body, dst, &written);
+        break;
+    case Base64Kernel::Scalar:
+        break;
+    }
+#endif
+    if (!decodeScalar(src + consumed, body - consumed, dst + written, &written)) {
+        return false;
+    }
+
+    *decodedSize = written;
+    return true;
+}
+
+}
+
+std::size_t base64EncodedLength(std::size_t size)
+{
+    return ((size + 2) / 3) * 4;
+}
+
+std::size_t base64DecodedMaxLength(std::size_t size)
+{
+    return ((size + 3) / 4) * 3;
+}
+
+void base64Encode(const unsigned char* src, std::size_t size, char* dst)
+{
+    encodeDispatch(src, size, dst);
+}
+
+void base64Encode(const unsigned char* src, std::size_t size, char16_t* dst)
+{
+    encodeDispatch(src, size, dst);
+}
+
+bool base64Decode(const char* src, std::size_t size, unsigned char* dst, std::size_t* decodedSize)
+{
+    return decodeDispatch(src, size, dst, decodedSize);
+}
+
+bool base64Decode(const char16_t* src, std::size_t size, unsigned char* dst, std::size_t* decodedSize)
+{
+    return decodeDispatch(src, size, dst, decodedSize);
+}
+
+const char* base64KernelName()
+{
+    switch (activeKernel()) {
+    case Base64Kernel::Avx2:
+        return "avx2";
+    case Base64Kernel::Ssse3:
+        return "ssse3";
+    case Base64Kernel::Scalar:
+    default:
+        return "scalar";
+    }
+}
+
+}
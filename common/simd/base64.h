@@ -0,0 +1,24 @@
+#ifndef COMMON_SIMD_BASE64_H
+#define COMMON_SIMD_BASE64_H
+
+#include <cstddef>
+
+namespace common::simd {
+
+std::size_t base64EncodedLength(std::size_t size);
+std::size_t base64DecodedMaxLength(std::size_t size);
+
+// Writes exactly base64EncodedLength(size) characters (standard alphabet, padded).
+void base64Encode(const unsigned char* src, std::size_t size, char* dst);
+void base64Encode(const unsigned char* src, std::size_t size, char16_t* dst);
+
+// Strict decoding: standard alphabet only, optional trailing padding, no whitespace.
+// dst must hold base64DecodedMaxLength(size) bytes. Returns false on malformed input.
+bool base64Decode(const char* src, std::size_t size, unsigned char* dst, std::size_t* decodedSize);
+bool base64Decode(const char16_t* src, std::size_t size, unsigned char* dst, std::size_t* decodedSize);
+
+const char* base64KernelName();
+
+}
+
+#endif // COMMON_SIMD_BASE64_H
@@ -0,0 +1,145 @@
+#include "simd/column_filter.h"
+
+#include "simd/cpu_features.h"
+
+#include <algorithm>
+#include <bit>
+
+#if defined(KALANET_ENABLE_SIMD) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define KALANET_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace common::simd {
+
+namespace {
+
+std::uint64_t matchWordScalar(const std::int32_t* values,
+                              const std::int32_t* keys,
+                              std::size_t count,
+                              std::int32_t lo,
+                              std::int32_t hi,
+                              std::int32_t key)
+{
+    // Branch-free: one unsigned compare covers both range bounds.
+    const std::uint32_t span = static_cast<std::uint32_t>(hi) - static_cast<std::uint32_t>(lo);
+    const bool anyKey = key < 0;
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const bool inRange = static_cast<std::uint32_t>(values[i]) - static_cast<std::uint32_t>(lo) <= span;
+        const bool match = inRange & (anyKey | (keys[i] == key));
+        bits |= static_cast<std::uint64_t>(match) << i;
+    }
+    return bits;
+}
+
+std::size_t filterRangeEqualsScalar(const std::int32_t* values,
+                                    const std::int32_t* keys,
+                                    std::size_t count,
+                                    std::int32_t lo,
+                                    std::int32_t hi,
+                                    std::int32_t key,
+                                    std::uint64_t* mask)
+{
+    std::size_t matches = 0;
+    for (std::size_t base = 0; base < count; base += 64) {
+        const std::size_t width = std::min<std::size_t>(64, count - base);
+        const std::uint64_t bits = matchWordScalar(values + base, keys + base, width, lo, hi, key);
+        mask[base / 64] = bits;
+        matches += static_cast<std::size_t>(std::popcount(bits));
+    }
+    return matches;
+}
+
+#if defined(KALANET_X86_KERNELS)
+
+__attribute__((target("avx2")))
+std::size_t filterRangeEqualsAvx2(const std::int32_t* values,
+                                  const std::int32_t* keys,
+                                  std::size_t count,
+                                  std::int32_t lo,
+                                  std::int32_t hi,
+                                  std::int32_t key,
+                                  std::uint64_t* mask)
+{
+    const __m256i low = _mm256_set1_epi32(lo);
+    const __m256i high = _mm256_set1_epi32(hi);
+    const __m256i wanted = _mm256_set1_epi32(key);
+    const __m256i allOnes = _mm256_set1_epi32(-1);
+    const bool matchKey = key >= 0;
+
+    std::size_t matches = 0;
+    std::size_t base = 0;
+    for (; base + 64 <= count; base += 64) {
+        std::uint64_t bits = 0;
+        for (std::size_t lane = 0; lane < 64; lane += 8) {
+            const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + base + lane));
+            __m256i reject = _mm256_or_si256(_mm256_cmpgt_epi32(low, value), _mm256_cmpgt_epi32(value, high));
+            if (matchKey) {
+                const __m256i candidate = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + base + lane));
+                reject = _mm256_or_si256(reject, _mm256_xor_si256(_mm256_cmpeq_epi32(candidate, wanted), allOnes));
+            }
+            const unsigned int rejected = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(reject)));
+            bits |= static_cast<std::uint64_t>(~rejected & 0xFFu) << lane;
+        }
+        mask[base / 64] = bits;
+        matches += static_cast<std::size_t>(std::popcount(bits));
+    }
+
+    if (base < count) {
+        const std::uint64_t bits = matchWordScalar(values + base, keys + base, count - base, lo, hi, key);
+        mask[base / 64] = bits;
+        matches += static_cast<std::size_t>(std::popcount(bits));
+    }
+    return matches;
+}
+
+#endif
+
+struct ColumnFilterKernel {
+    std::size_t (*filterRangeEquals)(const std::int32_t*, const std::int32_t*, std::size_t,
+                                     std::int32_t, std::int32_t, std::int32_t, std::uint64_t*);
+    const char* name;
+};
+
+ColumnFilterKernel selectKernel()
+{
+#if defined(KALANET_X86_KERNELS)
+    if (cpuFeatures().avx2) {
+        return {filterRangeEqualsAvx2, "avx2"};
+    }
+#endif
+    return {filterRangeEqualsScalar, "scalar"};
+}
+
+const ColumnFilterKernel& kernel()
+{
+    static const ColumnFilterKernel selected = selectKernel();
+    return selected;
+}
+
+}
+
+std::size_t filterRangeEquals(const std::int32_t* values,
+                              const std::int32_t* keys,
+                              std::size_t count,
+                              std::int32_t lo,
+                              std::int32_t hi,
+                              std::int32_t key,
+                              std::uint64_t* mask)
+{
+    // The kernels fold both bounds into one unsigned span, which wraps when
+    // the range is empty.
+    if (lo > hi) {
+        std::fill_n(mask, (count + 63) / 64, std::uint64_t{0});
+        return 0;
+    }
+    return kernel().filterRangeEquals(values, keys, count, lo, hi, key, mask);
+}
+
+const char* columnFilterKernelName()
+{
+    return kernel().name;
+}
+
+}
@@ -0,0 +1,24 @@
+#ifndef COMMON_SIMD_COLUMN_FILTER_H
+#define COMMON_SIMD_COLUMN_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace common::simd {
+
+// Sets bit i of mask when lo <= values[i] <= hi and, if key >= 0, keys[i] == key.
+// mask must hold (count + 63) / 64 words; bits past count are cleared. Returns
+// the number of bits set, which is zero whenever lo > hi.
+std::size_t filterRangeEquals(const std::int32_t* values,
+                              const std::int32_t* keys,
+                              std::size_t count,
+                              std::int32_t lo,
+                              std::int32_t hi,
+                              std::int32_t key,
+                              std::uint64_t* mask);
+
+const char* columnFilterKernelName();
+
+}
+
+#endif // COMMON_SIMD_COLUMN_FILTER_H
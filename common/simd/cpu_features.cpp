@@ -0,0 +1,54 @@
+#include "simd/cpu_features.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(KALANET_ENABLE_SIMD) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define KALANET_X86_DISPATCH 1
+#include <cpuid.h>
+#endif
+
+namespace common::simd {
+
+namespace {
+
+bool simdDisabledByEnvironment()
+{
+    const char* value = std::getenv("KALANET_DISABLE_SIMD");
+    return value && *value && std::strcmp(value, "0") != 0;
+}
+
+CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features;
+    if (simdDisabledByEnvironment()) {
+        return features;
+    }
+
+#if defined(KALANET_X86_DISPATCH)
+    __builtin_cpu_init();
+    features.ssse3 = __builtin_cpu_supports("ssse3");
+    features.sse42 = __builtin_cpu_supports("sse4.2");
+    features.avx2 = __builtin_cpu_supports("avx2");
+
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        features.shaNi = features.sse42 && ((ebx >> 29) & 1u) != 0;
+    }
+#endif
+
+    return features;
+}
+
+}
+
+const CpuFeatures& cpuFeatures()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+}
@@ -0,0 +1,18 @@
+#ifndef COMMON_SIMD_CPU_FEATURES_H
+#define COMMON_SIMD_CPU_FEATURES_H
+
+namespace common::simd {
+
+struct CpuFeatures {
+    bool ssse3 = false;
+    bool sse42 = false;
+    bool avx2 = false;
+    bool shaNi = false;
+};
+
+// Detected once per process. Setting KALANET_DISABLE_SIMD=1 forces the scalar paths.
+const CpuFeatures& cpuFeatures();
+
+}
+
+#endif // COMMON_SIMD_CPU_FEATURES_H
@@ -0,0 +1,210 @@
+#include "simd/json_scan.h"
+
+#include "simd/cpu_features.h"
+
+#if defined(KALANET_ENABLE_SIMD) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define KALANET_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace common::simd {
+
+namespace {
+
+inline bool isStringSpecial(unsigned char ch)
+{
+    return ch == '"' || ch == '\\' || ch < 0x20;
+}
+
+inline bool isJsonWhitespace(unsigned char ch)
+{
+    return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t';
+}
+
+std::size_t findStringSpecialScalar(const char* data, std::size_t size, bool* ascii)
+{
+    unsigned char highBits = 0;
+    std::size_t i = 0;
+    for (; i < size; ++i) {
+        const unsigned char ch = static_cast<unsigned char>(data[i]);
+        if (isStringSpecial(ch)) {
+            break;
+        }
+        highBits |= ch;
+    }
+    if (highBits & 0x80) {
+        *ascii = false;
+    }
+    return i;
+}
+
+std::size_t skipWhitespaceScalar(const char* data, std::size_t size)
+{
+    std::size_t i = 0;
+    while (i < size && isJsonWhitespace(static_cast<unsigned char>(data[i]))) {
+        ++i;
+    }
+    return i;
+}
+
+#if defined(KALANET_X86_KERNELS)
+
+__attribute__((target("avx2")))
+std::size_t findStringSpecialAvx2(const char* data, std::size_t size, bool* ascii)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i controlMax = _mm256_set1_epi8(0x1F);
+
+    std::size_t i = 0;
+    unsigned int highBits = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i isQuote = _mm256_cmpeq_epi8(chunk, quote);
+        const __m256i isBackslash = _mm256_cmpeq_epi8(chunk, backslash);
+        const __m256i isControl = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, controlMax), controlMax);
+        const unsigned int special = static_cast<unsigned int>(
+            _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(isQuote, isBackslash), isControl)));
+        const unsigned int high = static_cast<unsigned int>(_mm256_movemask_epi8(chunk));
+        if (special != 0) {
+            const unsigned int offset = static_cast<unsigned int>(__builtin_ctz(special));
+            highBits |= high & ((1u << offset) - 1u);
+            if (highBits) {
+                *ascii = false;
+            }
+            return i + offset;
+        }
+        highBits |= high;
+    }
+
+    if (highBits) {
+        *ascii = false;
+    }
+    return i + findStringSpecialScalar(data + i, size - i, ascii);
+}
+
+__attribute__((target("avx2")))
+std::size_t skipWhitespaceAvx2(const char* data, std::size_t size)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriageReturn = _mm256_set1_epi8('\r');
+    const __m256i tab = _mm256_set1_epi8('\t');
+
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, newline)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, carriageReturn), _mm256_cmpeq_epi8(chunk, tab)));
+        const unsigned int other = ~static_cast<unsigned int>(_mm256_movemask_epi8(whitespace));
+        if (other != 0) {
+            return i + static_cast<unsigned int>(__builtin_ctz(other));
+        }
+    }
+    return i + skipWhitespaceScalar(data + i, size - i);
+}
+
+__attribute__((target("sse4.2")))
+std::size_t findStringSpecialSse42(const char* data, std::size_t size, bool* ascii)
+{
+    alignas(16) static const char kRanges[16] = {'\0', '\x1F', '"', '"', '\\', '\\'};
+    const __m128i ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(kRanges));
+
+    std::size_t i = 0;
+    unsigned int highBits = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const int offset = _mm_cmpestri(ranges, 6, chunk, 16,
+                                        _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        const unsigned int high = static_cast<unsigned int>(_mm_movemask_epi8(chunk));
+        if (offset < 16) {
+            highBits |= high & ((1u << offset) - 1u);
+            if (highBits) {
+                *ascii = false;
+            }
+            return i + static_cast<std::size_t>(offset);
+        }
+        highBits |= high;
+    }
+
+    if (highBits) {
+        *ascii = false;
+    }
+    return i + findStringSpecialScalar(data + i, size - i, ascii);
+}
+
+__attribute__((target("sse4.2")))
+std::size_t skipWhitespaceSse42(const char* data, std::size_t size)
+{
+    alignas(16) static const char kWhitespace[16] = {' ', '\n', '\r', '\t'};
+    const __m128i whitespace = _mm_load_si128(reinterpret_cast<const __m128i*>(kWhitespace));
+
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const int offset = _mm_cmpestri(whitespace, 4, chunk, 16,
+                                        _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY
+                                            | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+        if (offset < 16) {
+            return i + static_cast<std::size_t>(offset);
+        }
+    }
+    return i + skipWhitespaceScalar(data + i, size - i);
+}
+
+#endif
+
+struct JsonScanKernels {
+    std::size_t (*findStringSpecial)(const char*, std::size_t, bool*);
+    std::size_t (*skipWhitespace)(const char*, std::size_t);
+    const char* name;
+};
+
+JsonScanKernels selectKernels()
+{
+#if defined(KALANET_X86_KERNELS)
+    const CpuFeatures& features = cpuFeatures();
+    if (features.avx2) {
+        return {findStringSpecialAvx2, skipWhitespaceAvx2, "avx2"};
+    }
+    if (features.sse42) {
+        return {findStringSpecialSse42, skipWhitespaceSse42, "sse4.2"};
+    }
+#endif
+    return {findStringSpecialScalar, skipWhitespaceScalar, "scalar"};
+}
+
+const JsonScanKernels& kernels()
+{
+    static const JsonScanKernels selected = selectKernels();
+    return selected;
+}
+
+}
+
+std::size_t findStringSpecial(const char* data, std::size_t size, bool* ascii)
+{
+    return kernels().findStringSpecial(data, size, ascii);
+}
+
+std::size_t skipWhitespace(const char* data, std::size_t size)
+{
+    const std::size_t inlineLimit = size < 4 ? size : 4;
+    for (std::size_t i = 0; i < inlineLimit; ++i) {
+        if (!isJsonWhitespace(static_cast<unsigned char>(data[i]))) {
+            return i;
+        }
+    }
+    if (inlineLimit == size) {
+        return size;
+    }
+    return inlineLimit + kernels().skipWhitespace(data + inlineLimit, size - inlineLimit);
+}
+
+const char* jsonScanKernelName()
+{
+    return kernels().name;
+}
+
+}
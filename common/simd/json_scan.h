@@ -0,0 +1,19 @@
+#ifndef COMMON_SIMD_JSON_SCAN_H
+#define COMMON_SIMD_JSON_SCAN_H
+
+#include <cstddef>
+
+namespace common::simd {
+
+// Offset of the first '"', '\\' or control byte (< 0x20) in [data, data + size),
+// or size when there is none. *ascii is cleared if a byte >= 0x80 precedes that offset.
+std::size_t findStringSpecial(const char* data, std::size_t size, bool* ascii);
+
+// Offset of the first byte that is not JSON whitespace, or size.
+std::size_t skipWhitespace(const char* data, std::size_t size);
+
+const char* jsonScanKernelName();
+
+}
+
+#endif // COMMON_SIMD_JSON_SCAN_H
@@ -0,0 +1,374 @@
+#include "simd/sha256.h"
+
+#include "simd/cpu_features.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(KALANET_ENABLE_SIMD) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define KALANET_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace common::simd {
+
+namespace {
+
+constexpr std::size_t kBlockSize = 64;
+
+alignas(16) constexpr std::uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+constexpr std::uint32_t kInitialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+using CompressFn = void (*)(std::uint32_t* state, const unsigned char* blocks, std::size_t count);
+
+inline std::uint32_t rotr(std::uint32_t value, int bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+inline std::uint32_t loadBigEndian(const unsigned char* src)
+{
+    return (static_cast<std::uint32_t>(src[0]) << 24) | (static_cast<std::uint32_t>(src[1]) << 16)
+           | (static_cast<std::uint32_t>(src[2]) << 8) | static_cast<std::uint32_t>(src[3]);
+}
+
+inline void storeBigEndian(std::uint32_t value, unsigned char* dst)
+{
+    dst[0] = static_cast<unsigned char>(value >> 24);
+    dst[1] = static_cast<unsigned char>(value >> 16);
+    dst[2] = static_cast<unsigned char>(value >> 8);
+    dst[3] = static_cast<unsigned char>(value);
+}
+
+void storeState(const std::uint32_t* state, unsigned char* digest)
+{
+    for (int i = 0; i < 8; ++i) {
+        storeBigEndian(state[i], digest + 4 * i);
+    }
+}
+
+void compressScalar(std::uint32_t* state, const unsigned char* blocks, std::size_t count)
+{
+    std::uint32_t w[64];
+    for (; count > 0; --count, blocks += kBlockSize) {
+        for (int t = 0; t < 16; ++t) {
+            w[t] = loadBigEndian(blocks + 4 * t);
+        }
+        for (int t = 16; t < 64; ++t) {
+            const std::uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+            const std::uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+            w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+        }
+
+        std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int t = 0; t < 64; ++t) {
+            const std::uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g))
+                                     + kRoundConstants[t] + w[t];
+            const std::uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(KALANET_X86_KERNELS)
+
+// Intel SHA extensions keep the state as ABEF/CDGH register pairs and retire
+// two rounds per sha256rnds2; the message schedule is four words per step.
+__attribute__((target("sha,sse4.1")))
+void compressShaNi(std::uint32_t* state, const unsigned char* blocks, std::size_t count)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    for (; count > 0; --count, blocks += kBlockSize) {
+        const __m128i savedAbef = state0;
+        const __m128i savedCdgh = state1;
+        __m128i w[4];
+
+        for (int step = 0; step < 16; ++step) {
+            __m128i& current = w[step & 3];
+            if (step < 4) {
+                current = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * step)), byteSwap);
+            } else {
+                const __m128i& previous = w[(step + 3) & 3];
+                __m128i next = _mm_sha256msg1_epu32(current, w[(step + 1) & 3]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(previous, w[(step + 2) & 3], 4));
+                current = _mm_sha256msg2_epu32(next, previous);
+            }
+
+            __m128i message = _mm_add_epi32(
+                current, _mm_load_si128(reinterpret_cast<const __m128i*>(kRoundConstants + 4 * step)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+            message = _mm_shuffle_epi32(message, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+        }
+
+        state0 = _mm_add_epi32(state0, savedAbef);
+        state1 = _mm_add_epi32(state1, savedCdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+
+#endif
+
+enum class Sha256Kernel {
+    Scalar,
+    ShaNi
+};
+
+Sha256Kernel selectKernel()
+{
+#if defined(KALANET_X86_KERNELS)
+    if (cpuFeatures().shaNi) {
+        return Sha256Kernel::ShaNi;
+    }
+#endif
+    return Sha256Kernel::Scalar;
+}
+
+Sha256Kernel activeKernel()
+{
+    static const Sha256Kernel kernel = selectKernel();
+    return kernel;
+}
+
+CompressFn compressFunction()
+{
+#if defined(KALANET_X86_KERNELS)
+    if (activeKernel() == Sha256Kernel::ShaNi) {
+        return compressShaNi;
+    }
+#endif
+    return compressScalar;
+}
+
+// Streaming hasher for the non-iterated parts (key hashing, the first PBKDF2
+// round over the salt). Fixed-size, so it never touches the heap.
+struct Sha256Context {
+    explicit Sha256Context(CompressFn fn)
+        : compress(fn)
+    {
+        std::memcpy(state, kInitialState, sizeof(state));
+    }
+
+    Sha256Context(CompressFn fn, const std::uint32_t* midState, std::uint64_t absorbed)
+        : compress(fn),
+          totalBytes(absorbed)
+    {
+        std::memcpy(state, midState, sizeof(state));
+    }
+
+    void update(const unsigned char* data, std::size_t size)
+    {
+        totalBytes += size;
+        if (buffered > 0) {
+            const std::size_t take = std::min(size, kBlockSize - buffered);
+            std::memcpy(buffer + buffered, data, take);
+            buffered += take;
+            data += take;
+            size -= take;
+            if (buffered < kBlockSize) {
+                return;
+            }
+            compress(state, buffer, 1);
+            buffered = 0;
+        }
+
+        const std::size_t blocks = size / kBlockSize;
+        if (blocks > 0) {
+            compress(state, data, blocks);
+            data += blocks * kBlockSize;
+            size -= blocks * kBlockSize;
+        }
+
+        std::memcpy(buffer, data, size);
+        buffered = size;
+    }
+
+    void finish(unsigned char* digest)
+    {
+        const std::uint64_t bitLength = totalBytes * 8;
+        buffer[buffered++] = 0x80;
+        if (buffered > kBlockSize - 8) {
+            std::memset(buffer + buffered, 0, kBlockSize - buffered);
+            compress(state, buffer, 1);
+            buffered = 0;
+        }
+        std::memset(buffer + buffered, 0, kBlockSize - 8 - buffered);
+        storeBigEndian(static_cast<std::uint32_t>(bitLength >> 32), buffer + kBlockSize - 8);
+        storeBigEndian(static_cast<std::uint32_t>(bitLength), buffer + kBlockSize - 4);
+        compress(state, buffer, 1);
+        storeState(state, digest);
+    }
+
+    CompressFn compress;
+    std::uint32_t state[8];
+    unsigned char buffer[kBlockSize];
+    std::size_t buffered = 0;
+    std::uint64_t totalBytes = 0;
+};
+
+// Pads a block that holds a single 32-byte digest following 64 bytes of
+// HMAC key material, so the hot loop only rewrites the first half.
+void prepareDigestBlock(unsigned char* block)
+{
+    constexpr std::uint64_t bitLength = (kBlockSize + kSha256DigestSize) * 8;
+    std::memset(block, 0, kBlockSize);
+    block[kSha256DigestSize] = 0x80;
+    storeBigEndian(static_cast<std::uint32_t>(bitLength), block + kBlockSize - 4);
+}
+
+void secureZero(void* data, std::size_t size)
+{
+    volatile unsigned char* bytes = static_cast<volatile unsigned char*>(data);
+    while (size-- > 0) {
+        *bytes++ = 0;
+    }
+}
+
+}
+
+void sha256(const unsigned char* data, std::size_t size, unsigned char* digest)
+{
+    Sha256Context context(compressFunction());
+    context.update(data, size);
+    context.finish(digest);
+}
+
+void pbkdf2HmacSha256(const unsigned char* password,
+                      std::size_t passwordSize,
+                      const unsigned char* salt,
+                      std::size_t saltSize,
+                      unsigned int iterations,
+                      unsigned char* out,
+                      std::size_t outSize)
+{
+    const CompressFn compress = compressFunction();
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    unsigned char key[kBlockSize] = {};
+    if (passwordSize > kBlockSize) {
+        sha256(password, passwordSize, key);
+    } else if (passwordSize > 0) {
+        std::memcpy(key, password, passwordSize);
+    }
+
+    // The HMAC pads are absorbed once; every iteration resumes from these states.
+    unsigned char pad[kBlockSize];
+    std::uint32_t innerState[8];
+    std::uint32_t outerState[8];
+    for (std::size_t i = 0; i < kBlockSize; ++i) {
+        pad[i] = key[i] ^ 0x36;
+    }
+    std::memcpy(innerState, kInitialState, sizeof(innerState));
+    compress(innerState, pad, 1);
+    for (std::size_t i = 0; i < kBlockSize; ++i) {
+        pad[i] = key[i] ^ 0x5c;
+    }
+    std::memcpy(outerState, kInitialState, sizeof(outerState));
+    compress(outerState, pad, 1);
+
+    unsigned char innerBlock[kBlockSize];
+    unsigned char outerBlock[kBlockSize];
+    prepareDigestBlock(innerBlock);
+    prepareDigestBlock(outerBlock);
+
+    std::uint32_t blockIndex = 1;
+    while (outSize > 0) {
+        unsigned char counter[4];
+        storeBigEndian(blockIndex, counter);
+
+        Sha256Context first(compress, innerState, kBlockSize);
+        first.update(salt, saltSize);
+        first.update(counter, sizeof(counter));
+        first.finish(outerBlock);
+
+        Sha256Context firstOuter(compress, outerState, kBlockSize);
+        firstOuter.update(outerBlock, kSha256DigestSize);
+        firstOuter.finish(innerBlock);
+
+        unsigned char accumulated[kSha256DigestSize];
+        std::memcpy(accumulated, innerBlock, kSha256DigestSize);
+
+        std::uint32_t state[8];
+        for (unsigned int round = 1; round < iterations; ++round) {
+            std::memcpy(state, innerState, sizeof(state));
+            compress(state, innerBlock, 1);
+            storeState(state, outerBlock);
+
+            std::memcpy(state, outerState, sizeof(state));
+            compress(state, outerBlock, 1);
+            storeState(state, innerBlock);
+
+            for (std::size_t i = 0; i < kSha256DigestSize; ++i) {
+                accumulated[i] ^= innerBlock[i];
+            }
+        }
+
+        const std::size_t take = std::min(outSize, kSha256DigestSize);
+        std::memcpy(out, accumulated, take);
+        out += take;
+        outSize -= take;
+        ++blockIndex;
+        secureZero(accumulated, sizeof(accumulated));
+    }
+
+    secureZero(key, sizeof(key));
+    secureZero(pad, sizeof(pad));
+}
+
+const char* sha256KernelName()
+{
+    switch (activeKernel()) {
+    case Sha256Kernel::ShaNi:
+        return "sha-ni";
+    case Sha256Kernel::Scalar:
+    default:
+        return "scalar";
+    }
+}
+
+}
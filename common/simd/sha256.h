@@ -0,0 +1,26 @@
+#ifndef COMMON_SIMD_SHA256_H
+#define COMMON_SIMD_SHA256_H
+
+#include <cstddef>
+
+namespace common::simd {
+
+constexpr std::size_t kSha256DigestSize = 32;
+
+void sha256(const unsigned char* data, std::size_t size, unsigned char* digest);
+
+// PBKDF2-HMAC-SHA256 as defined in RFC 8018. Works entirely on stack buffers;
+// each iteration costs exactly two compression-function calls.
+void pbkdf2HmacSha256(const unsigned char* password,
+                      std::size_t passwordSize,
+                      const unsigned char* salt,
+                      std::size_t saltSize,
+                      unsigned int iterations,
+                      unsigned char* out,
+                      std::size_t outSize);
+
+const char* sha256KernelName();
+
+}
+
+#endif // COMMON_SIMD_SHA256_H
@@ -1,15 +1,35 @@
 #include "ad_service.h"
+#include "catalog_index.h"
+#include "catalog_version.h"
+#include "thumbnail_pipeline.h"
 
 #include "protocol/ad_create_message.h"
+#include "protocol/base64_codec.h"
 #include "../repository/ad_repository.h"
 #include "../logging_audit_logger.h"
 
+#include <algorithm>
 #include <exception>
+#include <iterator>
+#include <optional>
 
 #include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
 
 namespace {
 
+constexpr int kDefaultAdListPageSize = 50;
+constexpr int kMaxAdListPageSize = 200;
+constexpr int kMaxThumbnailBatchSize = 100;
+constexpr int kMaxDetailBatchSize = 50;
+// Raw image bytes per AdDetailBatch response. Base64 adds a third, which keeps
+// a full batch well inside the 16 MiB frame limit; one image of the largest
+// accepted size still fits on its own.
+constexpr qint64 kMaxDetailBatchImageBytes = 8 * 1024 * 1024;
+constexpr int kMaxPriceBuckets = 20;
+constexpr int kDefaultPriceBucketBounds[] = {100, 500, 1000, 5000};
+
 bool isInvalidText(const QString& value, int minLength)
 {
     return value.trimmed().size() < minLength;
@@ -25,6 +45,9 @@ AdRepository::AdListSortField parseSortField(const QString& value)
     if (normalized == QStringLiteral("price") || normalized == QStringLiteral("pricetokens")) {
         return AdRepository::AdListSortField::PriceTokens;
     }
+    if (normalized == QStringLiteral("relevance")) {
+        return AdRepository::AdListSortField::Relevance;
+    }
     return AdRepository::AdListSortField::CreatedAt;
 }
 
@@ -52,22 +75,214 @@ AdRepository::AdModerationStatus parseModerationStatus(const QString& value)
     return AdRepository::AdModerationStatus::Unknown;
 }
 
+QJsonValue sortKeyForRecord(const AdRepository::AdSummaryRecord& ad,
+                             AdRepository::AdListSortField field)
+{
+    switch (field) {
+    case AdRepository::AdListSortField::Title:
+        return ad.title;
+    case AdRepository::AdListSortField::PriceTokens:
+        return ad.priceTokens;
+    case AdRepository::AdListSortField::Relevance:
+        return ad.relevance;
+    case AdRepository::AdListSortField::CreatedAt:
+    default:
+        return ad.createdAt;
+    }
+}
+
+// Cursors are opaque to clients: base64url JSON holding the sort the page was
+// produced with and the (sort key, id) of its last row. bm25 scores move
+// whenever an ad is added, so relevance cursors also carry the catalog
+// version and stop being accepted once it changes.
+QString encodeAdListCursor(const AdRepository::AdListFilters& filters,
+                           const AdRepository::AdSummaryRecord& last,
+                           const QString& catalogVersion)
+{
+    QJsonObject cursor{{QStringLiteral("f"), static_cast<int>(filters.sortField)},
+                       {QStringLiteral("o"), static_cast<int>(filters.sortOrder)},
+                       {QStringLiteral("k"), sortKeyForRecord(last, filters.sortField)},
+                       {QStringLiteral("i"), last.id}};
+    if (filters.sortField == AdRepository::AdListSortField::Relevance) {
+        cursor.insert(QStringLiteral("v"), catalogVersion);
+    }
+    return QString::fromLatin1(QJsonDocument(cursor).toJson(QJsonDocument::Compact)
+                                   .toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+
+std::optional<AdRepository::AdListCursor> decodeAdListCursor(const QString& token,
+                                                             const AdRepository::AdListFilters& filters,
+                                                             const QString& catalogVersion)
+{
+    const auto decoded = QByteArray::fromBase64Encoding(
+        token.toLatin1(),
+        QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals | QByteArray::AbortOnBase64DecodingErrors);
+    if (!decoded) {
+        return std::nullopt;
+    }
+
+    const QJsonObject cursor = QJsonDocument::fromJson(*decoded).object();
+    if (cursor.value(QStringLiteral("f")).toInt(-1) != static_cast<int>(filters.sortField)
+        || cursor.value(QStringLiteral("o")).toInt(-1) != static_cast<int>(filters.sortOrder)) {
+        return std::nullopt;
+    }
+
+    const QJsonValue key = cursor.value(QStringLiteral("k"));
+    const int id = cursor.value(QStringLiteral("i")).toInt(-1);
+    if (id <= 0) {
+        return std::nullopt;
+    }
+
+    AdRepository::AdListCursor result;
+    result.id = id;
+    if (filters.sortField == AdRepository::AdListSortField::PriceTokens) {
+        if (!key.isDouble()) {
+            return std::nullopt;
+        }
+        result.sortKey = key.toInt();
+    } else if (filters.sortField == AdRepository::AdListSortField::Relevance) {
+        if (!key.isDouble() || cursor.value(QStringLiteral("v")).toString() != catalogVersion) {
+            return std::nullopt;
+        }
+        result.sortKey = key.toDouble();
+    } else {
+        if (!key.isString()) {
+            return std::nullopt;
+        }
+        result.sortKey = key.toString();
+    }
+    return result;
+}
+
+// Distinct ids in request order; empty when the list is empty, too long, or
+// holds anything but positive integers.
+QVector<int> parseAdIds(const QJsonObject& payload, int maxCount)
+{
+    const QJsonArray requestedIds = payload.value(QStringLiteral("adIds")).toArray();
+    if (requestedIds.isEmpty() || requestedIds.size() > maxCount) {
+        return {};
+    }
+
+    QVector<int> adIds;
+    adIds.reserve(requestedIds.size());
+    for (const QJsonValue& value : requestedIds) {
+        const int adId = value.toInt(-1);
+        if (adId <= 0) {
+            return {};
+        }
+        if (!adIds.contains(adId)) {
+            adIds.append(adId);
+        }
+    }
+    return adIds;
 }
 
-AdService::AdService(AdRepository& adRepository)
-    : adRepository_(adRepository)
+QJsonObject adDetailJson(const AdRepository::AdDetailRecord& ad)
+{
+    QJsonObject item;
+    item.insert(QStringLiteral("id"), ad.id);
+    item.insert(QStringLiteral("title"), ad.title);
+    item.insert(QStringLiteral("description"), ad.description);
+    item.insert(QStringLiteral("category"), ad.category);
+    item.insert(QStringLiteral("priceTokens"), ad.priceTokens);
+    item.insert(QStringLiteral("sellerUsername"), ad.sellerUsername);
+    item.insert(QStringLiteral("status"), ad.status);
+    item.insert(QStringLiteral("createdAt"), ad.createdAt);
+    item.insert(QStringLiteral("updatedAt"), ad.updatedAt);
+    return item;
+}
+
+// Ascending upper bounds from "priceBuckets", or the defaults when absent;
+// nullopt when the list is not strictly ascending positive integers.
+std::optional<QVector<int>> parsePriceBounds(const QJsonObject& payload)
+{
+    const QJsonValue value = payload.value(QStringLiteral("priceBuckets"));
+    if (value.isUndefined() || value.isNull()) {
+        return QVector<int>(std::begin(kDefaultPriceBucketBounds), std::end(kDefaultPriceBucketBounds));
+    }
+
+    if (!value.isArray() || value.toArray().size() > kMaxPriceBuckets) {
+        return std::nullopt;
+    }
+
+    const QJsonArray requested = value.toArray();
+
+    QVector<int> bounds;
+    bounds.reserve(requested.size());
+    for (const QJsonValue& bound : requested) {
+        const int price = bound.toInt(-1);
+        if (price <= 0 || (!bounds.isEmpty() && price <= bounds.constLast())) {
+            return std::nullopt;
+        }
+        bounds.append(price);
+    }
+    return bounds;
+}
+
+// Buckets carry inclusive minPriceTokens/maxPriceTokens, with 0 for an open
+// end, so a client can send one back as its price filter unchanged.
+QJsonObject facetsJson(AdRepository::AdListFacets facets)
+{
+    std::sort(facets.categories.begin(), facets.categories.end(),
+              [](const AdRepository::AdListFacets::CategoryCount& a,
+                 const AdRepository::AdListFacets::CategoryCount& b) {
+                  if (a.count != b.count) {
+                      return a.count > b.count;
+                  }
+                  return a.name.compare(b.name, Qt::CaseInsensitive) < 0;
+              });
+
+    QJsonArray categoriesJson;
+    for (const auto& category : std::as_const(facets.categories)) {
+        categoriesJson.push_back(QJsonObject{{QStringLiteral("name"), category.name},
+                                             {QStringLiteral("count"), category.count}});
+    }
+
+    QJsonArray bucketsJson;
+    for (int i = 0; i < facets.priceBucketCounts.size(); ++i) {
+        const int minPrice = i == 0 ? 0 : facets.priceBounds.at(i - 1);
+        const int maxPrice = i < facets.priceBounds.size() ? facets.priceBounds.at(i) - 1 : 0;
+        bucketsJson.push_back(QJsonObject{{QStringLiteral("minPriceTokens"), minPrice},
+                                          {QStringLiteral("maxPriceTokens"), maxPrice},
+                                          {QStringLiteral("count"), facets.priceBucketCounts.at(i)}});
+    }
+
+    return QJsonObject{{QStringLiteral("categories"), categoriesJson},
+                       {QStringLiteral("priceBuckets"), bucketsJson}};
+}
+
+QJsonObject notModifiedPayload(const QString& catalogVersion)
+{
+    return QJsonObject{{QStringLiteral("notModified"), true},
+                       {QStringLiteral("catalogVersion"), catalogVersion}};
+}
+
+}
+
+AdService::AdService(AdRepository& adRepository,
+                     CatalogVersion* catalogVersion,
+                     const CatalogIndex* catalogIndex,
+                     ThumbnailPipeline* thumbnailPipeline)
+    : adRepository_(adRepository),
+      catalogVersion_(catalogVersion),
+      catalogIndex_(catalogIndex),
+      thumbnailPipeline_(thumbnailPipeline)
 {
 }
 
 common::Message AdService::create(const QJsonObject& payload)
+{
+    return create(payload,
+                  common::Base64Codec::decode(payload.value(QStringLiteral("imageBase64")).toString()));
+}
+
+common::Message AdService::create(const QJsonObject& payload, const QByteArray& imageBytes)
 {
     const QString title = payload.value(QStringLiteral("title")).toString().trimmed();
     const QString description = payload.value(QStringLiteral("description")).toString().trimmed();
     const QString category = payload.value(QStringLiteral("category")).toString().trimmed();
     const int priceTokens = payload.value(QStringLiteral("priceTokens")).toInt(0);
     const QString sellerUsername = payload.value(QStringLiteral("sellerUsername")).toString().trimmed();
-    const QByteArray imageBytes =
-        QByteArray::fromBase64(payload.value(QStringLiteral("imageBase64")).toString().toLatin1());
 
     if (isInvalidText(title, 3)) {
         return common::AdCreateMessage::createFailureResponse(
@@ -109,6 +324,9 @@ common::Message AdService::create(const QJsonObject& payload)
         }
 
         const int adId = adRepository_.createPendingAd(ad);
+        if (thumbnailPipeline_) {
+            thumbnailPipeline_->enqueue(imageBytes);
+        }
         return common::AdCreateMessage::createSuccessResponse(adId);
     } catch (const std::exception& ex) {
         return common::AdCreateMessage::createFailureResponse(
@@ -140,15 +358,74 @@ common::Message AdService::list(const QJsonObject& payload)
             QStringLiteral("Minimum price cannot be greater than maximum price"));
     }
 
-    try {
-        AdRepository::AdListFilters filters;
-        filters.nameContains = name;
-        filters.category = category;
-        filters.minPriceTokens = minPriceTokens;
-        filters.maxPriceTokens = maxPriceTokens;
-        filters.sortField = parseSortField(payload.value(QStringLiteral("sortBy")).toString());
-        filters.sortOrder = parseSortOrder(payload.value(QStringLiteral("sortOrder")).toString());
+    const int requestedLimit = payload.value(QStringLiteral("limit")).toInt(0);
+    if (requestedLimit < 0) {
+        return common::Message::makeFailure(
+            common::Command::AdListResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Page limit must be zero or positive"));
+    }
+    const int pageSize = requestedLimit == 0 ? kDefaultAdListPageSize
+                                             : qMin(requestedLimit, kMaxAdListPageSize);
+
+    AdRepository::AdListFilters filters;
+    filters.nameContains = name;
+    filters.category = category;
+    filters.minPriceTokens = minPriceTokens;
+    filters.maxPriceTokens = maxPriceTokens;
+    filters.sortField = parseSortField(payload.value(QStringLiteral("sortBy")).toString());
+    filters.sortOrder = parseSortOrder(payload.value(QStringLiteral("sortOrder")).toString());
+    const QString textQuery = allowAdminView ? payload.value(QStringLiteral("query")).toString().trimmed()
+                                             : QString();
+    if (filters.sortField == AdRepository::AdListSortField::Relevance
+        && name.isEmpty() && textQuery.isEmpty()) {
+        filters.sortField = AdRepository::AdListSortField::CreatedAt;
+    }
+    // One extra row tells us whether another page exists without a COUNT.
+    filters.limit = pageSize + 1;
+
+    // Facets describe the shopper's listing; the admin view filters on more
+    // than they count, so it never gets them.
+    const bool includeFacets = !allowAdminView && payload.value(QStringLiteral("facets")).toBool(false);
+    AdRepository::AdListFacets facets;
+    if (includeFacets) {
+        const auto priceBounds = parsePriceBounds(payload);
+        if (!priceBounds.has_value()) {
+            return common::Message::makeFailure(
+                common::Command::AdListResult,
+                common::ErrorCode::ValidationFailed,
+                QStringLiteral("Price buckets must be at most %1 ascending positive prices").arg(kMaxPriceBuckets));
+        }
+        facets.priceBounds = *priceBounds;
+    }
+
+    // Read before the query: a bump in between makes the next cursor stale,
+    // never a stale cursor look current.
+    const QString catalogVersion = catalogVersion_ ? catalogVersion_->token() : QString();
 
+    const QString afterToken = payload.value(QStringLiteral("after")).toString().trimmed();
+    if (!afterToken.isEmpty()) {
+        filters.after = decodeAdListCursor(afterToken, filters, catalogVersion);
+        if (!filters.after.has_value()) {
+            return common::Message::makeFailure(
+                common::Command::AdListResult,
+                common::ErrorCode::ValidationFailed,
+                QStringLiteral("Cursor is invalid, out of date, or does not match the requested sort"));
+        }
+    }
+
+    if (!catalogVersion.isEmpty()
+        && afterToken.isEmpty()
+        && payload.value(QStringLiteral("ifVersion")).toString().trimmed() == catalogVersion) {
+        return common::Message::makeSuccess(
+            common::Command::AdListResult,
+            notModifiedPayload(catalogVersion),
+            {},
+            {},
+            QStringLiteral("Advertisements not modified"));
+    }
+
+    try {
         QVector<AdRepository::AdSummaryRecord> ads;
         if (allowAdminView) {
             ads = adRepository_.listAdsForModeration(
@@ -156,9 +433,20 @@ common::Message AdService::list(const QJsonObject& payload)
                 payload.value(QStringLiteral("status")).toString().trimmed(),
                 payload.value(QStringLiteral("onlyWithImage")).toBool(false),
                 payload.value(QStringLiteral("seller")).toString().trimmed(),
-                payload.value(QStringLiteral("query")).toString().trimmed());
+                textQuery);
+        } else if (const auto indexed = catalogIndex_ ? catalogIndex_->list(filters, includeFacets ? &facets : nullptr)
+                                                      : std::nullopt) {
+            ads = *indexed;
         } else {
             ads = adRepository_.listApprovedAds(filters);
+            if (includeFacets) {
+                adRepository_.countApprovedFacets(filters, facets);
+            }
+        }
+
+        const bool hasMore = ads.size() > pageSize;
+        if (hasMore) {
+            ads.resize(pageSize);
         }
 
         QJsonArray adsJson;
@@ -179,6 +467,15 @@ common::Message AdService::list(const QJsonObject& payload)
         QJsonObject responsePayload;
         responsePayload.insert(QStringLiteral("ads"), adsJson);
         responsePayload.insert(QStringLiteral("count"), adsJson.size());
+        responsePayload.insert(QStringLiteral("after"), afterToken);
+        responsePayload.insert(QStringLiteral("nextCursor"),
+                               hasMore ? encodeAdListCursor(filters, ads.constLast(), catalogVersion) : QString());
+        if (includeFacets) {
+            responsePayload.insert(QStringLiteral("facets"), facetsJson(std::move(facets)));
+        }
+        if (!catalogVersion.isEmpty()) {
+            responsePayload.insert(QStringLiteral("catalogVersion"), catalogVersion);
+        }
 
         return common::Message::makeSuccess(
             common::Command::AdListResult,
@@ -308,6 +605,19 @@ common::Message AdService::detail(const QJsonObject& payload)
     const bool includeUnapproved = payload.value(QStringLiteral("includeUnapproved")).toBool(false);
     const bool includeHistory = payload.value(QStringLiteral("includeHistory")).toBool(includeUnapproved);
 
+    const QString catalogVersion = catalogVersion_ ? catalogVersion_->token() : QString();
+    if (!catalogVersion.isEmpty()
+        && payload.value(QStringLiteral("ifVersion")).toString().trimmed() == catalogVersion) {
+        QJsonObject responsePayload = notModifiedPayload(catalogVersion);
+        responsePayload.insert(QStringLiteral("id"), adId);
+        return common::Message::makeSuccess(
+            common::Command::AdDetailResult,
+            responsePayload,
+            {},
+            {},
+            QStringLiteral("Advertisement not modified"));
+    }
+
     try {
         const std::optional<AdRepository::AdDetailRecord> ad = includeUnapproved
             ? adRepository_.findAdById(adId)
@@ -320,17 +630,13 @@ common::Message AdService::detail(const QJsonObject& payload)
                 QStringLiteral("Advertisement not found"));
         }
 
-        QJsonObject responsePayload;
-        responsePayload.insert(QStringLiteral("id"), ad->id);
-        responsePayload.insert(QStringLiteral("title"), ad->title);
-        responsePayload.insert(QStringLiteral("description"), ad->description);
-        responsePayload.insert(QStringLiteral("category"), ad->category);
-        responsePayload.insert(QStringLiteral("priceTokens"), ad->priceTokens);
-        responsePayload.insert(QStringLiteral("sellerUsername"), ad->sellerUsername);
-        responsePayload.insert(QStringLiteral("status"), ad->status);
-        responsePayload.insert(QStringLiteral("createdAt"), ad->createdAt);
-        responsePayload.insert(QStringLiteral("updatedAt"), ad->updatedAt);
-        responsePayload.insert(QStringLiteral("imageBase64"), QString::fromLatin1(ad->imageBytes.toBase64()));
+        QJsonObject responsePayload = adDetailJson(*ad);
+        const auto image = adRepository_.openImage(ad->imageSha256);
+        responsePayload.insert(QStringLiteral("imageBase64"),
+                               image ? common::Base64Codec::encodeToString(image->bytes()) : QString());
+        if (!catalogVersion.isEmpty()) {
+            responsePayload.insert(QStringLiteral("catalogVersion"), catalogVersion);
+        }
 
         if (includeHistory) {
             QJsonArray history;
@@ -358,3 +664,180 @@ common::Message AdService::detail(const QJsonObject& payload)
                 .arg(QString::fromUtf8(ex.what())));
     }
 }
+
+// One lookup for every requested ad. Ids that are missing or not visible to
+// the caller are listed under missingIds instead of failing the batch; ads
+// whose image would push the response past the byte budget are listed under
+// deferredIds for the client to ask for again.
+common::Message AdService::detailBatch(const QJsonObject& payload)
+{
+    const QVector<int> adIds = parseAdIds(payload, kMaxDetailBatchSize);
+    if (adIds.isEmpty()) {
+        return common::Message::makeFailure(
+            common::Command::AdDetailBatchResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Between 1 and %1 positive adIds are required").arg(kMaxDetailBatchSize));
+    }
+
+    const bool includeUnapproved = payload.value(QStringLiteral("includeUnapproved")).toBool(false);
+    const bool includeImage = payload.value(QStringLiteral("includeImage")).toBool(true);
+
+    try {
+        const QVector<AdRepository::AdDetailRecord> ads =
+            adRepository_.findAdsByIds(adIds, AdRepository::AdFieldSet::Detail, !includeUnapproved);
+
+        QSet<int> foundIds;
+        QJsonArray adsJson;
+        QJsonArray deferredIds;
+        qint64 imageBytes = 0;
+        for (const auto& ad : ads) {
+            foundIds.insert(ad.id);
+            QJsonObject item = adDetailJson(ad);
+            if (includeImage) {
+                const auto image = adRepository_.openImage(ad.imageSha256);
+                const qint64 size = image ? image->size() : 0;
+                if (imageBytes > 0 && imageBytes + size > kMaxDetailBatchImageBytes) {
+                    deferredIds.append(ad.id);
+                    continue;
+                }
+                imageBytes += size;
+                item.insert(QStringLiteral("imageBase64"),
+                            image ? common::Base64Codec::encodeToString(image->bytes()) : QString());
+            }
+            adsJson.push_back(item);
+        }
+
+        QJsonArray missingIds;
+        for (const int adId : adIds) {
+            if (!foundIds.contains(adId)) {
+                missingIds.append(adId);
+            }
+        }
+
+        QJsonObject responsePayload;
+        responsePayload.insert(QStringLiteral("ads"), adsJson);
+        responsePayload.insert(QStringLiteral("count"), adsJson.size());
+        responsePayload.insert(QStringLiteral("missingIds"), missingIds);
+        responsePayload.insert(QStringLiteral("deferredIds"), deferredIds);
+        if (catalogVersion_) {
+            responsePayload.insert(QStringLiteral("catalogVersion"), catalogVersion_->token());
+        }
+
+        return common::Message::makeSuccess(
+            common::Command::AdDetailBatchResult,
+            responsePayload,
+            {},
+            {},
+            QStringLiteral("Advertisement details loaded"));
+    } catch (const std::exception& ex) {
+        return common::Message::makeFailure(
+            common::Command::AdDetailBatchResult,
+            common::ErrorCode::InternalError,
+            QStringLiteral("Failed to load advertisement details: %1")
+                .arg(QString::fromUtf8(ex.what())));
+    }
+}
+
+// Thumbnails not generated yet come back as pending; the client asks again
+// for those. Every requested id gets exactly one entry.
+common::Message AdService::thumbnails(const QJsonObject& payload)
+{
+    const QVector<int> adIds = parseAdIds(payload, kMaxThumbnailBatchSize);
+    if (adIds.isEmpty()) {
+        return common::Message::makeFailure(
+            common::Command::AdThumbnailBatchResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Between 1 and %1 positive adIds are required").arg(kMaxThumbnailBatchSize));
+    }
+
+    const bool includeUnapproved = payload.value(QStringLiteral("includeUnapproved")).toBool(false);
+
+    try {
+        QHash<int, QString> imageHashes;
+        const QVector<AdRepository::AdDetailRecord> ads =
+            adRepository_.findAdsByIds(adIds, AdRepository::AdFieldSet::Summary, !includeUnapproved);
+        for (const auto& ad : ads) {
+            imageHashes.insert(ad.id, ad.imageSha256);
+        }
+
+        QJsonArray thumbnailsJson;
+        int pendingCount = 0;
+        for (const int adId : std::as_const(adIds)) {
+            const QString sha256 = imageHashes.value(adId);
+            QJsonObject item;
+            item.insert(QStringLiteral("id"), adId);
+
+            const auto thumbnail = adRepository_.openThumbnail(sha256);
+            const bool pending = !thumbnail && thumbnailPipeline_ && thumbnailPipeline_->request(sha256);
+            item.insert(QStringLiteral("thumbnailBase64"),
+                        thumbnail ? common::Base64Codec::encodeToString(thumbnail->bytes()) : QString());
+            item.insert(QStringLiteral("pending"), pending);
+            if (pending) {
+                ++pendingCount;
+            }
+            thumbnailsJson.push_back(item);
+        }
+
+        QJsonObject responsePayload;
+        responsePayload.insert(QStringLiteral("thumbnails"), thumbnailsJson);
+        responsePayload.insert(QStringLiteral("count"), thumbnailsJson.size());
+        responsePayload.insert(QStringLiteral("pendingCount"), pendingCount);
+
+        return common::Message::makeSuccess(
+            common::Command::AdThumbnailBatchResult,
+            responsePayload,
+            {},
+            {},
+            QStringLiteral("Thumbnails loaded"));
+    } catch (const std::exception& ex) {
+        return common::Message::makeFailure(
+            common::Command::AdThumbnailBatchResult,
+            common::ErrorCode::InternalError,
+            QStringLiteral("Failed to load thumbnails: %1")
+                .arg(QString::fromUtf8(ex.what())));
+    }
+}
+
+common::Message AdService::listCategories(const QJsonObject& payload)
+{
+    const bool includeUnapproved = payload.value(QStringLiteral("includeUnapproved")).toBool(false);
+
+    try {
+        QJsonArray categoriesJson;
+        const QVector<AdRepository::CategoryRecord> categories = adRepository_.listCategories();
+        for (const auto& category : categories) {
+            if (category.approvedCount <= 0 && (!includeUnapproved || category.adCount <= 0)) {
+                continue;
+            }
+
+            QJsonObject item;
+            item.insert(QStringLiteral("id"), category.id);
+            item.insert(QStringLiteral("name"), category.name);
+            item.insert(QStringLiteral("approvedCount"), category.approvedCount);
+            if (includeUnapproved) {
+                item.insert(QStringLiteral("adCount"), category.adCount);
+            }
+            categoriesJson.push_back(item);
+        }
+
+        QJsonObject responsePayload;
+        responsePayload.insert(QStringLiteral("categories"), categoriesJson);
+        responsePayload.insert(QStringLiteral("count"), categoriesJson.size());
+        if (catalogVersion_) {
+            responsePayload.insert(QStringLiteral("catalogVersion"), catalogVersion_->token());
+        }
+
+        return common::Message::makeSuccess(
+            common::Command::CategoryListResult,
+            responsePayload,
+            {},
+            {},
+            QStringLiteral("Categories loaded"));
+    } catch (const std::exception& ex) {
+        return common::Message::makeFailure(
+            common::Command::CategoryListResult,
+            common::ErrorCode::InternalError,
+            QStringLiteral("Failed to load categories: %1")
+                .arg(QString::fromUtf8(ex.what())));
+    }
+}
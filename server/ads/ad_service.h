@@ -1,24 +1,38 @@
 #ifndef KALANET_AD_SERVICE_H
 #define KALANET_AD_SERVICE_H
 
+#include <QByteArray>
 #include <QJsonObject>
 
 #include "protocol/message.h"
 
 class AdRepository;
+class CatalogIndex;
+class CatalogVersion;
+class ThumbnailPipeline;
 
 class AdService
 {
 public:
-    explicit AdService(AdRepository& adRepository);
+    explicit AdService(AdRepository& adRepository,
+                       CatalogVersion* catalogVersion = nullptr,
+                       const CatalogIndex* catalogIndex = nullptr,
+                       ThumbnailPipeline* thumbnailPipeline = nullptr);
 
     common::Message create(const QJsonObject& payload);
+    common::Message create(const QJsonObject& payload, const QByteArray& imageBytes);
     common::Message list(const QJsonObject& payload);
     common::Message detail(const QJsonObject& payload);
+    common::Message detailBatch(const QJsonObject& payload);
+    common::Message thumbnails(const QJsonObject& payload);
     common::Message updateStatus(const QJsonObject& payload);
+    common::Message listCategories(const QJsonObject& payload);
 
 private:
     AdRepository& adRepository_;
+    CatalogVersion* catalogVersion_ = nullptr;
+    const CatalogIndex* catalogIndex_ = nullptr;
+    ThumbnailPipeline* thumbnailPipeline_ = nullptr;
 };
 
 #endif // KALANET_AD_SERVICE_H
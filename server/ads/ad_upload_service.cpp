@@ -0,0 +1,330 @@
+#include "ad_upload_service.h"
+
+#include "ad_service.h"
+#include "protocol/ad_create_message.h"
+#include "protocol/ad_upload_message.h"
+#include "protocol/base64_codec.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QUuid>
+
+namespace {
+constexpr int kUploadIdleTimeoutSecs = 30 * 60;
+constexpr int kMaxUploadsPerUser = 4;
+
+bool isSha256Hex(const QString& value)
+{
+    if (value.size() != 64) {
+        return false;
+    }
+    for (const QChar ch : value) {
+        if (!ch.isDigit() && !(ch.toLower() >= QLatin1Char('a') && ch.toLower() <= QLatin1Char('f'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+qint64 maxEncodedChunkLength()
+{
+    return ((common::AdUploadMessage::kChunkBytes + 2) / 3) * 4;
+}
+}
+
+AdUploadService::AdUploadService(AdService& adService)
+    : adService_(adService)
+{
+}
+
+AdUploadService::~AdUploadService()
+{
+    QMutexLocker locker(&mutex_);
+    for (const auto& session : uploads_) {
+        removeSpoolFile(session);
+    }
+    uploads_.clear();
+}
+
+common::Message AdUploadService::init(const QJsonObject& payload)
+{
+    const QString username = payload.value(QStringLiteral("username")).toString().trimmed();
+    const QString resumeId = payload.value(QStringLiteral("uploadId")).toString().trimmed();
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+
+    QMutexLocker locker(&mutex_);
+    cleanupExpiredLocked(now);
+
+    if (!resumeId.isEmpty()) {
+        auto it = uploads_.find(resumeId);
+        if (it == uploads_.end()) {
+            return common::AdUploadMessage::createFailureResponse(
+                common::Command::AdUploadInitResult,
+                common::ErrorCode::NotFound,
+                QStringLiteral("Upload session is missing or expired"),
+                resumeId);
+        }
+        if (it->ownerUsername != username) {
+            return common::AdUploadMessage::createFailureResponse(
+                common::Command::AdUploadInitResult,
+                common::ErrorCode::PermissionDenied,
+                QStringLiteral("Upload session belongs to another user"),
+                resumeId);
+        }
+
+        it->lastActivity = now;
+        return common::AdUploadMessage::createInitSuccessResponse(it->uploadId,
+                                                                 common::AdUploadMessage::kChunkBytes,
+                                                                 it->nextChunkIndex,
+                                                                 it->receivedBytes);
+    }
+
+    const qint64 imageSize = static_cast<qint64>(payload.value(QStringLiteral("imageSize")).toDouble(0));
+    const QString imageSha256 = payload.value(QStringLiteral("imageSha256")).toString().trimmed();
+
+    if (imageSize <= 0) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadInitResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Image size must be greater than zero"));
+    }
+
+    if (imageSize > common::AdUploadMessage::kMaxImageBytes) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadInitResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Image exceeds the %1 byte limit").arg(common::AdUploadMessage::kMaxImageBytes));
+    }
+
+    if (!isSha256Hex(imageSha256)) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadInitResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Image hash must be a SHA-256 hex digest"));
+    }
+
+    if (countUploadsForOwnerLocked(username) >= kMaxUploadsPerUser) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadInitResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Too many unfinished uploads"));
+    }
+
+    UploadSession session;
+    session.uploadId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    session.ownerUsername = username;
+    session.adPayload.insert(QStringLiteral("title"), payload.value(QStringLiteral("title")));
+    session.adPayload.insert(QStringLiteral("description"), payload.value(QStringLiteral("description")));
+    session.adPayload.insert(QStringLiteral("category"), payload.value(QStringLiteral("category")));
+    session.adPayload.insert(QStringLiteral("priceTokens"), payload.value(QStringLiteral("priceTokens")));
+    session.declaredSize = imageSize;
+    session.expectedSha256 = QByteArray::fromHex(imageSha256.toLatin1());
+    session.spoolPath = QDir(spoolDirectory()).filePath(session.uploadId + QStringLiteral(".part"));
+    session.lastActivity = now;
+
+    QFile spool(session.spoolPath);
+    if (!QDir().mkpath(spoolDirectory()) || !spool.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadInitResult,
+            common::ErrorCode::InternalError,
+            QStringLiteral("Failed to allocate upload storage"));
+    }
+    spool.close();
+
+    uploads_.insert(session.uploadId, session);
+    return common::AdUploadMessage::createInitSuccessResponse(session.uploadId,
+                                                             common::AdUploadMessage::kChunkBytes,
+                                                             0,
+                                                             0);
+}
+
+common::Message AdUploadService::appendChunk(const QJsonObject& payload)
+{
+    const QString username = payload.value(QStringLiteral("username")).toString().trimmed();
+    const QString uploadId = payload.value(QStringLiteral("uploadId")).toString().trimmed();
+    const int chunkIndex = payload.value(QStringLiteral("chunkIndex")).toInt(-1);
+    const QString encoded = payload.value(QStringLiteral("dataBase64")).toString();
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+
+    if (encoded.size() > maxEncodedChunkLength()) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadChunkResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Chunk exceeds the %1 byte limit").arg(common::AdUploadMessage::kChunkBytes),
+            uploadId);
+    }
+
+    QMutexLocker locker(&mutex_);
+    cleanupExpiredLocked(now);
+
+    auto it = uploads_.find(uploadId);
+    if (it == uploads_.end()) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadChunkResult,
+            common::ErrorCode::NotFound,
+            QStringLiteral("Upload session is missing or expired"),
+            uploadId);
+    }
+    if (it->ownerUsername != username) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadChunkResult,
+            common::ErrorCode::PermissionDenied,
+            QStringLiteral("Upload session belongs to another user"),
+            uploadId);
+    }
+
+    it->lastActivity = now;
+
+    if (chunkIndex >= 0 && chunkIndex < it->nextChunkIndex) {
+        return common::AdUploadMessage::createChunkSuccessResponse(uploadId,
+                                                                  chunkIndex,
+                                                                  it->nextChunkIndex,
+                                                                  it->receivedBytes);
+    }
+
+    if (chunkIndex != it->nextChunkIndex) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadChunkResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Unexpected chunk index; expected %1").arg(it->nextChunkIndex),
+            uploadId);
+    }
+
+    const QByteArray chunk = common::Base64Codec::decode(encoded);
+    const qint64 expectedLength = qMin<qint64>(common::AdUploadMessage::kChunkBytes,
+                                               it->declaredSize - it->receivedBytes);
+    if (chunk.size() != expectedLength) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadChunkResult,
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Chunk %1 must contain %2 bytes").arg(chunkIndex).arg(expectedLength),
+            uploadId);
+    }
+
+    QFile spool(it->spoolPath);
+    if (!spool.open(QIODevice::WriteOnly | QIODevice::Append) || spool.write(chunk) != chunk.size()) {
+        return common::AdUploadMessage::createFailureResponse(
+            common::Command::AdUploadChunkResult,
+            common::ErrorCode::InternalError,
+            QStringLiteral("Failed to store chunk"),
+            uploadId);
+    }
+    spool.close();
+
+    it->receivedBytes += chunk.size();
+    ++it->nextChunkIndex;
+
+    return common::AdUploadMessage::createChunkSuccessResponse(uploadId,
+                                                              chunkIndex,
+                                                              it->nextChunkIndex,
+                                                              it->receivedBytes);
+}
+
+common::Message AdUploadService::commit(const QJsonObject& payload)
+{
+    const QString username = payload.value(QStringLiteral("username")).toString().trimmed();
+    const QString uploadId = payload.value(QStringLiteral("uploadId")).toString().trimmed();
+    const QJsonObject uploadPayload{{QStringLiteral("uploadId"), uploadId}};
+
+    UploadSession session;
+    {
+        QMutexLocker locker(&mutex_);
+        cleanupExpiredLocked(QDateTime::currentDateTimeUtc());
+
+        auto it = uploads_.find(uploadId);
+        if (it == uploads_.end()) {
+            return common::AdCreateMessage::createFailureResponse(
+                common::ErrorCode::NotFound,
+                QStringLiteral("Upload session is missing or expired"),
+                {},
+                uploadPayload);
+        }
+        if (it->ownerUsername != username) {
+            return common::AdCreateMessage::createFailureResponse(
+                common::ErrorCode::PermissionDenied,
+                QStringLiteral("Upload session belongs to another user"),
+                {},
+                uploadPayload);
+        }
+        if (it->receivedBytes != it->declaredSize) {
+            return common::AdCreateMessage::createFailureResponse(
+                common::ErrorCode::ValidationFailed,
+                QStringLiteral("Upload is incomplete: %1 of %2 bytes received")
+                    .arg(it->receivedBytes)
+                    .arg(it->declaredSize),
+                {},
+                uploadPayload);
+        }
+
+        session = it.value();
+        uploads_.erase(it);
+    }
+
+    QFile spool(session.spoolPath);
+    if (!spool.open(QIODevice::ReadOnly)) {
+        removeSpoolFile(session);
+        return common::AdCreateMessage::createFailureResponse(
+            common::ErrorCode::InternalError,
+            QStringLiteral("Failed to read uploaded image"),
+            {},
+            uploadPayload);
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&spool);
+    if (hash.result() != session.expectedSha256) {
+        spool.close();
+        removeSpoolFile(session);
+        return common::AdCreateMessage::createFailureResponse(
+            common::ErrorCode::ValidationFailed,
+            QStringLiteral("Uploaded image does not match the declared hash"),
+            {},
+            uploadPayload);
+    }
+
+    spool.seek(0);
+    const QByteArray imageBytes = spool.readAll();
+    spool.close();
+    removeSpoolFile(session);
+
+    QJsonObject adPayload = session.adPayload;
+    adPayload.insert(QStringLiteral("sellerUsername"), session.ownerUsername);
+    return adService_.create(adPayload, imageBytes);
+}
+
+void AdUploadService::cleanupExpiredLocked(const QDateTime& now)
+{
+    for (auto it = uploads_.begin(); it != uploads_.end();) {
+        if (it->lastActivity.addSecs(kUploadIdleTimeoutSecs) <= now) {
+            removeSpoolFile(it.value());
+            it = uploads_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int AdUploadService::countUploadsForOwnerLocked(const QString& username) const
+{
+    int count = 0;
+    for (const auto& session : uploads_) {
+        if (session.ownerUsername == username) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void AdUploadService::removeSpoolFile(const UploadSession& session)
+{
+    if (!session.spoolPath.isEmpty()) {
+        QFile::remove(session.spoolPath);
+    }
+}
+
+QString AdUploadService::spoolDirectory()
+{
+    return QDir(QDir::tempPath()).filePath(QStringLiteral("kalanet_uploads"));
+}
@@ -0,0 +1,48 @@
+#ifndef KALANET_AD_UPLOAD_SERVICE_H
+#define KALANET_AD_UPLOAD_SERVICE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+
+#include "protocol/message.h"
+
+class AdService;
+
+class AdUploadService
+{
+public:
+    explicit AdUploadService(AdService& adService);
+    ~AdUploadService();
+
+    common::Message init(const QJsonObject& payload);
+    common::Message appendChunk(const QJsonObject& payload);
+    common::Message commit(const QJsonObject& payload);
+
+private:
+    struct UploadSession {
+        QString uploadId;
+        QString ownerUsername;
+        QJsonObject adPayload;
+        qint64 declaredSize = 0;
+        QByteArray expectedSha256;
+        int nextChunkIndex = 0;
+        qint64 receivedBytes = 0;
+        QString spoolPath;
+        QDateTime lastActivity;
+    };
+
+    void cleanupExpiredLocked(const QDateTime& now);
+    int countUploadsForOwnerLocked(const QString& username) const;
+    static void removeSpoolFile(const UploadSession& session);
+    static QString spoolDirectory();
+
+    AdService& adService_;
+    QHash<QString, UploadSession> uploads_;
+    QMutex mutex_;
+};
+
+#endif // KALANET_AD_UPLOAD_SERVICE_H
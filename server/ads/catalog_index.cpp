@@ -0,0 +1,446 @@
+#include "catalog_index.h"
+
+#include "simd/column_filter.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace {
+constexpr std::size_t kMinTitleGarbageToCompact = 1 << 20;
+
+// When fewer than one live row in this many matches the predicate, gathering
+// the matches and partially sorting them beats walking the sort order.
+constexpr std::size_t kGatherRatio = 16;
+
+// Category id for a filter naming a category the index has never seen; no
+// row carries it.
+constexpr std::int32_t kUnknownCategory = std::numeric_limits<std::int32_t>::max();
+
+// Folds ASCII letters only, like the NOCASE collation on categories.name, so
+// the index and SQL agree on which spellings name the same category.
+QString categoryKey(const QString& category)
+{
+    QString key = category.trimmed();
+    for (QChar& ch : key) {
+        if (ch >= u'A' && ch <= u'Z') {
+            ch = QChar(ch.unicode() + (u'a' - u'A'));
+        }
+    }
+    return key;
+}
+}
+
+void CatalogIndex::load(AdRepository& repository)
+{
+    const QVector<AdRepository::AdSummaryRecord> ads = repository.listApprovedAds(AdRepository::AdListFilters{});
+
+    QWriteLocker locker(&lock_);
+    ids_.clear();
+    prices_.clear();
+    categoryIds_.clear();
+    createdAt_.clear();
+    titleOffsets_.clear();
+    titleLengths_.clear();
+    titleArena_.clear();
+    titleGarbage_ = 0;
+    records_.clear();
+    freeRows_.clear();
+    rowById_.clear();
+    categoryByName_.clear();
+    categoryNames_.clear();
+
+    const std::size_t count = static_cast<std::size_t>(ads.size());
+    ids_.reserve(count);
+    prices_.reserve(count);
+    categoryIds_.reserve(count);
+    createdAt_.reserve(count);
+    titleOffsets_.reserve(count);
+    titleLengths_.reserve(count);
+    records_.reserve(count);
+    rowById_.reserve(ads.size());
+
+    for (const AdRepository::AdSummaryRecord& ad : ads) {
+        storeRowLocked(ad);
+    }
+
+    for (int column = 0; column < kSortColumnCount; ++column) {
+        std::vector<std::uint32_t>& order = orders_[column];
+        order.resize(ids_.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [this, column](std::uint32_t a, std::uint32_t b) {
+            return lessRows(static_cast<SortColumn>(column), a, b);
+        });
+    }
+
+    loaded_ = true;
+}
+
+std::optional<QVector<AdRepository::AdSummaryRecord>> CatalogIndex::list(
+    const AdRepository::AdListFilters& filters,
+    AdRepository::AdListFacets* facets) const
+{
+    if (!filters.nameContains.trimmed().isEmpty()
+        || filters.sortField == AdRepository::AdListSortField::Relevance) {
+        return std::nullopt;
+    }
+
+    QReadLocker locker(&lock_);
+    if (!loaded_) {
+        return std::nullopt;
+    }
+
+    QVector<AdRepository::AdSummaryRecord> page;
+
+    std::int32_t category = -1;
+    if (!filters.category.trimmed().isEmpty()) {
+        const auto it = categoryByName_.constFind(categoryKey(filters.category));
+        category = it == categoryByName_.cend() ? kUnknownCategory : it.value();
+    }
+
+    const std::int32_t lo = std::max(1, filters.minPriceTokens);
+    const std::int32_t hi = filters.maxPriceTokens > 0 ? filters.maxPriceTokens
+                                                       : std::numeric_limits<std::int32_t>::max();
+    if (facets) {
+        countFacetsLocked(category, lo, hi, *facets);
+    }
+    if (category == kUnknownCategory) {
+        return page;
+    }
+
+    const SortColumn column = sortColumnFor(filters.sortField);
+    const bool ascending = filters.sortOrder == AdRepository::SortOrder::Asc;
+    const std::vector<std::uint32_t>& order = orders_[column];
+    const std::size_t limit = filters.limit > 0 ? static_cast<std::size_t>(filters.limit) : order.size();
+
+    // Positions [begin, end) of the sort order lie past the cursor.
+    SortKey cursorKey;
+    int cursorId = 0;
+    std::size_t begin = 0;
+    std::size_t end = order.size();
+    if (filters.after.has_value()) {
+        cursorId = filters.after->id;
+        if (column == ByTitle) {
+            cursorKey.text = filters.after->sortKey.toString().toStdString();
+        } else if (column == ByCreatedAt) {
+            cursorKey.number = createdAtKey(filters.after->sortKey.toString());
+        } else {
+            cursorKey.number = filters.after->sortKey.toLongLong();
+        }
+
+        if (ascending) {
+            begin = static_cast<std::size_t>(
+                std::partition_point(order.begin(), order.end(), [&](std::uint32_t row) {
+                    return compareRowToKey(column, row, cursorKey, cursorId) <= 0;
+                }) - order.begin());
+        } else {
+            end = static_cast<std::size_t>(
+                std::partition_point(order.begin(), order.end(), [&](std::uint32_t row) {
+                    return compareRowToKey(column, row, cursorKey, cursorId) < 0;
+                }) - order.begin());
+        }
+    }
+
+    page.reserve(static_cast<qsizetype>(std::min(limit, end - begin)));
+    const auto walk = [&](auto&& accept) {
+        if (ascending) {
+            for (std::size_t position = begin; position < end && static_cast<std::size_t>(page.size()) < limit; ++position) {
+                if (accept(order[position])) {
+                    page.push_back(records_[order[position]]);
+                }
+            }
+        } else {
+            for (std::size_t position = end; position > begin && static_cast<std::size_t>(page.size()) < limit; --position) {
+                if (accept(order[position - 1])) {
+                    page.push_back(records_[order[position - 1]]);
+                }
+            }
+        }
+    };
+
+    if (category < 0 && filters.minPriceTokens <= 0 && filters.maxPriceTokens <= 0) {
+        walk([](std::uint32_t) { return true; });
+        return page;
+    }
+
+    const std::size_t rows = ids_.size();
+    thread_local std::vector<std::uint64_t> mask;
+    mask.resize((rows + 63) / 64);
+    const std::size_t matches = common::simd::filterRangeEquals(
+        prices_.data(), categoryIds_.data(), rows, lo, hi, category, mask.data());
+
+    if (matches * kGatherRatio >= order.size()) {
+        walk([&](std::uint32_t row) { return (mask[row / 64] >> (row % 64)) & 1u; });
+        return page;
+    }
+
+    std::vector<std::uint32_t> candidates;
+    candidates.reserve(matches);
+    for (std::size_t word = 0; word < mask.size(); ++word) {
+        for (std::uint64_t bits = mask[word]; bits != 0; bits &= bits - 1) {
+            const auto row = static_cast<std::uint32_t>(word * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+            if (filters.after.has_value()) {
+                const int cmp = compareRowToKey(column, row, cursorKey, cursorId);
+                if (ascending ? cmp <= 0 : cmp >= 0) {
+                    continue;
+                }
+            }
+            candidates.push_back(row);
+        }
+    }
+
+    const std::size_t take = std::min(limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(take), candidates.end(),
+                      [&](std::uint32_t a, std::uint32_t b) {
+                          return ascending ? lessRows(column, a, b) : lessRows(column, b, a);
+                      });
+    for (std::size_t i = 0; i < take; ++i) {
+        page.push_back(records_[candidates[i]]);
+    }
+    return page;
+}
+
+// A single pass over the price and category columns feeds both facets: a row
+// inside the price filter counts toward its category, and a row inside the
+// category filter counts toward its price bucket.
+void CatalogIndex::countFacetsLocked(std::int32_t category,
+                                     std::int32_t minPrice,
+                                     std::int32_t maxPrice,
+                                     AdRepository::AdListFacets& facets) const
+{
+    const std::vector<int> bounds(facets.priceBounds.cbegin(), facets.priceBounds.cend());
+    std::vector<int> byCategory(categoryNames_.size(), 0);
+    std::vector<int> byBucket(bounds.size() + 1, 0);
+
+    for (std::size_t row = 0; row < ids_.size(); ++row) {
+        const std::int32_t rowCategory = categoryIds_[row];
+        if (rowCategory < 0) {
+            continue;
+        }
+        const std::int32_t price = prices_[row];
+        if (price >= minPrice && price <= maxPrice) {
+            ++byCategory[static_cast<std::size_t>(rowCategory)];
+        }
+        if (category < 0 || rowCategory == category) {
+            ++byBucket[static_cast<std::size_t>(
+                std::upper_bound(bounds.begin(), bounds.end(), price) - bounds.begin())];
+        }
+    }
+
+    facets.categories.clear();
+    for (std::size_t id = 0; id < byCategory.size(); ++id) {
+        if (byCategory[id] > 0) {
+            facets.categories.push_back({categoryNames_[id], byCategory[id]});
+        }
+    }
+    facets.priceBucketCounts = QVector<int>(byBucket.cbegin(), byBucket.cend());
+}
+
+int CatalogIndex::size() const
+{
+    QReadLocker locker(&lock_);
+    return static_cast<int>(rowById_.size());
+}
+
+void CatalogIndex::adListed(const AdRepository::AdSummaryRecord& ad)
+{
+    QWriteLocker locker(&lock_);
+    insertLocked(ad);
+}
+
+void CatalogIndex::adUnlisted(int adId)
+{
+    QWriteLocker locker(&lock_);
+    removeLocked(adId);
+}
+
+CatalogIndex::SortColumn CatalogIndex::sortColumnFor(AdRepository::AdListSortField field)
+{
+    switch (field) {
+    case AdRepository::AdListSortField::Title:
+        return ByTitle;
+    case AdRepository::AdListSortField::PriceTokens:
+        return ByPrice;
+    case AdRepository::AdListSortField::CreatedAt:
+    case AdRepository::AdListSortField::Relevance:
+    default:
+        return ByCreatedAt;
+    }
+}
+
+// Packs the digits of "yyyy-MM-dd HH:mm:ss" into yyyyMMddHHmmss, which orders
+// the same way as the text SQLite sorts on.
+std::int64_t CatalogIndex::createdAtKey(const QString& createdAt)
+{
+    std::int64_t key = 0;
+    int digits = 0;
+    for (const QChar ch : createdAt) {
+        if (ch.isDigit()) {
+            key = key * 10 + ch.digitValue();
+            if (++digits == 14) {
+                break;
+            }
+        }
+    }
+    return key;
+}
+
+bool CatalogIndex::lessRows(SortColumn column, std::uint32_t a, std::uint32_t b) const
+{
+    switch (column) {
+    case ByTitle: {
+        const int cmp = titleOf(a).compare(titleOf(b));
+        if (cmp != 0) {
+            return cmp < 0;
+        }
+        break;
+    }
+    case ByPrice:
+        if (prices_[a] != prices_[b]) {
+            return prices_[a] < prices_[b];
+        }
+        break;
+    case ByCreatedAt:
+    default:
+        if (createdAt_[a] != createdAt_[b]) {
+            return createdAt_[a] < createdAt_[b];
+        }
+        break;
+    }
+    return ids_[a] < ids_[b];
+}
+
+int CatalogIndex::compareRowToKey(SortColumn column, std::uint32_t row, const SortKey& key, int id) const
+{
+    int cmp = 0;
+    switch (column) {
+    case ByTitle:
+        cmp = titleOf(row).compare(key.text);
+        break;
+    case ByPrice:
+        cmp = prices_[row] < key.number ? -1 : (prices_[row] > key.number ? 1 : 0);
+        break;
+    case ByCreatedAt:
+    default:
+        cmp = createdAt_[row] < key.number ? -1 : (createdAt_[row] > key.number ? 1 : 0);
+        break;
+    }
+    if (cmp != 0) {
+        return cmp;
+    }
+    return ids_[row] < id ? -1 : (ids_[row] > id ? 1 : 0);
+}
+
+std::string_view CatalogIndex::titleOf(std::uint32_t row) const
+{
+    return std::string_view(titleArena_.data() + titleOffsets_[row], titleLengths_[row]);
+}
+
+std::uint32_t CatalogIndex::storeRowLocked(const AdRepository::AdSummaryRecord& ad)
+{
+    std::uint32_t row = 0;
+    if (!freeRows_.empty()) {
+        row = freeRows_.back();
+        freeRows_.pop_back();
+    } else {
+        row = static_cast<std::uint32_t>(ids_.size());
+        ids_.push_back(0);
+        prices_.push_back(-1);
+        categoryIds_.push_back(-1);
+        createdAt_.push_back(0);
+        titleOffsets_.push_back(0);
+        titleLengths_.push_back(0);
+        records_.emplace_back();
+    }
+
+    const QByteArray title = ad.title.toUtf8();
+    ids_[row] = ad.id;
+    prices_[row] = ad.priceTokens;
+    categoryIds_[row] = categoryIdLocked(ad.category);
+    createdAt_[row] = createdAtKey(ad.createdAt);
+    titleOffsets_[row] = static_cast<std::uint32_t>(titleArena_.size());
+    titleLengths_[row] = static_cast<std::uint32_t>(title.size());
+    titleArena_.append(title.constData(), static_cast<std::size_t>(title.size()));
+    records_[row] = ad;
+    records_[row].relevance = 0.0;
+    rowById_.insert(ad.id, row);
+    return row;
+}
+
+void CatalogIndex::insertLocked(const AdRepository::AdSummaryRecord& ad)
+{
+    removeLocked(ad.id);
+
+    const std::uint32_t row = storeRowLocked(ad);
+    for (int column = 0; column < kSortColumnCount; ++column) {
+        std::vector<std::uint32_t>& order = orders_[column];
+        const auto position = std::upper_bound(order.begin(), order.end(), row,
+                                               [this, column](std::uint32_t a, std::uint32_t b) {
+                                                   return lessRows(static_cast<SortColumn>(column), a, b);
+                                               });
+        order.insert(position, row);
+    }
+}
+
+void CatalogIndex::removeLocked(int adId)
+{
+    const auto it = rowById_.constFind(adId);
+    if (it == rowById_.cend()) {
+        return;
+    }
+    const std::uint32_t row = it.value();
+
+    for (int column = 0; column < kSortColumnCount; ++column) {
+        std::vector<std::uint32_t>& order = orders_[column];
+        const auto position = std::lower_bound(order.begin(), order.end(), row,
+                                               [this, column](std::uint32_t a, std::uint32_t b) {
+                                                   return lessRows(static_cast<SortColumn>(column), a, b);
+                                               });
+        if (position != order.end() && *position == row) {
+            order.erase(position);
+        }
+    }
+
+    titleGarbage_ += titleLengths_[row];
+    prices_[row] = -1;
+    categoryIds_[row] = -1;
+    titleLengths_[row] = 0;
+    records_[row] = AdRepository::AdSummaryRecord{};
+    rowById_.erase(it);
+    freeRows_.push_back(row);
+
+    if (titleGarbage_ >= kMinTitleGarbageToCompact && titleGarbage_ * 2 > titleArena_.size()) {
+        compactTitlesLocked();
+    }
+}
+
+void CatalogIndex::compactTitlesLocked()
+{
+    std::string compacted;
+    compacted.reserve(titleArena_.size() - titleGarbage_);
+    for (const std::uint32_t row : std::as_const(rowById_)) {
+        const std::string_view title = titleOf(row);
+        titleOffsets_[row] = static_cast<std::uint32_t>(compacted.size());
+        compacted.append(title);
+    }
+    titleArena_ = std::move(compacted);
+    titleGarbage_ = 0;
+}
+
+std::int32_t CatalogIndex::categoryIdLocked(const QString& category)
+{
+    const QString key = categoryKey(category);
+    const auto it = categoryByName_.constFind(key);
+    if (it != categoryByName_.cend()) {
+        return it.value();
+    }
+    const auto id = static_cast<std::int32_t>(categoryByName_.size());
+    categoryByName_.insert(key, id);
+    categoryNames_.push_back(category.trimmed());
+    return id;
+}
@@ -0,0 +1,93 @@
+#ifndef KALANET_CATALOG_INDEX_H
+#define KALANET_CATALOG_INDEX_H
+
+#include "catalog_version.h"
+#include "../repository/ad_repository.h"
+
+#include <QHash>
+#include <QReadWriteLock>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// In-memory columnar copy of the approved catalog. Filter and sort keys live in
+// parallel arrays scanned with SIMD; full records sit alongside only to build
+// responses. Loaded once from the repository, then kept current through
+// CatalogVersion notifications, so AdList pages never touch SQLite.
+class CatalogIndex : public CatalogVersion::Listener
+{
+public:
+    void load(AdRepository& repository);
+
+    // Page of approved ads matching the filters, honouring limit and cursor.
+    // Returns nullopt for requests the index does not cover (text search,
+    // relevance order) so the caller can fall back to SQL. When facets is
+    // given, its counts are filled from the same snapshot as the page.
+    std::optional<QVector<AdRepository::AdSummaryRecord>> list(
+        const AdRepository::AdListFilters& filters,
+        AdRepository::AdListFacets* facets = nullptr) const;
+
+    int size() const;
+
+    void adListed(const AdRepository::AdSummaryRecord& ad) override;
+    void adUnlisted(int adId) override;
+
+private:
+    enum SortColumn {
+        ByCreatedAt,
+        ByTitle,
+        ByPrice,
+        kSortColumnCount
+    };
+
+    struct SortKey {
+        std::int64_t number = 0;
+        std::string text;
+    };
+
+    static SortColumn sortColumnFor(AdRepository::AdListSortField field);
+    static std::int64_t createdAtKey(const QString& createdAt);
+
+    bool lessRows(SortColumn column, std::uint32_t a, std::uint32_t b) const;
+    int compareRowToKey(SortColumn column, std::uint32_t row, const SortKey& key, int id) const;
+    std::string_view titleOf(std::uint32_t row) const;
+    void countFacetsLocked(std::int32_t category,
+                           std::int32_t minPrice,
+                           std::int32_t maxPrice,
+                           AdRepository::AdListFacets& facets) const;
+
+    std::uint32_t storeRowLocked(const AdRepository::AdSummaryRecord& ad);
+    void insertLocked(const AdRepository::AdSummaryRecord& ad);
+    void removeLocked(int adId);
+    void compactTitlesLocked();
+    std::int32_t categoryIdLocked(const QString& category);
+
+    mutable QReadWriteLock lock_;
+    bool loaded_ = false;
+
+    // One slot per row; rows freed by removals are reused. A free row keeps
+    // price -1 so no price predicate (always >= 1) can select it.
+    std::vector<std::int32_t> ids_;
+    std::vector<std::int32_t> prices_;
+    std::vector<std::int32_t> categoryIds_;
+    std::vector<std::int64_t> createdAt_;
+    std::vector<std::uint32_t> titleOffsets_;
+    std::vector<std::uint32_t> titleLengths_;
+    std::string titleArena_;
+    std::size_t titleGarbage_ = 0;
+    std::vector<AdRepository::AdSummaryRecord> records_;
+    std::vector<std::uint32_t> freeRows_;
+
+    // Live rows ordered by (key, id) ascending for each sort column.
+    std::vector<std::uint32_t> orders_[kSortColumnCount];
+
+    QHash<int, std::uint32_t> rowById_;
+    QHash<QString, std::int32_t> categoryByName_;
+    // Display name per category id, as first spelled by an indexed ad.
+    std::vector<QString> categoryNames_;
+};
+
+#endif // KALANET_CATALOG_INDEX_H
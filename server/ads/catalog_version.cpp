@@ -0,0 +1,39 @@
+#include "catalog_version.h"
+
+#include <QDateTime>
+
+CatalogVersion::CatalogVersion()
+    : epoch_(QDateTime::currentMSecsSinceEpoch())
+{
+}
+
+QString CatalogVersion::token() const
+{
+    return QStringLiteral("%1-%2").arg(epoch_).arg(counter_.load(std::memory_order_acquire));
+}
+
+void CatalogVersion::bump()
+{
+    counter_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void CatalogVersion::setListener(Listener* listener)
+{
+    listener_.store(listener, std::memory_order_release);
+}
+
+void CatalogVersion::adListed(const AdRepository::AdSummaryRecord& ad)
+{
+    if (Listener* listener = listener_.load(std::memory_order_acquire)) {
+        listener->adListed(ad);
+    }
+    bump();
+}
+
+void CatalogVersion::adUnlisted(int adId)
+{
+    if (Listener* listener = listener_.load(std::memory_order_acquire)) {
+        listener->adUnlisted(adId);
+    }
+    bump();
+}
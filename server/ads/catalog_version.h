@@ -0,0 +1,38 @@
+#ifndef KALANET_CATALOG_VERSION_H
+#define KALANET_CATALOG_VERSION_H
+
+#include "../repository/ad_repository.h"
+
+#include <QString>
+
+#include <atomic>
+
+class CatalogVersion
+{
+public:
+    // Told about every ad that enters or leaves the approved catalog, before
+    // the version token moves on.
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        virtual void adListed(const AdRepository::AdSummaryRecord& ad) = 0;
+        virtual void adUnlisted(int adId) = 0;
+    };
+
+    CatalogVersion();
+
+    QString token() const;
+    void bump();
+
+    void setListener(Listener* listener);
+    void adListed(const AdRepository::AdSummaryRecord& ad);
+    void adUnlisted(int adId);
+
+private:
+    const qint64 epoch_;
+    std::atomic<quint64> counter_{0};
+    std::atomic<Listener*> listener_{nullptr};
+};
+
+#endif // KALANET_CATALOG_VERSION_H
@@ -0,0 +1,148 @@
+#include "thumbnail_pipeline.h"
+
+#include "../repository/ad_repository.h"
+#include "../logging_audit_logger.h"
+
+#include <QBuffer>
+#include <QImage>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <exception>
+
+namespace {
+
+constexpr int kJpegQuality = 80;
+
+QByteArray encodeImage(const QImage& image, const char* format, int quality)
+{
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    if (!buffer.open(QIODevice::WriteOnly) || !image.save(&buffer, format, quality)) {
+        return QByteArray();
+    }
+    return bytes;
+}
+
+}
+
+ThumbnailPipeline::ThumbnailPipeline(AdRepository& adRepository, int threadCount)
+    : adRepository_(adRepository)
+{
+    if (threadCount <= 0) {
+        threadCount = qMax(1, QThread::idealThreadCount() / 4);
+    }
+    pool_.setMaxThreadCount(threadCount);
+    pool_.setObjectName(QStringLiteral("kalanet-thumbnails"));
+}
+
+ThumbnailPipeline::~ThumbnailPipeline()
+{
+    pool_.clear();
+    pool_.waitForDone();
+}
+
+void ThumbnailPipeline::enqueue(const QByteArray& imageBytes)
+{
+    if (imageBytes.isEmpty()) {
+        return;
+    }
+
+    // Hashed here rather than on the worker so that a request() arriving
+    // before the job runs sees it pending and does not queue a second one.
+    const QString sha256 = ImageStore::sha256Hex(imageBytes);
+    {
+        QMutexLocker locker(&mutex_);
+        if (failed_.contains(sha256) || pending_.contains(sha256)) {
+            return;
+        }
+        pending_.insert(sha256);
+    }
+
+    pool_.start([this, sha256, imageBytes]() {
+        generate(sha256, imageBytes);
+
+        QMutexLocker locker(&mutex_);
+        pending_.remove(sha256);
+    });
+}
+
+bool ThumbnailPipeline::request(const QString& sha256)
+{
+    if (sha256.isEmpty()) {
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&mutex_);
+        if (failed_.contains(sha256)) {
+            return false;
+        }
+        if (pending_.contains(sha256)) {
+            return true;
+        }
+        pending_.insert(sha256);
+    }
+
+    pool_.start([this, sha256]() {
+        const auto image = adRepository_.openImage(sha256);
+        generate(sha256, image ? image->bytes() : QByteArray());
+
+        QMutexLocker locker(&mutex_);
+        pending_.remove(sha256);
+    });
+    return true;
+}
+
+ThumbnailPipeline::Metrics ThumbnailPipeline::metrics() const
+{
+    Metrics result;
+    result.generated = generated_.load(std::memory_order_relaxed);
+    result.failed = failedCount_.load(std::memory_order_relaxed);
+    QMutexLocker locker(&mutex_);
+    result.pending = static_cast<int>(pending_.size());
+    return result;
+}
+
+QByteArray ThumbnailPipeline::render(const QByteArray& imageBytes)
+{
+    QImage image;
+    if (imageBytes.isEmpty() || !image.loadFromData(imageBytes)) {
+        return QByteArray();
+    }
+
+    if (image.width() > kThumbnailWidth || image.height() > kThumbnailHeight) {
+        image = image.scaled(kThumbnailWidth, kThumbnailHeight, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    if (!image.hasAlphaChannel()) {
+        const QByteArray jpeg = encodeImage(image, "JPG", kJpegQuality);
+        if (!jpeg.isEmpty()) {
+            return jpeg;
+        }
+    }
+    // Also the fallback for builds without the JPEG image plugin.
+    return encodeImage(image, "PNG", -1);
+}
+
+void ThumbnailPipeline::generate(const QString& sha256, const QByteArray& imageBytes)
+{
+    const QByteArray thumbnail = render(imageBytes);
+    if (thumbnail.isEmpty()) {
+        // Undecodable images are remembered so clients stop asking for them.
+        failedCount_.fetch_add(1, std::memory_order_relaxed);
+        QMutexLocker locker(&mutex_);
+        failed_.insert(sha256);
+        return;
+    }
+
+    try {
+        adRepository_.storeThumbnail(sha256, thumbnail);
+        generated_.fetch_add(1, std::memory_order_relaxed);
+    } catch (const std::exception& ex) {
+        failedCount_.fetch_add(1, std::memory_order_relaxed);
+        AuditLogger::log(QStringLiteral("ads.thumbnail"), QStringLiteral("failed"),
+                         QJsonObject{{QStringLiteral("sha256"), sha256},
+                                     {QStringLiteral("error"), QString::fromUtf8(ex.what())}});
+    }
+}
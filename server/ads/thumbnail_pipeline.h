@@ -0,0 +1,57 @@
+#ifndef KALANET_THUMBNAIL_PIPELINE_H
+#define KALANET_THUMBNAIL_PIPELINE_H
+
+#include <atomic>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+class AdRepository;
+
+// Scales ad images down to list-row thumbnails on a worker pool and stores
+// them beside the original, keyed by the original's hash. New ads are queued
+// from the bytes already in memory; images stored before thumbnails existed
+// are queued from the store the first time a thumbnail is asked for.
+class ThumbnailPipeline
+{
+public:
+    static constexpr int kThumbnailWidth = 144;
+    static constexpr int kThumbnailHeight = 108;
+
+    struct Metrics {
+        qint64 generated = 0;
+        qint64 failed = 0;
+        int pending = 0;
+    };
+
+    explicit ThumbnailPipeline(AdRepository& adRepository, int threadCount = 0);
+    ~ThumbnailPipeline();
+
+    void enqueue(const QByteArray& imageBytes);
+
+    // Returns true while a thumbnail for the stored image is being generated,
+    // queueing the work if it is not already; false once it cannot be made.
+    bool request(const QString& sha256);
+
+    Metrics metrics() const;
+
+    // JPEG for opaque images, PNG where transparency must survive. Empty when
+    // the bytes do not decode as an image.
+    static QByteArray render(const QByteArray& imageBytes);
+
+private:
+    void generate(const QString& sha256, const QByteArray& imageBytes);
+
+    AdRepository& adRepository_;
+    QThreadPool pool_;
+    mutable QMutex mutex_;
+    QSet<QString> pending_;
+    QSet<QString> failed_;
+    std::atomic<qint64> generated_{0};
+    std::atomic<qint64> failedCount_{0};
+};
+
+#endif // KALANET_THUMBNAIL_PIPELINE_H
@@ -1,6 +1,7 @@
 #include "auth_service.h"
 #include "protocol/commands.h"
 #include "../security/captcha_service.h"
+#include "../security/kdf_worker_pool.h"
 #include "../repository/ad_repository.h"
 #include "../repository/wallet_repository.h"
 #include "../logging_audit_logger.h"
@@ -12,11 +13,13 @@
 AuthService::AuthService(UserRepository& repo,
                          CaptchaService& captchaService,
                          AdRepository* adRepository,
-                         WalletRepository* walletRepository)
+                         WalletRepository* walletRepository,
+                         KdfWorkerPool* kdfPool)
     : repo_(repo),
       adRepository_(adRepository),
       captchaService_(captchaService),
-      walletRepository_(walletRepository)
+      walletRepository_(walletRepository),
+      kdfPool_(kdfPool)
 {
 }
 
@@ -25,7 +28,7 @@ static QString roleToString(const QString& role)
     return role;
 }
 
-common::Message AuthService::login(const QJsonObject& payload)
+void AuthService::login(const QJsonObject& payload, Completion done)
 {
     const QString username = payload.value("username").toString();
     const QString password = payload.value("password").toString();
@@ -33,69 +36,84 @@ common::Message AuthService::login(const QJsonObject& payload)
     const int captchaAnswer = payload.value(QStringLiteral("captchaAnswer")).toInt(std::numeric_limits<int>::min());
 
     if (username.isEmpty() || password.isEmpty()) {
-        return common::Message::makeFailure(common::Command::LoginResult,
-                                            common::ErrorCode::ValidationFailed,
-                                            QStringLiteral("Missing username or password"),
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeFailure(common::Command::LoginResult,
+                                          common::ErrorCode::ValidationFailed,
+                                          QStringLiteral("Missing username or password"),
+                                          QJsonObject{{"success", false}}));
+        return;
     }
 
     if (captchaNonce.isEmpty() || captchaAnswer == std::numeric_limits<int>::min()) {
-        return common::Message::makeFailure(common::Command::LoginResult,
-                                            common::ErrorCode::ValidationFailed,
-                                            QStringLiteral("CAPTCHA is required"),
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeFailure(common::Command::LoginResult,
+                                          common::ErrorCode::ValidationFailed,
+                                          QStringLiteral("CAPTCHA is required"),
+                                          QJsonObject{{"success", false}}));
+        return;
     }
 
     QString captchaFailure;
     if (!captchaService_.verifyAndConsume(captchaNonce, captchaAnswer, QStringLiteral("login"), &captchaFailure)) {
-        return common::Message::makeFailure(common::Command::LoginResult,
-                                            common::ErrorCode::ValidationFailed,
-                                            captchaFailure,
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeFailure(common::Command::LoginResult,
+                                          common::ErrorCode::ValidationFailed,
+                                          captchaFailure,
+                                          QJsonObject{{"success", false}}));
+        return;
     }
 
+    User user;
     try {
-        User user;
         if (!repo_.getUser(username, user)) {
             AuditLogger::log(QStringLiteral("auth.login"), QStringLiteral("failed"),
                              QJsonObject{{QStringLiteral("username"), username},
                                          {QStringLiteral("reason"), QStringLiteral("user_not_found")}});
-            return common::Message::makeFailure(common::Command::LoginResult,
-                                                common::ErrorCode::NotFound,
-                                                QStringLiteral("User not found"),
-                                                QJsonObject{{"success", false}});
+            done(common::Message::makeFailure(common::Command::LoginResult,
+                                              common::ErrorCode::NotFound,
+                                              QStringLiteral("User not found"),
+                                              QJsonObject{{"success", false}}));
+            return;
         }
+    } catch (const std::exception&) {
+        done(common::Message::makeFailure(common::Command::LoginResult,
+                                          common::ErrorCode::InternalError,
+                                          QStringLiteral("Login failed due to server error"),
+                                          QJsonObject{{"success", false}}));
+        return;
+    }
 
-        if (!PasswordHasher::verify(password, user.passwordHash)) {
+    const bool queued = verifyPassword(password, user.passwordHash, [this, done, username, user](bool valid, const QString& upgradedHash) {
+        if (!valid) {
             AuditLogger::log(QStringLiteral("auth.login"), QStringLiteral("failed"),
                              QJsonObject{{QStringLiteral("username"), username},
                                          {QStringLiteral("reason"), QStringLiteral("invalid_credentials")}});
-            return common::Message::makeFailure(common::Command::LoginResult,
-                                                common::ErrorCode::AuthInvalidCredentials,
-                                                QStringLiteral("Invalid username or password"),
-                                                QJsonObject{{"success", false}});
+            done(common::Message::makeFailure(common::Command::LoginResult,
+                                              common::ErrorCode::AuthInvalidCredentials,
+                                              QStringLiteral("Invalid username or password"),
+                                              QJsonObject{{"success", false}}));
+            return;
+        }
+
+        if (!upgradedHash.isEmpty()) {
+            upgradePasswordHash(user, upgradedHash);
         }
 
         AuditLogger::log(QStringLiteral("auth.login"), QStringLiteral("success"),
                          QJsonObject{{QStringLiteral("username"), username},
                                      {QStringLiteral("role"), roleToString(user.role)}});
-        return common::Message::makeSuccess(common::Command::LoginResult,
-                                            QJsonObject{{"success", true},
-                                                        {"username", user.username},
-                                                        {"fullName", user.fullName},
-                                                        {"role", roleToString(user.role)}},
-                                            {},
-                                            {},
-                                            QStringLiteral("Login successful"));
-    } catch (const std::exception&) {
-        return common::Message::makeFailure(common::Command::LoginResult,
-                                            common::ErrorCode::InternalError,
-                                            QStringLiteral("Login failed due to server error"),
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeSuccess(common::Command::LoginResult,
+                                          QJsonObject{{"success", true},
+                                                      {"username", user.username},
+                                                      {"fullName", user.fullName},
+                                                      {"role", roleToString(user.role)}},
+                                          {},
+                                          {},
+                                          QStringLiteral("Login successful")));
+    });
+    if (!queued) {
+        done(busyResponse(common::Command::LoginResult));
     }
 }
 
-common::Message AuthService::signup(const QJsonObject& payload)
+void AuthService::signup(const QJsonObject& payload, Completion done)
 {
     const QString fullName = payload.value("fullName").toString();
     const QString username = payload.value("username").toString();
@@ -104,65 +122,77 @@ common::Message AuthService::signup(const QJsonObject& payload)
     const QString password = payload.value("password").toString();
 
     if (fullName.isEmpty() || username.isEmpty() || phone.isEmpty() || email.isEmpty() || password.isEmpty()) {
-        return common::Message::makeFailure(common::Command::SignupResult,
-                                            common::ErrorCode::ValidationFailed,
-                                            QStringLiteral("Missing required fields"),
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeFailure(common::Command::SignupResult,
+                                          common::ErrorCode::ValidationFailed,
+                                          QStringLiteral("Missing required fields"),
+                                          QJsonObject{{"success", false}}));
+        return;
     }
 
     if (password.size() < 8) {
-        return common::Message::makeFailure(common::Command::SignupResult,
-                                            common::ErrorCode::ValidationFailed,
-                                            QStringLiteral("Password must be at least 8 characters"),
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeFailure(common::Command::SignupResult,
+                                          common::ErrorCode::ValidationFailed,
+                                          QStringLiteral("Password must be at least 8 characters"),
+                                          QJsonObject{{"success", false}}));
+        return;
     }
 
     if (!email.contains("@")) {
-        return common::Message::makeFailure(common::Command::SignupResult,
-                                            common::ErrorCode::ValidationFailed,
-                                            QStringLiteral("Invalid email format"),
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeFailure(common::Command::SignupResult,
+                                          common::ErrorCode::ValidationFailed,
+                                          QStringLiteral("Invalid email format"),
+                                          QJsonObject{{"success", false}}));
+        return;
     }
 
     if (repo_.userExists(username)) {
-        return common::Message::makeFailure(common::Command::SignupResult,
-                                            common::ErrorCode::AlreadyExists,
-                                            QStringLiteral("Username already exists"),
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeFailure(common::Command::SignupResult,
+                                          common::ErrorCode::AlreadyExists,
+                                          QStringLiteral("Username already exists"),
+                                          QJsonObject{{"success", false}}));
+        return;
     }
 
     if (repo_.emailExists(email)) {
-        return common::Message::makeFailure(common::Command::SignupResult,
-                                            common::ErrorCode::AlreadyExists,
-                                            QStringLiteral("Email already exists"),
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeFailure(common::Command::SignupResult,
+                                          common::ErrorCode::AlreadyExists,
+                                          QStringLiteral("Email already exists"),
+                                          QJsonObject{{"success", false}}));
+        return;
     }
 
-    User user{fullName, username, phone, email, PasswordHasher::hash(password), QStringLiteral("User")};
+    const bool queued = hashPassword(password, [this, done, fullName, username, phone, email](const QString& passwordHash) {
+        User user{fullName, username, phone, email, passwordHash, QStringLiteral("User")};
+
+        try {
+            repo_.createUser(user);
+        } catch (const std::runtime_error&) {
+            done(common::Message::makeFailure(common::Command::SignupResult,
+                                              common::ErrorCode::AlreadyExists,
+                                              QStringLiteral("Username or email already exists"),
+                                              QJsonObject{{"success", false}}));
+            return;
+        } catch (...) {
+            done(common::Message::makeFailure(common::Command::SignupResult,
+                                              common::ErrorCode::InternalError,
+                                              QStringLiteral("Signup failed due to server error"),
+                                              QJsonObject{{"success", false}}));
+            return;
+        }
 
-    try {
-        repo_.createUser(user);
-    } catch (const std::runtime_error&) {
-        return common::Message::makeFailure(common::Command::SignupResult,
-                                            common::ErrorCode::AlreadyExists,
-                                            QStringLiteral("Username or email already exists"),
-                                            QJsonObject{{"success", false}});
-    } catch (...) {
-        return common::Message::makeFailure(common::Command::SignupResult,
-                                            common::ErrorCode::InternalError,
-                                            QStringLiteral("Signup failed due to server error"),
-                                            QJsonObject{{"success", false}});
+        done(common::Message::makeSuccess(common::Command::SignupResult,
+                                          QJsonObject{{"success", true},
+                                                      {"username", username}},
+                                          {},
+                                          {},
+                                          QStringLiteral("Signup successful")));
+    });
+    if (!queued) {
+        done(busyResponse(common::Command::SignupResult));
     }
-
-    return common::Message::makeSuccess(common::Command::SignupResult,
-                                        QJsonObject{{"success", true},
-                                                    {"username", username}},
-                                        {},
-                                        {},
-                                        QStringLiteral("Signup successful"));
 }
 
-common::Message AuthService::updateProfile(const QJsonObject& payload)
+void AuthService::updateProfile(const QJsonObject& payload, Completion done)
 {
     const QString currentUsername = payload.value(QStringLiteral("currentUsername")).toString().trimmed();
     const QString newUsername = payload.value(QStringLiteral("username")).toString().trimmed();
@@ -173,60 +203,93 @@ common::Message AuthService::updateProfile(const QJsonObject& payload)
     const QString password = payload.value(QStringLiteral("password")).toString();
 
     if (currentUsername.isEmpty() || newUsername.isEmpty() || fullName.isEmpty() || phone.isEmpty() || email.isEmpty()) {
-        return common::Message::makeFailure(common::Command::ProfileUpdateResult,
-                                            common::ErrorCode::ValidationFailed,
-                                            QStringLiteral("Missing required profile fields"));
+        done(common::Message::makeFailure(common::Command::ProfileUpdateResult,
+                                          common::ErrorCode::ValidationFailed,
+                                          QStringLiteral("Missing required profile fields")));
+        return;
     }
 
     User existing;
     if (!repo_.getUser(currentUsername, existing)) {
-        return common::Message::makeFailure(common::Command::ProfileUpdateResult,
-                                            common::ErrorCode::NotFound,
-                                            QStringLiteral("User not found"));
+        done(common::Message::makeFailure(common::Command::ProfileUpdateResult,
+                                          common::ErrorCode::NotFound,
+                                          QStringLiteral("User not found")));
+        return;
     }
 
     if (newUsername.compare(currentUsername, Qt::CaseInsensitive) != 0 && repo_.userExists(newUsername)) {
-        return common::Message::makeFailure(common::Command::ProfileUpdateResult,
-                                            common::ErrorCode::AlreadyExists,
-                                            QStringLiteral("Username already exists"));
+        done(common::Message::makeFailure(common::Command::ProfileUpdateResult,
+                                          common::ErrorCode::AlreadyExists,
+                                          QStringLiteral("Username already exists")));
+        return;
     }
 
     if (email.compare(existing.email, Qt::CaseInsensitive) != 0 && repo_.emailExists(email)) {
-        return common::Message::makeFailure(common::Command::ProfileUpdateResult,
-                                            common::ErrorCode::AlreadyExists,
-                                            QStringLiteral("Email already exists"));
+        done(common::Message::makeFailure(common::Command::ProfileUpdateResult,
+                                          common::ErrorCode::AlreadyExists,
+                                          QStringLiteral("Email already exists")));
+        return;
     }
 
+    const QString storedHash = existing.passwordHash;
     existing.username = newUsername;
     existing.fullName = fullName;
     existing.phone = phone;
     existing.email = email;
-    if (!password.trimmed().isEmpty()) {
-        if (oldPassword.trimmed().isEmpty()) {
-            return common::Message::makeFailure(common::Command::ProfileUpdateResult,
-                                                common::ErrorCode::ValidationFailed,
-                                                QStringLiteral("Old password is required"));
-        }
+    if (password.trimmed().isEmpty()) {
+        done(finishProfileUpdate(currentUsername, existing));
+        return;
+    }
 
-        if (!PasswordHasher::verify(oldPassword, existing.passwordHash)) {
-            return common::Message::makeFailure(common::Command::ProfileUpdateResult,
-                                                common::ErrorCode::ValidationFailed,
-                                                QStringLiteral("Old password is incorrect"));
+    if (oldPassword.trimmed().isEmpty()) {
+        done(common::Message::makeFailure(common::Command::ProfileUpdateResult,
+                                          common::ErrorCode::ValidationFailed,
+                                          QStringLiteral("Old password is required")));
+        return;
+    }
+
+    if (password.size() < 8) {
+        done(common::Message::makeFailure(common::Command::ProfileUpdateResult,
+                                          common::ErrorCode::ValidationFailed,
+                                          QStringLiteral("Password must be at least 8 characters")));
+        return;
+    }
+
+    const bool queued = verifyPassword(oldPassword, storedHash, [this, done, currentUsername, existing, password](bool valid, const QString&) {
+        if (!valid) {
+            done(common::Message::makeFailure(common::Command::ProfileUpdateResult,
+                                              common::ErrorCode::ValidationFailed,
+                                              QStringLiteral("Old password is incorrect")));
+            return;
         }
 
-        if (password.size() < 8) {
-            return common::Message::makeFailure(common::Command::ProfileUpdateResult,
-                                                common::ErrorCode::ValidationFailed,
-                                                QStringLiteral("Password must be at least 8 characters"));
+        // Only the hash the old password was checked against may be replaced;
+        // a password changed meanwhile makes this update fail instead.
+        const bool hashQueued = hashPassword(password, [this, done, currentUsername, existing](const QString& passwordHash) {
+            done(finishProfileUpdate(currentUsername, existing, existing.passwordHash, passwordHash));
+        });
+        if (!hashQueued) {
+            done(busyResponse(common::Command::ProfileUpdateResult));
         }
-        existing.passwordHash = PasswordHasher::hash(password);
+    });
+    if (!queued) {
+        done(busyResponse(common::Command::ProfileUpdateResult));
     }
+}
 
+common::Message AuthService::finishProfileUpdate(const QString& currentUsername,
+                                                 const User& profile,
+                                                 const QString& expectedPasswordHash,
+                                                 const QString& newPasswordHash)
+{
     try {
-        if (!repo_.updateUser(currentUsername, existing)) {
+        if (!repo_.updateProfile(currentUsername, profile, expectedPasswordHash, newPasswordHash)) {
             return common::Message::makeFailure(common::Command::ProfileUpdateResult,
                                                 common::ErrorCode::AlreadyExists,
-                                                QStringLiteral("Could not update profile due to duplicate username or email"));
+                                                newPasswordHash.isEmpty()
+                                                    ? QStringLiteral("Could not update profile due to duplicate username or email")
+                                                    : QStringLiteral("Could not update profile due to duplicate username or email, "
+                                                                     "or a password change made meanwhile"));
         }
     } catch (const std::exception& ex) {
         return common::Message::makeFailure(common::Command::ProfileUpdateResult,
@@ -235,15 +298,59 @@ common::Message AuthService::updateProfile(const QJsonObject& payload)
     }
 
     return common::Message::makeSuccess(common::Command::ProfileUpdateResult,
-                                        QJsonObject{{QStringLiteral("username"), existing.username},
-                                                    {QStringLiteral("email"), existing.email},
-                                                    {QStringLiteral("fullName"), existing.fullName},
-                                                    {QStringLiteral("phone"), existing.phone}},
+                                        QJsonObject{{QStringLiteral("username"), profile.username},
+                                                    {QStringLiteral("email"), profile.email},
+                                                    {QStringLiteral("fullName"), profile.fullName},
+                                                    {QStringLiteral("phone"), profile.phone}},
                                         {},
                                         {},
                                         QStringLiteral("Profile updated successfully"));
 }
 
+bool AuthService::verifyPassword(const QString& password,
+                                 const QString& storedHash,
+                                 std::function<void(bool, QString)> done)
+{
+    if (!kdfPool_) {
+        QString upgradedHash;
+        const bool valid = PasswordHasher::verify(password, storedHash, &upgradedHash);
+        done(valid, upgradedHash);
+        return true;
+    }
+    return kdfPool_->verify(password, storedHash, std::move(done));
+}
+
+void AuthService::upgradePasswordHash(const User& user, const QString& upgradedHash)
+{
+    // Only the hash is swapped, and only if it is still the one just verified,
+    // so changes made while the KDF ran are never overwritten.
+    try {
+        if (repo_.updatePasswordHash(user.username, user.passwordHash, upgradedHash)) {
+            AuditLogger::log(QStringLiteral("auth.rehash"), QStringLiteral("success"),
+                             QJsonObject{{QStringLiteral("username"), user.username}});
+        }
+    } catch (const std::exception&) {
+        // The old hash still verifies; the upgrade is retried on the next login.
+    }
+}
+
+bool AuthService::hashPassword(const QString& password, std::function<void(QString)> done)
+{
+    if (!kdfPool_) {
+        done(PasswordHasher::hash(password));
+        return true;
+    }
+    return kdfPool_->hash(password, std::move(done));
+}
+
+common::Message AuthService::busyResponse(common::Command command)
+{
+    return common::Message::makeFailure(command,
+                                        common::ErrorCode::ServiceBusy,
+                                        QStringLiteral("Server is busy, please try again shortly"),
+                                        QJsonObject{{"success", false}});
+}
+
 common::Message AuthService::profileHistory(const QJsonObject& payload)
 {
     if (!adRepository_ || !walletRepository_) {
@@ -353,6 +460,31 @@ common::Message AuthService::adminStats(const QJsonObject&)
                             {QStringLiteral("sales"), QJsonObject{{QStringLiteral("soldAdsCount"), sales.soldAdsCount},
                                                                     {QStringLiteral("totalTokens"), sales.totalTokens}}}};
 
+        if (const std::optional<UserCacheStats> cache = repo_.cacheStats()) {
+            const UserCacheStats& stats = *cache;
+            const qint64 lookups = stats.recordHits + stats.recordMisses;
+            payload.insert(QStringLiteral("userCache"),
+                           QJsonObject{{QStringLiteral("cachedUsers"), stats.cachedUsers},
+                                       {QStringLiteral("knownIdentities"), stats.knownIdentities},
+                                       {QStringLiteral("recordHits"), stats.recordHits},
+                                       {QStringLiteral("recordMisses"), stats.recordMisses},
+                                       {QStringLiteral("recordHitRate"), lookups > 0 ? double(stats.recordHits) / lookups : 0.0},
+                                       {QStringLiteral("existenceChecks"), stats.existenceChecks},
+                                       {QStringLiteral("bloomRejects"), stats.bloomRejects},
+                                       {QStringLiteral("existenceFallbacks"), stats.existenceFallbacks}});
+        }
+        if (kdfPool_) {
+            const KdfWorkerPool::Metrics kdf = kdfPool_->metrics();
+            payload.insert(QStringLiteral("kdf"), QJsonObject{{QStringLiteral("threads"), kdf.threadCount},
+                                                              {QStringLiteral("maxQueueDepth"), kdf.maxQueueDepth},
+                                                              {QStringLiteral("inFlight"), kdf.inFlight},
+                                                              {QStringLiteral("peakInFlight"), kdf.peakInFlight},
+                                                              {QStringLiteral("completed"), kdf.completed},
+                                                              {QStringLiteral("rejected"), kdf.rejected},
+                                                              {QStringLiteral("averageWaitMs"), kdf.averageWaitMs},
+                                                              {QStringLiteral("averageRunMs"), kdf.averageRunMs}});
+        }
+
         return common::Message::makeSuccess(common::Command::AdminStatsResult,
                                             payload,
                                             {},
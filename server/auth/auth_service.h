@@ -6,29 +6,49 @@
 #include "../security/password_hasher.h"
 #include <QJsonObject>
 
+#include <functional>
+
 class AdRepository;
 class WalletRepository;
 class CaptchaService;
+class KdfWorkerPool;
 
 class AuthService
 {
 public:
+    using Completion = std::function<void(common::Message)>;
+
+    // Without a KDF pool, password hashing runs inline and completions are
+    // invoked before the call returns.
     explicit AuthService(UserRepository& repo,
                          CaptchaService& captchaService,
                          AdRepository* adRepository = nullptr,
-                         WalletRepository* walletRepository = nullptr);
+                         WalletRepository* walletRepository = nullptr,
+                         KdfWorkerPool* kdfPool = nullptr);
 
-    common::Message login(const QJsonObject& payload);
-    common::Message signup(const QJsonObject& payload);
-    common::Message updateProfile(const QJsonObject& payload);
+    void login(const QJsonObject& payload, Completion done);
+    void signup(const QJsonObject& payload, Completion done);
+    void updateProfile(const QJsonObject& payload, Completion done);
     common::Message profileHistory(const QJsonObject& payload);
     common::Message adminStats(const QJsonObject& payload);
 
 private:
+    bool verifyPassword(const QString& password,
+                        const QString& storedHash,
+                        std::function<void(bool, QString)> done);
+    void upgradePasswordHash(const User& user, const QString& upgradedHash);
+    bool hashPassword(const QString& password, std::function<void(QString)> done);
+    common::Message finishProfileUpdate(const QString& currentUsername,
+                                        const User& profile,
+                                        const QString& expectedPasswordHash = {},
+                                        const QString& newPasswordHash = {});
+    static common::Message busyResponse(common::Command command);
+
     UserRepository& repo_;
     AdRepository* adRepository_;
     CaptchaService& captchaService_;
     WalletRepository* walletRepository_;
+    KdfWorkerPool* kdfPool_;
 };
 
 #endif // AUTH_SERVICE_H
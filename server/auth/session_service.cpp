@@ -1,7 +1,34 @@
 #include "session_service.h"
 
-#include <QUuid>
+#include "../logging_audit_logger.h"
+#include "../security/signed_token_codec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+#include <QDateTime>
 #include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+SessionService::SessionService(int idleTimeoutSecs,
+                               int absoluteTimeoutSecs,
+                               SignedTokenCodec* tokenCodec,
+                               SessionRepository* repository)
+    : idleTimeoutSecs_(qMax(1, idleTimeoutSecs)),
+      absoluteTimeoutSecs_(qMax(1, absoluteTimeoutSecs)),
+      tokenCodec_(tokenCodec && tokenCodec->isEnabled() ? tokenCodec : nullptr),
+      repository_(repository)
+{
+    clock_.start();
+    startedAtSecs_ = QDateTime::currentSecsSinceEpoch();
+    if (repository_) {
+        repository_->purgeCreatedBefore(startedAtSecs_ - absoluteTimeoutSecs_);
+        const QVector<QString> hashes = repository_->listTokenHashes();
+        unloadedTokenHashes_ = QSet<QString>(hashes.cbegin(), hashes.cend());
+    }
+}
 
 QString SessionService::createSession(const QString& username, const QString& role)
 {
@@ -10,87 +37,447 @@ QString SessionService::createSession(const QString& username, const QString& ro
         return {};
     }
 
-    const QString token = QUuid::createUuid().toString(QUuid::WithoutBraces);
-    QMutexLocker locker(&mutex_);
-    sessionsByToken_.insert(token, SessionInfo{normalizedUsername, role.trimmed()});
-    return token;
+    const qint64 now = nowSecs();
+    if (tokenCodec_) {
+        const qint64 issuedAt = SignedTokenCodec::currentSecs();
+        return issueSignedSession(normalizedUsername, role.trimmed(), issuedAt, issuedAt + absoluteTimeoutSecs_, now);
+    }
+
+    const QUuid key = QUuid::createUuid();
+    track(key, SessionEntry{SessionInfo{normalizedUsername, role.trimmed()}, now, now, {}});
+    return key.toString(QUuid::WithoutBraces);
 }
 
-bool SessionService::validateSession(const QString& token, SessionInfo* outSession) const
+bool SessionService::validateSession(const QString& token, SessionInfo* outSession)
 {
-    const QString normalizedToken = token.trimmed();
-    if (normalizedToken.isEmpty()) {
+    if (SignedTokenCodec::isSignedToken(token)) {
+        if (!tokenCodec_) {
+            return false;
+        }
+        const auto claims = tokenCodec_->verify(QStringView(token).trimmed(), SignedTokenCodec::currentSecs());
+        if (!claims || tokenCodec_->isRevoked(claims->tokenId)) {
+            return false;
+        }
+        if (outSession) {
+            *outSession = SessionInfo{claims->username, claims->role};
+        }
+        return true;
+    }
+
+    const QUuid key = parseToken(token);
+    if (key.isNull()) {
         return false;
     }
 
-    QMutexLocker locker(&mutex_);
-    const auto it = sessionsByToken_.constFind(normalizedToken);
-    if (it == sessionsByToken_.constEnd()) {
+    const qint64 now = nowSecs();
+    const Shard& shard = shardFor(key);
+    QReadLocker locker(&shard.lock);
+    const auto it = shard.sessions.constFind(key);
+    if (it == shard.sessions.constEnd()) {
+        locker.unlock();
+        return repository_ && loadSession(key, outSession);
+    }
+
+    const SessionEntry& entry = it.value();
+    std::atomic_ref<qint64> lastSeen(entry.lastSeen);
+    const qint64 seen = lastSeen.load(std::memory_order_relaxed);
+    if (std::min(seen + idleTimeoutSecs_, entry.createdAt + absoluteTimeoutSecs_) <= now) {
         return false;
     }
+    if (seen != now) {
+        lastSeen.store(now, std::memory_order_relaxed);
+    }
 
     if (outSession) {
-        *outSession = it.value();
+        *outSession = entry.info;
     }
     return true;
 }
 
 bool SessionService::invalidateSession(const QString& token)
 {
-    const QString normalizedToken = token.trimmed();
-    if (normalizedToken.isEmpty()) {
-        return false;
+    if (SignedTokenCodec::isSignedToken(token)) {
+        if (!tokenCodec_) {
+            return false;
+        }
+        const auto claims = tokenCodec_->verify(QStringView(token).trimmed(), SignedTokenCodec::currentSecs());
+        if (!claims) {
+            return false;
+        }
+        tokenCodec_->revoke(claims->tokenId, claims->expiresAt);
+        untrack(claims->tokenId);
+        return true;
     }
 
-    QMutexLocker locker(&mutex_);
-    return sessionsByToken_.remove(normalizedToken) > 0;
+    const QUuid key = parseToken(token);
+    return !key.isNull() && untrack(key).has_value();
 }
 
 QString SessionService::refreshSession(const QString& token)
 {
-    const QString normalizedToken = token.trimmed();
-    if (normalizedToken.isEmpty()) {
+    const qint64 now = nowSecs();
+
+    if (SignedTokenCodec::isSignedToken(token)) {
+        if (!tokenCodec_) {
+            return {};
+        }
+        const qint64 wallNow = SignedTokenCodec::currentSecs();
+        const auto claims = tokenCodec_->verify(QStringView(token).trimmed(), wallNow);
+        if (!claims || tokenCodec_->isRevoked(claims->tokenId)) {
+            return {};
+        }
+
+        tokenCodec_->revoke(claims->tokenId, claims->expiresAt);
+        const auto previous = untrack(claims->tokenId);
+        const qint64 createdAt = previous ? previous->createdAt : now - (wallNow - claims->issuedAt);
+        return issueSignedSession(claims->username, claims->role, claims->issuedAt, claims->expiresAt, createdAt);
+    }
+
+    const QUuid key = parseToken(token);
+    if (key.isNull()) {
         return {};
     }
 
-    QMutexLocker locker(&mutex_);
-    const auto it = sessionsByToken_.find(normalizedToken);
-    if (it == sessionsByToken_.end()) {
+    std::optional<SessionEntry> entry = untrack(key);
+    if (!entry) {
         return {};
     }
 
-    const SessionInfo session = it.value();
-    sessionsByToken_.erase(it);
+    // A refreshed token keeps the original login time, so the absolute TTL still applies.
+    entry->lastSeen = now;
+    if (deadlineFor(*entry) <= now) {
+        return {};
+    }
 
-    const QString newToken = QUuid::createUuid().toString(QUuid::WithoutBraces);
-    sessionsByToken_.insert(newToken, session);
-    return newToken;
+    const QUuid newKey = QUuid::createUuid();
+    track(newKey, std::move(*entry));
+    return newKey.toString(QUuid::WithoutBraces);
 }
 
-bool SessionService::updateSessionUsername(const QString& token, const QString& newUsername)
+QString SessionService::updateSessionUsername(const QString& token, const QString& newUsername)
 {
-    const QString normalizedToken = token.trimmed();
     const QString normalizedUsername = newUsername.trimmed();
-    if (normalizedToken.isEmpty() || normalizedUsername.isEmpty()) {
-        return false;
+    if (normalizedUsername.isEmpty()) {
+        return {};
     }
 
-    QMutexLocker locker(&mutex_);
-    const auto it = sessionsByToken_.find(normalizedToken);
-    if (it == sessionsByToken_.end()) {
-        return false;
+    if (SignedTokenCodec::isSignedToken(token)) {
+        if (!tokenCodec_) {
+            return {};
+        }
+        const qint64 wallNow = SignedTokenCodec::currentSecs();
+        const auto claims = tokenCodec_->verify(QStringView(token).trimmed(), wallNow);
+        if (!claims || tokenCodec_->isRevoked(claims->tokenId)) {
+            return {};
+        }
+
+        tokenCodec_->revoke(claims->tokenId, claims->expiresAt);
+        const auto previous = untrack(claims->tokenId);
+        const qint64 createdAt = previous ? previous->createdAt : nowSecs() - (wallNow - claims->issuedAt);
+        return issueSignedSession(normalizedUsername, claims->role, claims->issuedAt, claims->expiresAt, createdAt);
     }
 
-    it->username = normalizedUsername;
-    return true;
+    const QUuid key = parseToken(token);
+    if (key.isNull()) {
+        return {};
+    }
+
+    QString previousUsername;
+    {
+        Shard& shard = shardFor(key);
+        QWriteLocker locker(&shard.lock);
+        const auto it = shard.sessions.find(key);
+        if (it == shard.sessions.end()) {
+            return {};
+        }
+        previousUsername = it->info.username;
+        it->info.username = normalizedUsername;
+        enqueueUpsert(key, it.value());
+    }
+
+    if (previousUsername != normalizedUsername) {
+        indexRemove(previousUsername, key);
+        indexInsert(normalizedUsername, key);
+    }
+    return key.toString(QUuid::WithoutBraces);
 }
 
 QSet<QString> SessionService::activeUsernames() const
 {
-    QMutexLocker locker(&mutex_);
+    QReadLocker locker(&indexLock_);
     QSet<QString> usernames;
-    for (auto it = sessionsByToken_.cbegin(); it != sessionsByToken_.cend(); ++it) {
-        usernames.insert(it.value().username);
+    usernames.reserve(tokensByUsername_.size());
+    for (auto it = tokensByUsername_.cbegin(); it != tokensByUsername_.cend(); ++it) {
+        usernames.insert(it.key());
     }
     return usernames;
 }
+
+QList<SessionService::ExpiredSession> SessionService::expireSessions()
+{
+    const qint64 now = nowSecs();
+    QList<QUuid> due;
+    {
+        QMutexLocker locker(&wheelMutex_);
+        due = wheel_.advance(static_cast<quint64>(now));
+    }
+
+    QList<ExpiredSession> expired;
+    for (const QUuid& key : std::as_const(due)) {
+        SessionEntry entry;
+        {
+            Shard& shard = shardFor(key);
+            QWriteLocker locker(&shard.lock);
+            const auto it = shard.sessions.find(key);
+            if (it == shard.sessions.end()) {
+                continue;
+            }
+
+            const qint64 deadline = deadlineFor(it.value());
+            if (deadline > now) {
+                QMutexLocker wheelLocker(&wheelMutex_);
+                wheel_.schedule(key, static_cast<quint64>(deadline));
+                continue;
+            }
+
+            entry = std::move(it.value());
+            shard.sessions.erase(it);
+        }
+
+        indexRemove(entry.info.username, key);
+        if (entry.signedToken.isEmpty()) {
+            enqueueDelete(key);
+        }
+        expired.append(ExpiredSession{entry.signedToken.isEmpty() ? key.toString(QUuid::WithoutBraces)
+                                                                  : entry.signedToken,
+                                      entry.info.username});
+    }
+    return expired;
+}
+
+int SessionService::flushPendingWrites()
+{
+    if (!repository_) {
+        return 0;
+    }
+
+    QHash<QUuid, SessionRepository::SessionWrite> pending;
+    {
+        QMutexLocker locker(&pendingMutex_);
+        pending.swap(pendingWrites_);
+    }
+    if (pending.isEmpty()) {
+        return 0;
+    }
+
+    QVector<SessionRepository::SessionWrite> writes;
+    writes.reserve(pending.size());
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+        writes.append(it.value());
+    }
+
+    try {
+        repository_->applyWrites(writes);
+    } catch (const std::exception& ex) {
+        AuditLogger::log(QStringLiteral("session.persist"), QStringLiteral("failed"),
+                         QJsonObject{{QStringLiteral("writes"), static_cast<int>(writes.size())},
+                                     {QStringLiteral("error"), QString::fromUtf8(ex.what())}});
+        QMutexLocker locker(&pendingMutex_);
+        for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+            if (!pendingWrites_.contains(it.key())) {
+                pendingWrites_.insert(it.key(), it.value());
+            }
+        }
+        return 0;
+    }
+    return static_cast<int>(writes.size());
+}
+
+QUuid SessionService::parseToken(const QString& token)
+{
+    return QUuid::fromString(QStringView(token).trimmed());
+}
+
+qint64 SessionService::nowSecs() const
+{
+    return clock_.elapsed() / 1000;
+}
+
+qint64 SessionService::deadlineFor(const SessionEntry& entry) const
+{
+    if (!entry.signedToken.isEmpty()) {
+        return entry.createdAt + absoluteTimeoutSecs_;
+    }
+    return std::min(entry.lastSeen + idleTimeoutSecs_, entry.createdAt + absoluteTimeoutSecs_);
+}
+
+void SessionService::track(const QUuid& key, SessionEntry entry, bool persist)
+{
+    const QString username = entry.info.username;
+    const qint64 deadline = deadlineFor(entry);
+    if (persist) {
+        enqueueUpsert(key, entry);
+    }
+    {
+        Shard& shard = shardFor(key);
+        QWriteLocker locker(&shard.lock);
+        shard.sessions.insert(key, std::move(entry));
+    }
+    {
+        QMutexLocker locker(&wheelMutex_);
+        wheel_.schedule(key, static_cast<quint64>(qMax<qint64>(0, deadline)));
+    }
+    indexInsert(username, key);
+}
+
+std::optional<SessionService::SessionEntry> SessionService::untrack(const QUuid& key)
+{
+    SessionEntry entry;
+    {
+        Shard& shard = shardFor(key);
+        QWriteLocker locker(&shard.lock);
+        const auto it = shard.sessions.find(key);
+        if (it == shard.sessions.end()) {
+            return std::nullopt;
+        }
+        entry = std::move(it.value());
+        shard.sessions.erase(it);
+    }
+    {
+        QMutexLocker locker(&wheelMutex_);
+        wheel_.cancel(key);
+    }
+    indexRemove(entry.info.username, key);
+    if (entry.signedToken.isEmpty()) {
+        enqueueDelete(key);
+    }
+    return entry;
+}
+
+// Startup path: a token the table has not seen yet may belong to a session
+// created before the last restart. Downtime does not count against the idle
+// TTL, but the absolute TTL from the original login still applies.
+bool SessionService::loadSession(const QUuid& key, SessionInfo* outSession)
+{
+    {
+        QMutexLocker locker(&pendingMutex_);
+        const auto pending = pendingWrites_.constFind(key);
+        if (pending != pendingWrites_.constEnd() && pending->remove) {
+            return false;
+        }
+    }
+
+    const QString tokenHash = SessionRepository::hashToken(key.toString(QUuid::WithoutBraces));
+    {
+        QMutexLocker locker(&unloadedMutex_);
+        if (!unloadedTokenHashes_.contains(tokenHash)) {
+            return false;
+        }
+    }
+
+    std::optional<SessionRepository::SessionRecord> record;
+    try {
+        record = repository_->findSession(tokenHash);
+    } catch (const std::exception& ex) {
+        AuditLogger::log(QStringLiteral("session.load"), QStringLiteral("failed"),
+                         QJsonObject{{QStringLiteral("error"), QString::fromUtf8(ex.what())}});
+        return false;
+    }
+
+    // Whatever the outcome, the session now lives in memory or nowhere.
+    {
+        QMutexLocker locker(&unloadedMutex_);
+        unloadedTokenHashes_.remove(tokenHash);
+    }
+    if (!record || record->username.isEmpty()) {
+        return false;
+    }
+
+    const qint64 now = nowSecs();
+    SessionEntry entry{SessionInfo{record->username, record->role}, record->createdAt - startedAtSecs_, now, {}};
+    if (deadlineFor(entry) <= now) {
+        enqueueDelete(key);
+        return false;
+    }
+
+    if (outSession) {
+        *outSession = entry.info;
+    }
+    track(key, std::move(entry), false);
+    return true;
+}
+
+void SessionService::enqueueUpsert(const QUuid& key, const SessionEntry& entry)
+{
+    if (!repository_ || !entry.signedToken.isEmpty()) {
+        return;
+    }
+
+    SessionRepository::SessionWrite write;
+    write.record.tokenHash = SessionRepository::hashToken(key.toString(QUuid::WithoutBraces));
+    write.record.username = entry.info.username;
+    write.record.role = entry.info.role;
+    write.record.createdAt = startedAtSecs_ + entry.createdAt;
+
+    QMutexLocker locker(&pendingMutex_);
+    pendingWrites_.insert(key, write);
+}
+
+void SessionService::enqueueDelete(const QUuid& key)
+{
+    if (!repository_) {
+        return;
+    }
+
+    SessionRepository::SessionWrite write;
+    write.record.tokenHash = SessionRepository::hashToken(key.toString(QUuid::WithoutBraces));
+    write.remove = true;
+
+    QMutexLocker locker(&pendingMutex_);
+    pendingWrites_.insert(key, write);
+}
+
+QString SessionService::issueSignedSession(const QString& username,
+                                           const QString& role,
+                                           qint64 issuedAt,
+                                           qint64 expiresAt,
+                                           qint64 createdAt)
+{
+    const QUuid key = QUuid::createUuid();
+    const QString token = tokenCodec_->issue(username, role, key, issuedAt, expiresAt);
+    if (token.isEmpty()) {
+        return {};
+    }
+
+    track(key, SessionEntry{SessionInfo{username, role}, createdAt, createdAt, token});
+    return token;
+}
+
+SessionService::Shard& SessionService::shardFor(const QUuid& key)
+{
+    return shards_[key.data1 % kShardCount];
+}
+
+const SessionService::Shard& SessionService::shardFor(const QUuid& key) const
+{
+    return shards_[key.data1 % kShardCount];
+}
+
+void SessionService::indexInsert(const QString& username, const QUuid& key)
+{
+    QWriteLocker locker(&indexLock_);
+    tokensByUsername_[username].insert(key);
+}
+
+void SessionService::indexRemove(const QString& username, const QUuid& key)
+{
+    QWriteLocker locker(&indexLock_);
+    const auto it = tokensByUsername_.find(username);
+    if (it == tokensByUsername_.end()) {
+        return;
+    }
+    it->remove(key);
+    if (it->isEmpty()) {
+        tokensByUsername_.erase(it);
+    }
+}
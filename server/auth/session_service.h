@@ -1,29 +1,131 @@
 #ifndef KALANET_SESSION_SERVICE_H
 #define KALANET_SESSION_SERVICE_H
 
+#include <array>
+#include <optional>
+
 #include <QString>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QList>
 #include <QMutex>
+#include <QReadWriteLock>
 #include <QSet>
+#include <QUuid>
+
+#include "timing_wheel.h"
+#include "../repository/session_repository.h"
+
+class SignedTokenCodec;
 
 class SessionService
 {
 public:
+    static constexpr int kDefaultIdleTimeoutSecs = 30 * 60;
+    static constexpr int kDefaultAbsoluteTimeoutSecs = 12 * 60 * 60;
+
     struct SessionInfo {
         QString username;
         QString role;
     };
 
+    struct ExpiredSession {
+        QString token;
+        QString username;
+    };
+
+    // With a token codec, new sessions get signed tokens that validate without
+    // a table lookup; the table is then only kept for expiry and admin views.
+    // With a repository, UUID sessions are persisted write-behind and loaded
+    // lazily on first use, so they survive restarts.
+    explicit SessionService(int idleTimeoutSecs = kDefaultIdleTimeoutSecs,
+                            int absoluteTimeoutSecs = kDefaultAbsoluteTimeoutSecs,
+                            SignedTokenCodec* tokenCodec = nullptr,
+                            SessionRepository* repository = nullptr);
+
     QString createSession(const QString& username, const QString& role);
-    bool validateSession(const QString& token, SessionInfo* outSession = nullptr) const;
+    bool validateSession(const QString& token, SessionInfo* outSession = nullptr);
     bool invalidateSession(const QString& token);
     QString refreshSession(const QString& token);
-    bool updateSessionUsername(const QString& token, const QString& newUsername);
+    // Returns the token to use from now on (signed tokens embed the username
+    // and are reissued), or an empty string on failure.
+    QString updateSessionUsername(const QString& token, const QString& newUsername);
     QSet<QString> activeUsernames() const;
 
+    // Advances the expiry wheel to the current second and drops sessions whose
+    // idle or absolute TTL has elapsed. Call periodically (about once a second).
+    QList<ExpiredSession> expireSessions();
+
+    // Writes queued creates, renames and deletes in one transaction. Only the
+    // latest change per session is kept between flushes. Returns rows written.
+    int flushPendingWrites();
+
 private:
-    mutable QMutex mutex_;
-    QHash<QString, SessionInfo> sessionsByToken_;
+    static constexpr int kShardCount = 16;
+
+    struct SessionEntry {
+        SessionInfo info;
+        qint64 createdAt = 0;
+        // Sliding renewal: bumped with a relaxed atomic store under the shared
+        // lock. The wheel keeps the original deadline and re-arms lazily.
+        mutable qint64 lastSeen = 0;
+        // Set for signed sessions, which only carry an absolute expiry.
+        QString signedToken;
+    };
+
+    // Keys are random UUIDs (or signed-token ids), so the low bits spread
+    // sessions evenly. Each shard sits on its own cache line; readers only
+    // take a shared lock.
+    struct alignas(64) Shard {
+        mutable QReadWriteLock lock;
+        QHash<QUuid, SessionEntry> sessions;
+    };
+
+    static QUuid parseToken(const QString& token);
+    qint64 nowSecs() const;
+    qint64 deadlineFor(const SessionEntry& entry) const;
+    Shard& shardFor(const QUuid& key);
+    const Shard& shardFor(const QUuid& key) const;
+
+    void track(const QUuid& key, SessionEntry entry, bool persist = true);
+    std::optional<SessionEntry> untrack(const QUuid& key);
+    QString issueSignedSession(const QString& username,
+                               const QString& role,
+                               qint64 issuedAt,
+                               qint64 expiresAt,
+                               qint64 createdAt);
+
+    bool loadSession(const QUuid& key, SessionInfo* outSession);
+    void enqueueUpsert(const QUuid& key, const SessionEntry& entry);
+    void enqueueDelete(const QUuid& key);
+
+    void indexInsert(const QString& username, const QUuid& key);
+    void indexRemove(const QString& username, const QUuid& key);
+
+    const qint64 idleTimeoutSecs_;
+    const qint64 absoluteTimeoutSecs_;
+    QElapsedTimer clock_;
+    SignedTokenCodec* tokenCodec_;
+    SessionRepository* repository_;
+    qint64 startedAtSecs_ = 0;
+
+    std::array<Shard, kShardCount> shards_;
+
+    // Lock order is shard, then wheel.
+    QMutex wheelMutex_;
+    TimingWheel wheel_;
+
+    QMutex pendingMutex_;
+    QHash<QUuid, SessionRepository::SessionWrite> pendingWrites_;
+
+    // Hashes of sessions persisted before startup and not loaded yet. Only
+    // these tokens are looked up in the table, so unknown tokens cost no read.
+    QMutex unloadedMutex_;
+    QSet<QString> unloadedTokenHashes_;
+
+    // Secondary index: username -> tokens. Lock order is shard, then index.
+    mutable QReadWriteLock indexLock_;
+    QHash<QString, QSet<QUuid>> tokensByUsername_;
 };
 
 #endif // KALANET_SESSION_SERVICE_H
@@ -0,0 +1,146 @@
+#include "timing_wheel.h"
+
+TimingWheel::TimingWheel(quint64 currentTick)
+    : currentTick_(currentTick)
+{
+    for (auto& level : heads_) {
+        level.fill(-1);
+    }
+}
+
+void TimingWheel::schedule(const QUuid& key, quint64 deadlineTick)
+{
+    int node = -1;
+    const auto it = index_.constFind(key);
+    if (it != index_.constEnd()) {
+        node = it.value();
+        unlink(node);
+    } else {
+        node = allocateNode();
+        nodes_[node].key = key;
+        index_.insert(key, node);
+    }
+
+    nodes_[node].deadline = deadlineTick;
+    place(node, currentTick_ + 1);
+}
+
+bool TimingWheel::cancel(const QUuid& key)
+{
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+        return false;
+    }
+
+    const int node = it.value();
+    index_.erase(it);
+    unlink(node);
+    releaseNode(node);
+    return true;
+}
+
+QList<QUuid> TimingWheel::advance(quint64 nowTick)
+{
+    QList<QUuid> expired;
+    while (currentTick_ < nowTick) {
+        ++currentTick_;
+
+        for (int level = 1; level < kLevels && ((currentTick_ >> ((level - 1) * kSlotBits)) & kSlotMask) == 0; ++level) {
+            if (!cascade(level)) {
+                break;
+            }
+        }
+
+        const int slot = static_cast<int>(currentTick_ & kSlotMask);
+        int node = heads_[0][slot];
+        heads_[0][slot] = -1;
+        while (node >= 0) {
+            const int next = nodes_[node].next;
+            expired.append(nodes_[node].key);
+            index_.remove(nodes_[node].key);
+            releaseNode(node);
+            node = next;
+        }
+    }
+    return expired;
+}
+
+int TimingWheel::allocateNode()
+{
+    if (!freeNodes_.empty()) {
+        const int node = freeNodes_.back();
+        freeNodes_.pop_back();
+        return node;
+    }
+    nodes_.emplace_back();
+    return static_cast<int>(nodes_.size()) - 1;
+}
+
+void TimingWheel::releaseNode(int node)
+{
+    nodes_[node] = Node{};
+    freeNodes_.push_back(node);
+}
+
+void TimingWheel::place(int node, quint64 earliestTick)
+{
+    constexpr quint64 kHorizon = quint64{1} << (kLevels * kSlotBits);
+
+    quint64 due = nodes_[node].deadline;
+    if (due < earliestTick) {
+        due = earliestTick;
+    }
+    if (due - currentTick_ >= kHorizon) {
+        due = currentTick_ + kHorizon - 1;
+    }
+
+    const quint64 delta = due - currentTick_;
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (quint64{1} << ((level + 1) * kSlotBits))) {
+        ++level;
+    }
+    link(node, level, static_cast<int>((due >> (level * kSlotBits)) & kSlotMask));
+}
+
+void TimingWheel::link(int node, int level, int slot)
+{
+    Node& entry = nodes_[node];
+    entry.level = level;
+    entry.slot = slot;
+    entry.prev = -1;
+    entry.next = heads_[level][slot];
+    if (entry.next >= 0) {
+        nodes_[entry.next].prev = node;
+    }
+    heads_[level][slot] = node;
+}
+
+void TimingWheel::unlink(int node)
+{
+    Node& entry = nodes_[node];
+    if (entry.prev >= 0) {
+        nodes_[entry.prev].next = entry.next;
+    } else {
+        heads_[entry.level][entry.slot] = entry.next;
+    }
+    if (entry.next >= 0) {
+        nodes_[entry.next].prev = entry.prev;
+    }
+    entry.prev = -1;
+    entry.next = -1;
+}
+
+// Re-files the current slot of a higher level into finer levels. Returns true
+// when this level has also wrapped, so the next level up must cascade too.
+bool TimingWheel::cascade(int level)
+{
+    const int slot = static_cast<int>((currentTick_ >> (level * kSlotBits)) & kSlotMask);
+    int node = heads_[level][slot];
+    heads_[level][slot] = -1;
+    while (node >= 0) {
+        const int next = nodes_[node].next;
+        place(node, currentTick_);
+        node = next;
+    }
+    return slot == 0;
+}
@@ -0,0 +1,58 @@
+#ifndef KALANET_TIMING_WHEEL_H
+#define KALANET_TIMING_WHEEL_H
+
+#include <array>
+#include <vector>
+
+#include <QHash>
+#include <QList>
+#include <QUuid>
+
+// Hierarchical timing wheel (Varghese & Lauck) with four levels of 64 slots.
+// Scheduling and cancelling are O(1); advancing one tick touches a single
+// level-0 slot plus, every 64 ticks, one cascading slot per higher level.
+// Deadlines beyond 64^4 ticks keep their real value: they sit in a top-level
+// slot, are re-placed each time that slot cascades, and fire on time once
+// they come within range.
+class TimingWheel
+{
+public:
+    explicit TimingWheel(quint64 currentTick = 0);
+
+    void schedule(const QUuid& key, quint64 deadlineTick);
+    bool cancel(const QUuid& key);
+    QList<QUuid> advance(quint64 nowTick);
+
+    quint64 currentTick() const noexcept { return currentTick_; }
+    qsizetype size() const { return index_.size(); }
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr quint64 kSlotMask = kSlots - 1;
+
+    struct Node {
+        QUuid key;
+        quint64 deadline = 0;
+        int prev = -1;
+        int next = -1;
+        int level = 0;
+        int slot = 0;
+    };
+
+    int allocateNode();
+    void releaseNode(int node);
+    void place(int node, quint64 earliestTick);
+    void link(int node, int level, int slot);
+    void unlink(int node);
+    bool cascade(int level);
+
+    quint64 currentTick_;
+    std::vector<Node> nodes_;
+    std::vector<int> freeNodes_;
+    std::array<std::array<int, kSlots>, kLevels> heads_;
+    QHash<QUuid, int> index_;
+};
+
+#endif // KALANET_TIMING_WHEEL_H
@@ -159,26 +159,19 @@ common::Message CartService::list(const QJsonObject& payload)
         QJsonArray adIdArray;
         QJsonArray validItemsArray;
 
-        for (const int adId : adIds) {
-            const auto ad = adRepository_.findAdById(adId);
-            if (!ad.has_value()) {
-                continue;
-            }
-
-            const QString status = ad->status.trimmed().toLower();
-            if (status != QStringLiteral("approved")) {
-                continue;
-            }
-
-            adIdArray.append(adId);
+        // Sold or withdrawn ads drop out of the approved-only lookup.
+        const QVector<AdRepository::AdDetailRecord> ads =
+            adRepository_.findAdsByIds(adIds, AdRepository::AdFieldSet::Summary, true);
+        for (const auto& ad : ads) {
+            adIdArray.append(ad.id);
 
             QJsonObject adJson;
-            adJson.insert(QStringLiteral("adId"), ad->id);
-            adJson.insert(QStringLiteral("title"), ad->title);
-            adJson.insert(QStringLiteral("category"), ad->category);
-            adJson.insert(QStringLiteral("priceTokens"), ad->priceTokens);
-            adJson.insert(QStringLiteral("sellerUsername"), ad->sellerUsername);
-            adJson.insert(QStringLiteral("status"), ad->status);
+            adJson.insert(QStringLiteral("adId"), ad.id);
+            adJson.insert(QStringLiteral("title"), ad.title);
+            adJson.insert(QStringLiteral("category"), ad.category);
+            adJson.insert(QStringLiteral("priceTokens"), ad.priceTokens);
+            adJson.insert(QStringLiteral("sellerUsername"), ad.sellerUsername);
+            adJson.insert(QStringLiteral("status"), ad.status);
             validItemsArray.append(adJson);
         }
 
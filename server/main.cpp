@@ -1,18 +1,27 @@
 #include <QApplication>
 #include <QMessageBox>
+#include <QTimer>
 
 #include "network/tcp_server.h"
 #include "protocol/request_dispatcher.h"
 #include "auth/auth_service.h"
 #include "auth/session_service.h"
 #include "ads/ad_service.h"
+#include "ads/ad_upload_service.h"
+#include "ads/catalog_index.h"
+#include "ads/catalog_version.h"
+#include "ads/thumbnail_pipeline.h"
 #include "cart/cart_service.h"
 #include "wallet/wallet_service.h"
 #include "security/captcha_service.h"
+#include "security/kdf_worker_pool.h"
+#include "security/signed_token_codec.h"
 #include "repository/sqlite_user_repository.h"
+#include "repository/caching_user_repository.h"
 #include "repository/sqlite_ad_repository.h"
 #include "repository/sqlite_cart_repository.h"
 #include "repository/sqlite_wallet_repository.h"
+#include "repository/sqlite_session_repository.h"
 #include "ui/server_console_window.h"
 
 int main(int argc, char *argv[])
@@ -21,26 +30,59 @@ int main(int argc, char *argv[])
 
     static constexpr quint16 kDefaultServerPort = 8080;
 
+    CatalogVersion catalogVersion;
     SqliteUserRepository userRepo("kalanet.db");
-    SqliteAdRepository adRepo("kalanet.db");
+    CachingUserRepository userCache(userRepo);
+    SqliteAdRepository adRepo("kalanet.db", &catalogVersion);
     SqliteCartRepository cartRepo("kalanet.db");
-    SqliteWalletRepository walletRepo("kalanet.db");
-    SessionService sessionService;
+    SqliteWalletRepository walletRepo("kalanet.db", &catalogVersion);
+    CatalogIndex catalogIndex;
+    catalogVersion.setListener(&catalogIndex);
+    catalogIndex.load(adRepo);
+    // Setting KALANET_SESSION_SECRET switches to signed session tokens; every
+    // server process sharing the secret can then validate them.
+    SignedTokenCodec tokenCodec(qgetenv("KALANET_SESSION_SECRET"));
+    SqliteSessionRepository sessionRepo("kalanet.db");
+    SessionService sessionService(SessionService::kDefaultIdleTimeoutSecs,
+                                  SessionService::kDefaultAbsoluteTimeoutSecs,
+                                  &tokenCodec,
+                                  &sessionRepo);
     ServerConsoleWindow console(adRepo, walletRepo, userRepo, sessionService);
     console.show();
 
     CaptchaService captchaService;
-    AuthService authService(userRepo, captchaService, &adRepo, &walletRepo);
-    AdService adService(adRepo);
+    KdfWorkerPool kdfPool;
+    AuthService authService(userCache, captchaService, &adRepo, &walletRepo, &kdfPool);
+    ThumbnailPipeline thumbnailPipeline(adRepo);
+    AdService adService(adRepo, &catalogVersion, &catalogIndex, &thumbnailPipeline);
+    AdUploadService adUploadService(adService);
     CartService cartService(cartRepo, adRepo);
     WalletService walletService(walletRepo, captchaService);
-    RequestDispatcher dispatcher(authService, sessionService, adService, cartService, walletService, captchaService);
+    RequestDispatcher dispatcher(authService, sessionService, adService, adUploadService, cartService, walletService, captchaService);
 
     TcpServer server(kDefaultServerPort, dispatcher);
     dispatcher.setNotifyUserCallback([&server](const QString& username, const common::Message& message) {
         server.sendToUser(username, message);
     });
 
+    QTimer sessionExpiryTimer;
+    sessionExpiryTimer.setInterval(1000);
+    QObject::connect(&sessionExpiryTimer, &QTimer::timeout, &server, [&sessionService, &server]() {
+        const auto expired = sessionService.expireSessions();
+        for (const auto& session : expired) {
+            server.expireSession(session.username, session.token);
+        }
+    });
+    sessionExpiryTimer.start();
+
+    static constexpr int kSessionFlushIntervalMs = 250;
+    QTimer sessionFlushTimer;
+    sessionFlushTimer.setInterval(kSessionFlushIntervalMs);
+    QObject::connect(&sessionFlushTimer, &QTimer::timeout, &sessionFlushTimer, [&sessionService]() {
+        sessionService.flushPendingWrites();
+    });
+    sessionFlushTimer.start();
+
     QObject::connect(&server, &TcpServer::serverStarted,
                      &console, &ServerConsoleWindow::onServerStarted);
 
@@ -62,5 +104,6 @@ int main(int argc, char *argv[])
 
     const int exitCode = app.exec();
     server.stopListening();
+    sessionService.flushPendingWrites();
     return exitCode;
 }
@@ -1,8 +1,8 @@
 #include "client_connection.h"
 #include "../protocol/request_dispatcher.h"
 #include "protocol/message.h"
+#include "protocol/json_frame_parser.h"
 #include <QJsonDocument>
-#include <QJsonParseError>
 #include <QDataStream>
 
 ClientConnection::ClientConnection(QTcpSocket* socket,
@@ -44,6 +44,7 @@ void ClientConnection::bindAuthenticatedIdentity(const QString& username,
     authenticatedUsername_ = username.trimmed();
     authenticatedRole_ = role.trimmed();
     sessionToken_ = sessionToken.trimmed();
+    ++identityGeneration_;
     if (previousUsername != authenticatedUsername_) {
         emit authenticatedUserChanged(previousUsername, authenticatedUsername_);
     }
@@ -53,6 +54,7 @@ void ClientConnection::updateAuthenticatedUsername(const QString& username)
 {
     const QString previousUsername = authenticatedUsername_;
     authenticatedUsername_ = username.trimmed();
+    ++identityGeneration_;
     if (previousUsername != authenticatedUsername_) {
         emit authenticatedUserChanged(previousUsername, authenticatedUsername_);
     }
@@ -64,6 +66,7 @@ void ClientConnection::clearAuthenticatedIdentity()
     authenticatedUsername_.clear();
     authenticatedRole_.clear();
     sessionToken_.clear();
+    ++identityGeneration_;
     if (!previousUsername.isEmpty()) {
         emit authenticatedUserChanged(previousUsername, QString());
     }
@@ -84,6 +87,18 @@ void ClientConnection::onReadyRead()
 
             quint32 len = 0;
             in >> len;
+            if (len > kMaxFrameBytes) {
+                common::Message response = common::Message::makeFailure(
+                    common::Command::Error,
+                    common::ErrorCode::InvalidPayload,
+                    QStringLiteral("Frame exceeds the %1 byte limit").arg(kMaxFrameBytes),
+                    QJsonObject{}
+                );
+                sendResponse(common::Message(common::Command::Error), response);
+                buffer_.clear();
+                socket_->disconnectFromHost();
+                return;
+            }
             expectedSize_ = static_cast<qint32>(len);
             buffer_.remove(0, 4);
         }
@@ -95,9 +110,8 @@ void ClientConnection::onReadyRead()
         buffer_.remove(0, expectedSize_);
         expectedSize_ = -1;
 
-        QJsonParseError err;
-        QJsonDocument doc = QJsonDocument::fromJson(payload, &err);
-        if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+        const std::optional<QJsonObject> object = common::JsonFrameParser::parseObject(payload);
+        if (!object) {
             common::Message response = common::Message::makeFailure(
                 common::Command::Error,
                 common::ErrorCode::InvalidJson,
@@ -109,7 +123,7 @@ void ClientConnection::onReadyRead()
         }
 
         QString parseError;
-        auto maybeMessage = common::Message::fromJson(doc.object(), &parseError);
+        auto maybeMessage = common::Message::fromJson(*object, &parseError);
         if (!maybeMessage) {
             const QString errorText = parseError.isEmpty()
                 ? QStringLiteral("Malformed message envelope")
@@ -18,9 +18,16 @@ signals:
                                   const QString& currentUsername);
 
 public:
+    static constexpr quint32 kMaxFrameBytes = 16 * 1024 * 1024;
+
     QString authenticatedUsername() const { return authenticatedUsername_; }
     QString authenticatedRole() const { return authenticatedRole_; }
     QString sessionToken() const { return sessionToken_; }
+    QString peerAddress() const { return socket_->peerAddress().toString(); }
+    QString peerEndpoint() const { return peerAddress() + QLatin1Char(':') + QString::number(socket_->peerPort()); }
+    // Moves on every bind, update or clear below, so work that finishes later
+    // can tell whether the identity it started under is still current.
+    quint64 identityGeneration() const { return identityGeneration_; }
     void bindAuthenticatedIdentity(const QString& username,
                                    const QString& role,
                                    const QString& sessionToken);
@@ -50,6 +57,7 @@ private:
     QString authenticatedUsername_;
     QString authenticatedRole_;
     QString sessionToken_;
+    quint64 identityGeneration_ = 0;
 };
 
 #endif // CLIENT_CONNECTION_H
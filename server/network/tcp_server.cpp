@@ -88,6 +88,20 @@ void TcpServer::sendToUser(const QString& username, const common::Message& messa
     }
 }
 
+void TcpServer::expireSession(const QString& username, const QString& sessionToken)
+{
+    QSet<ClientConnection*> connections;
+    {
+        QMutexLocker locker(&connectionsMutex_);
+        connections = userConnections_.value(username.trimmed());
+    }
+    for (ClientConnection* connection : connections) {
+        if (connection && connection->sessionToken() == sessionToken) {
+            connection->clearAuthenticatedIdentity();
+        }
+    }
+}
+
 void TcpServer::handleNewConnection()
 {
     while (server_->hasPendingConnections()) {
@@ -28,6 +28,7 @@ public:
     bool isListening() const;
     quint16 port() const noexcept { return port_; }
     void sendToUser(const QString& username, const common::Message& message);
+    void expireSession(const QString& username, const QString& sessionToken);
 
 signals:
         void serverStarted(quint16 port);
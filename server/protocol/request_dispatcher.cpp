@@ -2,23 +2,36 @@
 
 #include "../network/client_connection.h"
 #include "../ads/ad_service.h"
+#include "../ads/ad_upload_service.h"
 #include "../cart/cart_service.h"
 #include "../wallet/wallet_service.h"
 #include "../security/captcha_service.h"
 #include "protocol/commands.h"
 
 #include <QJsonArray>
+#include <QJsonDocument>
+#include <QPointer>
 #include <utility>
 
+namespace {
+
+// Sub-responses stop being added past this, leaving room in the frame for the
+// BatchResult envelope.
+constexpr qsizetype kMaxBatchResponseBytes = ClientConnection::kMaxFrameBytes - 1024 * 1024;
+
+}
+
 RequestDispatcher::RequestDispatcher(AuthService& authService,
                                      SessionService& sessionService,
                                      AdService& adService,
+                                     AdUploadService& adUploadService,
                                      CartService& cartService,
                                      WalletService& walletService,
                                      CaptchaService& captchaService)
     : authService_(authService),
       sessionService_(sessionService),
       adService_(adService),
+      adUploadService_(adUploadService),
       cartService_(cartService),
       walletService_(walletService),
       captchaService_(captchaService)
@@ -36,7 +49,10 @@ std::optional<SessionService::SessionInfo> RequestDispatcher::requireSession(con
                                                                               const QString& requiredRole)
 {
     const QString token = message.sessionToken().trimmed();
-    if (token.isEmpty() || token != client.sessionToken()) {
+    // A fresh socket may present a token issued earlier: after a server restart
+    // (persisted sessions load lazily) or by another process (signed tokens).
+    const bool bindsFreshSocket = client.sessionToken().isEmpty() && !token.isEmpty();
+    if (token.isEmpty() || (token != client.sessionToken() && !bindsFreshSocket)) {
         client.sendResponse(message, common::Message::makeFailure(resultCommand,
                                                                   common::ErrorCode::AuthSessionExpired,
                                                                   QStringLiteral("Authentication required")));
@@ -45,6 +61,12 @@ std::optional<SessionService::SessionInfo> RequestDispatcher::requireSession(con
 
     SessionService::SessionInfo session;
     if (!sessionService_.validateSession(token, &session)) {
+        if (bindsFreshSocket) {
+            client.sendResponse(message, common::Message::makeFailure(resultCommand,
+                                                                      common::ErrorCode::AuthSessionExpired,
+                                                                      QStringLiteral("Session is invalid or expired")));
+            return std::nullopt;
+        }
         client.clearAuthenticatedIdentity();
         client.sendResponse(message, common::Message::makeFailure(resultCommand,
                                                                   common::ErrorCode::AuthSessionExpired,
@@ -52,6 +74,10 @@ std::optional<SessionService::SessionInfo> RequestDispatcher::requireSession(con
         return std::nullopt;
     }
 
+    if (bindsFreshSocket) {
+        client.bindAuthenticatedIdentity(session.username, session.role, token);
+    }
+
     if (session.username != client.authenticatedUsername()) {
         client.sendResponse(message, common::Message::makeFailure(resultCommand,
                                                                   common::ErrorCode::AuthSessionExpired,
@@ -69,6 +95,102 @@ std::optional<SessionService::SessionInfo> RequestDispatcher::requireSession(con
     return session;
 }
 
+bool RequestDispatcher::isBatchable(common::Command command)
+{
+    switch (command) {
+    case common::Command::ProfileHistory:
+    case common::Command::AdList:
+    case common::Command::AdDetail:
+    case common::Command::AdDetailBatch:
+    case common::Command::AdThumbnailBatch:
+    case common::Command::CategoryList:
+    case common::Command::CartList:
+    case common::Command::WalletBalance:
+    case common::Command::TransactionHistory:
+        return true;
+    default:
+        return false;
+    }
+}
+
+common::Command RequestDispatcher::batchableResultCommand(common::Command command)
+{
+    switch (command) {
+    case common::Command::ProfileHistory:
+        return common::Command::ProfileHistoryResult;
+    case common::Command::AdList:
+        return common::Command::AdListResult;
+    case common::Command::AdDetail:
+        return common::Command::AdDetailResult;
+    case common::Command::AdDetailBatch:
+        return common::Command::AdDetailBatchResult;
+    case common::Command::AdThumbnailBatch:
+        return common::Command::AdThumbnailBatchResult;
+    case common::Command::CategoryList:
+        return common::Command::CategoryListResult;
+    case common::Command::CartList:
+        return common::Command::CartListResult;
+    case common::Command::WalletBalance:
+        return common::Command::WalletBalanceResult;
+    case common::Command::TransactionHistory:
+        return common::Command::TransactionHistoryResult;
+    default:
+        return common::Command::Error;
+    }
+}
+
+common::Message RequestDispatcher::executeBatchable(const common::Message& message,
+                                                    const SessionService::SessionInfo& session)
+{
+    QJsonObject payload = message.payload();
+    const bool isAdmin = session.role.compare(QStringLiteral("Admin"), Qt::CaseInsensitive) == 0;
+
+    switch (message.command()) {
+    case common::Command::ProfileHistory:
+        payload.insert(QStringLiteral("username"), session.username);
+        return authService_.profileHistory(payload);
+    case common::Command::AdList:
+        if (isAdmin) {
+            payload.insert(QStringLiteral("allowAdminView"), true);
+        }
+        return adService_.list(payload);
+    case common::Command::AdDetail:
+        if (isAdmin) {
+            payload.insert(QStringLiteral("includeUnapproved"), true);
+            payload.insert(QStringLiteral("includeHistory"), true);
+        }
+        return adService_.detail(payload);
+    case common::Command::AdDetailBatch:
+        if (isAdmin) {
+            payload.insert(QStringLiteral("includeUnapproved"), true);
+        }
+        return adService_.detailBatch(payload);
+    case common::Command::AdThumbnailBatch:
+        if (isAdmin) {
+            payload.insert(QStringLiteral("includeUnapproved"), true);
+        }
+        return adService_.thumbnails(payload);
+    case common::Command::CategoryList:
+        if (isAdmin) {
+            payload.insert(QStringLiteral("includeUnapproved"), true);
+        }
+        return adService_.listCategories(payload);
+    case common::Command::CartList:
+        payload.insert(QStringLiteral("username"), session.username);
+        return cartService_.list(payload);
+    case common::Command::WalletBalance:
+        payload.insert(QStringLiteral("username"), session.username);
+        return walletService_.walletBalance(payload);
+    case common::Command::TransactionHistory:
+        payload.insert(QStringLiteral("username"), session.username);
+        return walletService_.transactionHistory(payload);
+    default:
+        return common::Message::makeFailure(common::Command::Error,
+                                            common::ErrorCode::UnknownCommand,
+                                            QStringLiteral("Command is not allowed in a batch"));
+    }
+}
+
 void RequestDispatcher::dispatch(const common::Message& message,
                                  ClientConnection& client)
 {
@@ -100,15 +222,33 @@ void RequestDispatcher::dispatch(const common::Message& message,
     case common::Command::AdCreate:
         handleAdCreate(message, client);
         break;
+    case common::Command::AdUploadInit:
+        handleAdUploadInit(message, client);
+        break;
+    case common::Command::AdUploadChunk:
+        handleAdUploadChunk(message, client);
+        break;
+    case common::Command::AdUploadCommit:
+        handleAdUploadCommit(message, client);
+        break;
     case common::Command::AdList:
         handleAdList(message, client);
         break;
     case common::Command::AdDetail:
         handleAdDetail(message, client);
         break;
+    case common::Command::AdDetailBatch:
+        handleAdDetailBatch(message, client);
+        break;
+    case common::Command::AdThumbnailBatch:
+        handleAdThumbnailBatch(message, client);
+        break;
     case common::Command::AdStatusUpdate:
         handleAdStatusUpdate(message, client);
         break;
+    case common::Command::CategoryList:
+        handleCategoryList(message, client);
+        break;
     case common::Command::CartAddItem:
         handleCartAddItem(message, client);
         break;
@@ -145,6 +285,9 @@ void RequestDispatcher::dispatch(const common::Message& message,
     case common::Command::TransactionHistory:
         handleTransactionHistory(message, client);
         break;
+    case common::Command::Batch:
+        handleBatch(message, client);
+        break;
     default:
         client.sendResponse(message, common::Message::makeFailure(common::Command::Error,
                                                                   common::ErrorCode::UnknownCommand,
@@ -157,50 +300,76 @@ void RequestDispatcher::dispatch(const common::Message& message,
 void RequestDispatcher::handleLogin(const common::Message& message,
                                     ClientConnection& client)
 {
-    common::Message response = authService_.login(message.payload());
-    if (response.isSuccess()) {
-        const QString username = response.payload().value(QStringLiteral("username")).toString().trimmed();
-        const QString role = response.payload().value(QStringLiteral("role")).toString().trimmed();
-        const QString token = sessionService_.createSession(username, role);
+    QPointer<ClientConnection> connection(&client);
+    const quint64 identityGeneration = client.identityGeneration();
+    authService_.login(message.payload(), [this, message, connection, identityGeneration](common::Message response) {
+        if (!connection) {
+            return;
+        }
 
-        if (username.isEmpty() || token.isEmpty()) {
+        // A logout or another login finished while the password was being
+        // checked; binding this older result would override it.
+        if (response.isSuccess() && connection->identityGeneration() != identityGeneration) {
             response = common::Message::makeFailure(common::Command::LoginResult,
-                                                    common::ErrorCode::InternalError,
-                                                    QStringLiteral("Failed to initialize authenticated session"));
-        } else {
-            QJsonObject payload = response.payload();
-            payload.insert(QStringLiteral("sessionToken"), token);
-            response.setPayload(payload);
-            response.setSessionToken(token);
-            client.bindAuthenticatedIdentity(username, role, token);
+                                                    common::ErrorCode::AuthUnauthorized,
+                                                    QStringLiteral("Sign-in was superseded on this connection"));
         }
-    }
-    client.sendResponse(message, response);
+
+        if (response.isSuccess()) {
+            const QString username = response.payload().value(QStringLiteral("username")).toString().trimmed();
+            const QString role = response.payload().value(QStringLiteral("role")).toString().trimmed();
+            const QString token = sessionService_.createSession(username, role);
+
+            if (username.isEmpty() || token.isEmpty()) {
+                response = common::Message::makeFailure(common::Command::LoginResult,
+                                                        common::ErrorCode::InternalError,
+                                                        QStringLiteral("Failed to initialize authenticated session"));
+            } else {
+                QJsonObject payload = response.payload();
+                payload.insert(QStringLiteral("sessionToken"), token);
+                response.setPayload(payload);
+                response.setSessionToken(token);
+                connection->bindAuthenticatedIdentity(username, role, token);
+            }
+        }
+        connection->sendResponse(message, response);
+    });
 }
 
 void RequestDispatcher::handleSignup(const common::Message& message,
                                      ClientConnection& client)
 {
-    common::Message response = authService_.signup(message.payload());
-    client.sendResponse(message, response);
+    QPointer<ClientConnection> connection(&client);
+    authService_.signup(message.payload(), [message, connection](const common::Message& response) {
+        if (connection) {
+            connection->sendResponse(message, response);
+        }
+    });
 }
 
 void RequestDispatcher::handleCaptchaChallenge(const common::Message& message,
                                                ClientConnection& client)
 {
     const QString scope = message.payload().value(QStringLiteral("scope")).toString().trimmed().toLower();
-    if (scope.isEmpty()) {
+    if (!CaptchaService::isKnownScope(scope)) {
         client.sendResponse(message, common::Message::makeFailure(common::Command::CaptchaChallengeResult,
                                                                   common::ErrorCode::ValidationFailed,
-                                                                  QStringLiteral("CAPTCHA scope is required")));
+                                                                  QStringLiteral("CAPTCHA scope is missing or unknown")));
         return;
     }
 
-    const auto challenge = captchaService_.createChallenge(scope);
-    const QJsonObject payload{{QStringLiteral("scope"), challenge.scope},
-                              {QStringLiteral("nonce"), challenge.nonce},
-                              {QStringLiteral("challenge"), challenge.challengeText},
-                              {QStringLiteral("expiresAt"), challenge.expiresAt.toString(Qt::ISODate)}};
+    const auto challenge = captchaService_.createChallenge(scope, client.peerAddress(), client.peerEndpoint());
+    if (!challenge.has_value()) {
+        client.sendResponse(message, common::Message::makeFailure(common::Command::CaptchaChallengeResult,
+                                                                  common::ErrorCode::ServiceBusy,
+                                                                  QStringLiteral("Too many pending CAPTCHA challenges, please retry")));
+        return;
+    }
+
+    const QJsonObject payload{{QStringLiteral("scope"), challenge->scope},
+                              {QStringLiteral("nonce"), challenge->nonce},
+                              {QStringLiteral("challenge"), challenge->challengeText},
+                              {QStringLiteral("expiresAt"), challenge->expiresAt.toString(Qt::ISODate)}};
     client.sendResponse(message, common::Message::makeSuccess(common::Command::CaptchaChallengeResult,
                                                               payload,
                                                               {},
@@ -260,15 +429,36 @@ void RequestDispatcher::handleProfileUpdate(const common::Message& message,
     QJsonObject payload = message.payload();
     payload.insert(QStringLiteral("currentUsername"), session->username);
 
-    common::Message response = authService_.updateProfile(payload);
-    if (response.isSuccess()) {
-        const QString updatedUsername = response.payload().value(QStringLiteral("username")).toString().trimmed();
-        if (!updatedUsername.isEmpty() && updatedUsername.compare(session->username, Qt::CaseInsensitive) != 0) {
-            sessionService_.updateSessionUsername(message.sessionToken(), updatedUsername);
-            client.updateAuthenticatedUsername(updatedUsername);
+    QPointer<ClientConnection> connection(&client);
+    const QString currentUsername = session->username;
+    const QString role = session->role;
+    const quint64 identityGeneration = client.identityGeneration();
+    authService_.updateProfile(payload, [this, message, connection, currentUsername, role, identityGeneration](
+                                            common::Message response) {
+        if (!connection) {
+            return;
         }
-    }
-    client.sendResponse(message, response);
+
+        if (response.isSuccess()) {
+            const QString updatedUsername = response.payload().value(QStringLiteral("username")).toString().trimmed();
+            if (!updatedUsername.isEmpty() && updatedUsername.compare(currentUsername, Qt::CaseInsensitive) != 0) {
+                const QString token = sessionService_.updateSessionUsername(message.sessionToken(), updatedUsername);
+                // Leave the socket alone when the session ended or the socket
+                // moved to another one (logout, login, refresh) while the
+                // password was hashed.
+                const bool identityCurrent = connection->identityGeneration() == identityGeneration
+                    && connection->sessionToken() == message.sessionToken().trimmed();
+                if (identityCurrent && !token.isEmpty()) {
+                    connection->bindAuthenticatedIdentity(updatedUsername, role, token);
+                    QJsonObject responsePayload = response.payload();
+                    responsePayload.insert(QStringLiteral("sessionToken"), token);
+                    response.setPayload(responsePayload);
+                    response.setSessionToken(token);
+                }
+            }
+        }
+        connection->sendResponse(message, response);
+    });
 }
 
 void RequestDispatcher::handleProfileHistory(const common::Message& message,
@@ -279,9 +469,7 @@ void RequestDispatcher::handleProfileHistory(const common::Message& message,
         return;
     }
 
-    QJsonObject payload = message.payload();
-    payload.insert(QStringLiteral("username"), session->username);
-    client.sendResponse(message, authService_.profileHistory(payload));
+    client.sendResponse(message, executeBatchable(message, *session));
 }
 
 void RequestDispatcher::handleAdminStats(const common::Message& message,
@@ -307,20 +495,54 @@ void RequestDispatcher::handleAdCreate(const common::Message& message,
     client.sendResponse(message, adService_.create(payload));
 }
 
-void RequestDispatcher::handleAdList(const common::Message& message,
-                                     ClientConnection& client)
+void RequestDispatcher::handleAdUploadInit(const common::Message& message,
+                                           ClientConnection& client)
 {
-    const auto session = requireSession(message, client, common::Command::AdListResult);
+    const auto session = requireSession(message, client, common::Command::AdUploadInitResult);
     if (!session.has_value()) {
         return;
     }
 
     QJsonObject payload = message.payload();
-    if (session->role.compare(QStringLiteral("Admin"), Qt::CaseInsensitive) == 0) {
-        payload.insert(QStringLiteral("allowAdminView"), true);
+    payload.insert(QStringLiteral("username"), session->username);
+    client.sendResponse(message, adUploadService_.init(payload));
+}
+
+void RequestDispatcher::handleAdUploadChunk(const common::Message& message,
+                                            ClientConnection& client)
+{
+    const auto session = requireSession(message, client, common::Command::AdUploadChunkResult);
+    if (!session.has_value()) {
+        return;
+    }
+
+    QJsonObject payload = message.payload();
+    payload.insert(QStringLiteral("username"), session->username);
+    client.sendResponse(message, adUploadService_.appendChunk(payload));
+}
+
+void RequestDispatcher::handleAdUploadCommit(const common::Message& message,
+                                             ClientConnection& client)
+{
+    const auto session = requireSession(message, client, common::Command::AdCreateResult);
+    if (!session.has_value()) {
+        return;
     }
 
-    client.sendResponse(message, adService_.list(payload));
+    QJsonObject payload = message.payload();
+    payload.insert(QStringLiteral("username"), session->username);
+    client.sendResponse(message, adUploadService_.commit(payload));
+}
+
+void RequestDispatcher::handleAdList(const common::Message& message,
+                                     ClientConnection& client)
+{
+    const auto session = requireSession(message, client, common::Command::AdListResult);
+    if (!session.has_value()) {
+        return;
+    }
+
+    client.sendResponse(message, executeBatchable(message, *session));
 }
 
 void RequestDispatcher::handleAdDetail(const common::Message& message,
@@ -331,13 +553,29 @@ void RequestDispatcher::handleAdDetail(const common::Message& message,
         return;
     }
 
-    QJsonObject payload = message.payload();
-    if (session->role.compare(QStringLiteral("Admin"), Qt::CaseInsensitive) == 0) {
-        payload.insert(QStringLiteral("includeUnapproved"), true);
-        payload.insert(QStringLiteral("includeHistory"), true);
+    client.sendResponse(message, executeBatchable(message, *session));
+}
+
+void RequestDispatcher::handleAdDetailBatch(const common::Message& message,
+                                            ClientConnection& client)
+{
+    const auto session = requireSession(message, client, common::Command::AdDetailBatchResult);
+    if (!session.has_value()) {
+        return;
     }
 
-    client.sendResponse(message, adService_.detail(payload));
+    client.sendResponse(message, executeBatchable(message, *session));
+}
+
+void RequestDispatcher::handleAdThumbnailBatch(const common::Message& message,
+                                               ClientConnection& client)
+{
+    const auto session = requireSession(message, client, common::Command::AdThumbnailBatchResult);
+    if (!session.has_value()) {
+        return;
+    }
+
+    client.sendResponse(message, executeBatchable(message, *session));
 }
 
 void RequestDispatcher::handleAdStatusUpdate(const common::Message& message,
@@ -353,6 +591,17 @@ void RequestDispatcher::handleAdStatusUpdate(const common::Message& message,
     client.sendResponse(message, adService_.updateStatus(payload));
 }
 
+void RequestDispatcher::handleCategoryList(const common::Message& message,
+                                          ClientConnection& client)
+{
+    const auto session = requireSession(message, client, common::Command::CategoryListResult);
+    if (!session.has_value()) {
+        return;
+    }
+
+    client.sendResponse(message, executeBatchable(message, *session));
+}
+
 void RequestDispatcher::handleCartAddItem(const common::Message& message,
                                           ClientConnection& client)
 {
@@ -387,9 +636,7 @@ void RequestDispatcher::handleCartList(const common::Message& message,
         return;
     }
 
-    QJsonObject payload = message.payload();
-    payload.insert(QStringLiteral("username"), session->username);
-    client.sendResponse(message, cartService_.list(payload));
+    client.sendResponse(message, executeBatchable(message, *session));
 }
 
 void RequestDispatcher::handleCartClear(const common::Message& message,
@@ -413,9 +660,7 @@ void RequestDispatcher::handleWalletBalance(const common::Message& message,
         return;
     }
 
-    QJsonObject payload = message.payload();
-    payload.insert(QStringLiteral("username"), session->username);
-    client.sendResponse(message, walletService_.walletBalance(payload));
+    client.sendResponse(message, executeBatchable(message, *session));
 }
 
 void RequestDispatcher::handleWalletTopUp(const common::Message& message,
@@ -526,7 +771,74 @@ void RequestDispatcher::handleTransactionHistory(const common::Message& message,
         return;
     }
 
-    QJsonObject payload = message.payload();
-    payload.insert(QStringLiteral("username"), session->username);
-    client.sendResponse(message, walletService_.transactionHistory(payload));
+    client.sendResponse(message, executeBatchable(message, *session));
+}
+
+void RequestDispatcher::handleBatch(const common::Message& message,
+                                    ClientConnection& client)
+{
+    const auto session = requireSession(message, client, common::Command::BatchResult);
+    if (!session.has_value()) {
+        return;
+    }
+
+    const QJsonArray requests = message.payload().value(QStringLiteral("requests")).toArray();
+    if (requests.isEmpty() || requests.size() > kMaxBatchSize) {
+        client.sendResponse(message, common::Message::makeFailure(common::Command::BatchResult,
+                                                                  common::ErrorCode::ValidationFailed,
+                                                                  QStringLiteral("Batch must contain between 1 and %1 requests")
+                                                                      .arg(kMaxBatchSize)));
+        return;
+    }
+
+    // Image-bearing entries can each fill most of a frame, so the combined
+    // response is measured as it grows. The entry that would overflow it, and
+    // every entry after, is answered with ServiceBusy for the client to retry.
+    QJsonArray responses;
+    qsizetype responseBytes = 0;
+    bool overBudget = false;
+    for (const QJsonValue& value : requests) {
+        QString parseError;
+        const auto subRequest = common::Message::fromJson(value.toObject(), &parseError);
+
+        common::Message response;
+        if (subRequest && overBudget) {
+            response = common::Message::makeFailure(batchableResultCommand(subRequest->command()),
+                                                    common::ErrorCode::ServiceBusy,
+                                                    QStringLiteral("Batch response is full; send this request again"));
+            response.setRequestId(subRequest->requestId());
+        } else if (!subRequest) {
+            response = common::Message::makeFailure(common::Command::Error,
+                                                    common::ErrorCode::InvalidPayload,
+                                                    parseError.isEmpty()
+                                                        ? QStringLiteral("Malformed batch entry")
+                                                        : parseError);
+        } else {
+            response = isBatchable(subRequest->command())
+                ? executeBatchable(*subRequest, *session)
+                : common::Message::makeFailure(common::Command::Error,
+                                               common::ErrorCode::UnknownCommand,
+                                               QStringLiteral("Command is not allowed in a batch"));
+            response.setRequestId(subRequest->requestId());
+
+            const qsizetype size = QJsonDocument(response.toJson()).toJson(QJsonDocument::Compact).size();
+            if (responseBytes + size > kMaxBatchResponseBytes) {
+                overBudget = true;
+                response = common::Message::makeFailure(batchableResultCommand(subRequest->command()),
+                                                        common::ErrorCode::ServiceBusy,
+                                                        QStringLiteral("Batch response is full; send this request again"));
+                response.setRequestId(subRequest->requestId());
+            } else {
+                responseBytes += size;
+            }
+        }
+        responses.append(response.toJson());
+    }
+
+    client.sendResponse(message, common::Message::makeSuccess(common::Command::BatchResult,
+                                                              QJsonObject{{QStringLiteral("responses"), responses},
+                                                                          {QStringLiteral("count"), responses.size()}},
+                                                              message.requestId(),
+                                                              {},
+                                                              QStringLiteral("Batch processed")));
 }
@@ -9,6 +9,7 @@
 #include <optional>
 
 class AdService;
+class AdUploadService;
 class CartService;
 class WalletService;
 class ClientConnection;
@@ -20,6 +21,7 @@ public:
     explicit RequestDispatcher(AuthService& authService,
                                SessionService& sessionService,
                                AdService& adService,
+                               AdUploadService& adUploadService,
                                CartService& cartService,
                                WalletService& walletService,
                                CaptchaService& captchaService);
@@ -33,11 +35,19 @@ private:
     AuthService& authService_;
     SessionService& sessionService_;
     AdService& adService_;
+    AdUploadService& adUploadService_;
     CartService& cartService_;
     WalletService& walletService_;
     CaptchaService& captchaService_;
     std::function<void(const QString&, const common::Message&)> notifyUserCallback_;
 
+    static constexpr int kMaxBatchSize = 16;
+
+    static bool isBatchable(common::Command command);
+    static common::Command batchableResultCommand(common::Command command);
+    common::Message executeBatchable(const common::Message& message,
+                                     const SessionService::SessionInfo& session);
+
     std::optional<SessionService::SessionInfo> requireSession(const common::Message& message,
                                                               ClientConnection& client,
                                                               common::Command resultCommand,
@@ -57,8 +67,14 @@ private:
     void handleProfileHistory(const common::Message& message, ClientConnection& client);
     void handleAdminStats(const common::Message& message, ClientConnection& client);
     void handleAdCreate(const common::Message& message, ClientConnection& client);
+    void handleAdUploadInit(const common::Message& message, ClientConnection& client);
+    void handleAdUploadChunk(const common::Message& message, ClientConnection& client);
+    void handleAdUploadCommit(const common::Message& message, ClientConnection& client);
     void handleAdList(const common::Message& message, ClientConnection& client);
     void handleAdDetail(const common::Message& message, ClientConnection& client);
+    void handleAdDetailBatch(const common::Message& message, ClientConnection& client);
+    void handleAdThumbnailBatch(const common::Message& message, ClientConnection& client);
+    void handleCategoryList(const common::Message& message, ClientConnection& client);
     void handleAdStatusUpdate(const common::Message& message, ClientConnection& client);
     void handleCartAddItem(const common::Message& message, ClientConnection& client);
     void handleCartRemoveItem(const common::Message& message, ClientConnection& client);
@@ -72,6 +88,7 @@ private:
     void handleDiscountCodeUpsert(const common::Message& message, ClientConnection& client);
     void handleDiscountCodeDelete(const common::Message& message, ClientConnection& client);
     void handleTransactionHistory(const common::Message& message, ClientConnection& client);
+    void handleBatch(const common::Message& message, ClientConnection& client);
 };
 
 #endif // REQUEST_DISPATCHER_H
@@ -1,8 +1,11 @@
 #ifndef AD_REPOSITORY_H
 #define AD_REPOSITORY_H
 
+#include "image_store.h"
+
 #include <QByteArray>
 #include <QString>
+#include <QVariant>
 #include <QVector>
 
 #include <optional>
@@ -13,7 +16,8 @@ public:
     enum class AdListSortField {
         CreatedAt,
         Title,
-        PriceTokens
+        PriceTokens,
+        Relevance
     };
 
     enum class SortOrder {
@@ -21,6 +25,12 @@ public:
         Asc
     };
 
+    // Columns read by findAdsByIds; Summary leaves description empty.
+    enum class AdFieldSet {
+        Summary,
+        Detail
+    };
+
     enum class AdModerationStatus {
         Pending,
         Approved,
@@ -29,6 +39,13 @@ public:
         Unknown
     };
 
+    // Position after the last row of a page: the sort column value and id of
+    // that row. The next page starts strictly past (sortKey, id).
+    struct AdListCursor {
+        QVariant sortKey;
+        int id = -1;
+    };
+
     struct AdListFilters {
         QString nameContains;
         QString category;
@@ -36,6 +53,8 @@ public:
         int maxPriceTokens = 0;
         AdListSortField sortField = AdListSortField::CreatedAt;
         SortOrder sortOrder = SortOrder::Desc;
+        int limit = 0;
+        std::optional<AdListCursor> after;
     };
 
     struct NewAd {
@@ -57,6 +76,9 @@ public:
         QString createdAt;
         QString updatedAt;
         bool hasImage = false;
+        qint64 imageSize = 0;
+        QString imageSha256;
+        double relevance = 0.0;
     };
 
     struct AdStatusHistoryRecord {
@@ -86,6 +108,29 @@ public:
         int totalTokens = 0;
     };
 
+    struct CategoryRecord {
+        int id = -1;
+        QString name;
+        int adCount = 0;
+        int approvedCount = 0;
+    };
+
+    // Result counts for the approved ads matching a listing's filters. Each
+    // facet ignores its own filter, so the counts tell a shopper what picking
+    // another category or price range would return. priceBounds are ascending
+    // upper bounds: bucket i holds prices below priceBounds[i] and at or above
+    // the bound before it, and one more open-ended bucket follows the last.
+    struct AdListFacets {
+        struct CategoryCount {
+            QString name;
+            int count = 0;
+        };
+
+        QVector<CategoryCount> categories;
+        QVector<int> priceBounds;
+        QVector<int> priceBucketCounts;
+    };
+
     struct AdDetailRecord {
         int id = -1;
         QString title;
@@ -93,7 +138,8 @@ public:
         QString category;
         int priceTokens = 0;
         QString sellerUsername;
-        QByteArray imageBytes;
+        QString imageSha256;
+        qint64 imageSize = 0;
         QString status;
         QString createdAt;
         QString updatedAt;
@@ -105,6 +151,11 @@ public:
     virtual QVector<AdSummaryRecord> listApprovedAds(const AdListFilters& filters) = 0;
     virtual std::optional<AdDetailRecord> findApprovedAdById(int adId) = 0;
     virtual std::optional<AdDetailRecord> findAdById(int adId) = 0;
+    // Records come back in the order of adIds; ids that do not exist (or are
+    // not approved, when approvedOnly is set) are left out.
+    virtual QVector<AdDetailRecord> findAdsByIds(const QVector<int>& adIds,
+                                                 AdFieldSet fields,
+                                                 bool approvedOnly) = 0;
     virtual bool hasDuplicateActiveAdForSeller(const NewAd& ad) = 0;
     virtual bool updateStatus(int adId,
                               AdModerationStatus newStatus,
@@ -120,6 +171,14 @@ public:
     virtual QVector<AdSummaryRecord> listPurchasedAdsByBuyer(const QString& buyerUsername, int limit) = 0;
     virtual AdStatusCounts getAdStatusCounts() = 0;
     virtual SalesTotals getSalesTotals() = 0;
+    virtual QVector<CategoryRecord> listCategories() = 0;
+    // Fills the counts of facets for the name, category and price filters;
+    // sort, cursor and limit are ignored. facets.priceBounds picks the buckets.
+    virtual void countApprovedFacets(const AdListFilters& filters, AdListFacets& facets) = 0;
+    virtual std::optional<ImageStore::MappedImage> openImage(const QString& sha256) = 0;
+    // Thumbnail access touches only files, so it is safe off the dispatcher thread.
+    virtual std::optional<ImageStore::MappedImage> openThumbnail(const QString& sha256) = 0;
+    virtual void storeThumbnail(const QString& sha256, const QByteArray& bytes) = 0;
 };
 
 #endif // AD_REPOSITORY_H
@@ -0,0 +1,294 @@
+#include "caching_user_repository.h"
+
+#include <QHash>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace {
+constexpr qsizetype kMinBloomKeys = 1024;
+constexpr size_t kSecondHashSeed = 0x9e3779b97f4a7c15ULL;
+
+QString usernameKey(const QString& username)
+{
+    return QStringLiteral("u:") + username;
+}
+
+QString emailKey(const QString& email)
+{
+    return QStringLiteral("e:") + email;
+}
+}
+
+void CachingUserRepository::BloomFilter::reset(qsizetype expectedKeys)
+{
+    capacity_ = qMax(kMinBloomKeys, expectedKeys * 2);
+    const quint64 words = (static_cast<quint64>(capacity_) * 10 + 63) / 64;
+    bits_.assign(words, 0);
+    bitCount_ = words * 64;
+}
+
+void CachingUserRepository::BloomFilter::insert(const QString& key)
+{
+    const quint64 h1 = qHash(key, 0);
+    const quint64 h2 = qHash(key, kSecondHashSeed) | 1;
+    for (int i = 0; i < kHashCount; ++i) {
+        const quint64 bit = (h1 + i * h2) % bitCount_;
+        bits_[bit / 64] |= quint64(1) << (bit % 64);
+    }
+}
+
+bool CachingUserRepository::BloomFilter::mightContain(const QString& key) const
+{
+    const quint64 h1 = qHash(key, 0);
+    const quint64 h2 = qHash(key, kSecondHashSeed) | 1;
+    for (int i = 0; i < kHashCount; ++i) {
+        const quint64 bit = (h1 + i * h2) % bitCount_;
+        if ((bits_[bit / 64] & (quint64(1) << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CachingUserRepository::CachingUserRepository(UserRepository& inner, int maxCachedUsers)
+    : inner_(inner),
+      records_(qMax(1, maxCachedUsers))
+{
+}
+
+bool CachingUserRepository::userExists(const QString& username)
+{
+    return identityExists(IdentityKind::Username, username);
+}
+
+bool CachingUserRepository::emailExists(const QString& email)
+{
+    return identityExists(IdentityKind::Email, email);
+}
+
+bool CachingUserRepository::checkPassword(const QString& username, const QString& passwordHash)
+{
+    User user;
+    return getUser(username, user) && user.passwordHash == passwordHash;
+}
+
+bool CachingUserRepository::getUser(const QString& username, User& outUser)
+{
+    {
+        QMutexLocker locker(&recordMutex_);
+        if (const User* cached = records_.object(username)) {
+            outUser = *cached;
+            recordHits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    recordMisses_.fetch_add(1, std::memory_order_relaxed);
+    if (!identityExists(IdentityKind::Username, username)) {
+        return false;
+    }
+
+    User user;
+    if (!inner_.getUser(username, user)) {
+        return false;
+    }
+
+    cacheUser(user);
+    outUser = user;
+    return true;
+}
+
+std::optional<User> CachingUserRepository::findByUsername(const QString& username)
+{
+    User user;
+    if (!getUser(username, user)) {
+        return std::nullopt;
+    }
+    return user;
+}
+
+void CachingUserRepository::createUser(const User& user)
+{
+    inner_.createUser(user);
+
+    {
+        QWriteLocker locker(&identityLock_);
+        if (identitiesLoaded_) {
+            addIdentityLocked(user.username, user.email);
+        }
+    }
+    cacheUser(user);
+}
+
+bool CachingUserRepository::updateProfile(const QString& currentUsername,
+                                          const User& profile,
+                                          const QString& expectedPasswordHash,
+                                          const QString& newPasswordHash)
+{
+    User previous;
+    const bool hadPrevious = getUser(currentUsername, previous);
+
+    if (!inner_.updateProfile(currentUsername, profile, expectedPasswordHash, newPasswordHash)) {
+        return false;
+    }
+
+    // The profile carries no role, so the record is reloaded on next use
+    // rather than rebuilt here.
+    {
+        QMutexLocker locker(&recordMutex_);
+        records_.remove(currentUsername);
+        records_.remove(profile.username);
+    }
+
+    {
+        QWriteLocker locker(&identityLock_);
+        if (identitiesLoaded_ && hadPrevious) {
+            usernames_.remove(previous.username);
+            emails_.remove(previous.email);
+            addIdentityLocked(profile.username, profile.email);
+        } else {
+            // Without the old row we cannot tell which email to drop; reload
+            // on next use rather than guess.
+            identitiesLoaded_ = false;
+        }
+    }
+    return true;
+}
+
+bool CachingUserRepository::updatePasswordHash(const QString& username,
+                                               const QString& expectedHash,
+                                               const QString& newHash)
+{
+    if (!inner_.updatePasswordHash(username, expectedHash, newHash)) {
+        return false;
+    }
+
+    QMutexLocker locker(&recordMutex_);
+    records_.remove(username);
+    return true;
+}
+
+int CachingUserRepository::countAllUsers()
+{
+    return inner_.countAllUsers();
+}
+
+int CachingUserRepository::countUsersByRole(const QString& role)
+{
+    return inner_.countUsersByRole(role);
+}
+
+QVector<AdminUserInfo> CachingUserRepository::listUsersForAdmin(const QString& searchTerm)
+{
+    return inner_.listUsersForAdmin(searchTerm);
+}
+
+QVector<UserIdentity> CachingUserRepository::listIdentities()
+{
+    return inner_.listIdentities();
+}
+
+std::optional<UserCacheStats> CachingUserRepository::cacheStats() const
+{
+    UserCacheStats result;
+    result.recordHits = recordHits_.load(std::memory_order_relaxed);
+    result.recordMisses = recordMisses_.load(std::memory_order_relaxed);
+    result.existenceChecks = existenceChecks_.load(std::memory_order_relaxed);
+    result.bloomRejects = bloomRejects_.load(std::memory_order_relaxed);
+    result.existenceFallbacks = existenceFallbacks_.load(std::memory_order_relaxed);
+    {
+        QMutexLocker locker(&recordMutex_);
+        result.cachedUsers = static_cast<int>(records_.count());
+    }
+    {
+        QReadLocker locker(&identityLock_);
+        result.knownIdentities = static_cast<int>(usernames_.size());
+    }
+    return result;
+}
+
+bool CachingUserRepository::identityExists(IdentityKind kind, const QString& value)
+{
+    existenceChecks_.fetch_add(1, std::memory_order_relaxed);
+    if (ensureIdentitiesLoaded()) {
+        QReadLocker locker(&identityLock_);
+        if (identitiesLoaded_) {
+            const bool isUsername = kind == IdentityKind::Username;
+            if (!bloom_.mightContain(isUsername ? usernameKey(value) : emailKey(value))) {
+                bloomRejects_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            return isUsername ? usernames_.contains(value) : emails_.contains(value);
+        }
+    }
+
+    existenceFallbacks_.fetch_add(1, std::memory_order_relaxed);
+    return kind == IdentityKind::Username ? inner_.userExists(value) : inner_.emailExists(value);
+}
+
+bool CachingUserRepository::ensureIdentitiesLoaded()
+{
+    {
+        QReadLocker locker(&identityLock_);
+        if (identitiesLoaded_) {
+            return true;
+        }
+    }
+
+    QWriteLocker locker(&identityLock_);
+    if (identitiesLoaded_) {
+        return true;
+    }
+
+    QVector<UserIdentity> identities;
+    try {
+        identities = inner_.listIdentities();
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    usernames_.clear();
+    emails_.clear();
+    usernames_.reserve(identities.size());
+    emails_.reserve(identities.size());
+    for (const UserIdentity& identity : identities) {
+        usernames_.insert(identity.username);
+        emails_.insert(identity.email);
+    }
+    rebuildBloomLocked();
+    identitiesLoaded_ = true;
+    return true;
+}
+
+void CachingUserRepository::addIdentityLocked(const QString& username, const QString& email)
+{
+    usernames_.insert(username);
+    emails_.insert(email);
+    bloom_.insert(usernameKey(username));
+    bloom_.insert(emailKey(email));
+
+    // Renames leave stale bits behind, so rebuild once inserts outgrow the sizing.
+    bloomInserts_ += 2;
+    if (bloomInserts_ > bloom_.capacity()) {
+        rebuildBloomLocked();
+    }
+}
+
+void CachingUserRepository::rebuildBloomLocked()
+{
+    bloom_.reset(usernames_.size() + emails_.size());
+    for (const QString& username : std::as_const(usernames_)) {
+        bloom_.insert(usernameKey(username));
+    }
+    for (const QString& email : std::as_const(emails_)) {
+        bloom_.insert(emailKey(email));
+    }
+    bloomInserts_ = usernames_.size() + emails_.size();
+}
+
+void CachingUserRepository::cacheUser(const User& user)
+{
+    QMutexLocker locker(&recordMutex_);
+    records_.insert(user.username, new User(user));
+}
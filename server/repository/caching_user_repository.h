@@ -0,0 +1,94 @@
+#ifndef CACHING_USER_REPOSITORY_H
+#define CACHING_USER_REPOSITORY_H
+
+#include "user_repository.h"
+
+#include <atomic>
+#include <vector>
+
+#include <QCache>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSet>
+
+// Read-through cache in front of another UserRepository. User records live in
+// an LRU; username and email existence is answered from an in-memory filter
+// (a Bloom filter that rejects most misses, backed by exact sets) that is
+// loaded once from listIdentities(). All writes must go through this object.
+class CachingUserRepository : public UserRepository
+{
+public:
+    static constexpr int kDefaultMaxCachedUsers = 4096;
+
+    explicit CachingUserRepository(UserRepository& inner, int maxCachedUsers = kDefaultMaxCachedUsers);
+
+    bool userExists(const QString& username) override;
+    bool emailExists(const QString& email) override;
+    bool checkPassword(const QString& username,
+                       const QString& passwordHash) override;
+    bool getUser(const QString& username, User& outUser) override;
+    std::optional<User> findByUsername(const QString& username) override;
+    void createUser(const User& user) override;
+    bool updateProfile(const QString& currentUsername,
+                       const User& profile,
+                       const QString& expectedPasswordHash = {},
+                       const QString& newPasswordHash = {}) override;
+    bool updatePasswordHash(const QString& username,
+                            const QString& expectedHash,
+                            const QString& newHash) override;
+    int countAllUsers() override;
+    int countUsersByRole(const QString& role) override;
+    QVector<AdminUserInfo> listUsersForAdmin(const QString& searchTerm = {}) override;
+    QVector<UserIdentity> listIdentities() override;
+    std::optional<UserCacheStats> cacheStats() const override;
+
+private:
+    // Two hashes combined by double hashing; sized at roughly ten bits per key
+    // for a false-positive rate around one percent.
+    class BloomFilter
+    {
+    public:
+        void reset(qsizetype expectedKeys);
+        void insert(const QString& key);
+        bool mightContain(const QString& key) const;
+        qsizetype capacity() const { return capacity_; }
+
+    private:
+        static constexpr int kHashCount = 7;
+
+        std::vector<quint64> bits_;
+        quint64 bitCount_ = 0;
+        qsizetype capacity_ = 0;
+    };
+
+    enum class IdentityKind {
+        Username,
+        Email
+    };
+
+    bool identityExists(IdentityKind kind, const QString& value);
+    bool ensureIdentitiesLoaded();
+    void addIdentityLocked(const QString& username, const QString& email);
+    void rebuildBloomLocked();
+    void cacheUser(const User& user);
+
+    UserRepository& inner_;
+
+    mutable QMutex recordMutex_;
+    QCache<QString, User> records_;
+
+    mutable QReadWriteLock identityLock_;
+    bool identitiesLoaded_ = false;
+    QSet<QString> usernames_;
+    QSet<QString> emails_;
+    BloomFilter bloom_;
+    qsizetype bloomInserts_ = 0;
+
+    std::atomic<qint64> recordHits_{0};
+    std::atomic<qint64> recordMisses_{0};
+    std::atomic<qint64> existenceChecks_{0};
+    std::atomic<qint64> bloomRejects_{0};
+    std::atomic<qint64> existenceFallbacks_{0};
+};
+
+#endif // CACHING_USER_REPOSITORY_H
@@ -0,0 +1,169 @@
+#include "image_store.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <stdexcept>
+
+QByteArray ImageStore::MappedImage::bytes() const
+{
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(data_), static_cast<qsizetype>(size_));
+}
+
+qint64 ImageStore::MappedImage::size() const
+{
+    return size_;
+}
+
+QString ImageStore::MappedImage::path() const
+{
+    return file_ ? file_->fileName() : QString();
+}
+
+ImageStore::ImageStore(const QString& rootPath)
+    : rootPath_(QDir(rootPath).absolutePath())
+{
+    if (!QDir().mkpath(rootPath_)) {
+        throw std::runtime_error(QStringLiteral("Failed to create image store at %1").arg(rootPath_).toStdString());
+    }
+}
+
+QString ImageStore::rootPath() const
+{
+    return rootPath_;
+}
+
+QString ImageStore::put(const QByteArray& bytes)
+{
+    if (bytes.isEmpty()) {
+        return QString();
+    }
+
+    const QString sha256 = sha256Hex(bytes);
+    const QString path = pathFor(sha256);
+    if (QFileInfo(path).size() == bytes.size()) {
+        return sha256;
+    }
+
+    writeFile(path, bytes, sha256);
+    return sha256;
+}
+
+std::optional<ImageStore::MappedImage> ImageStore::map(const QString& sha256) const
+{
+    if (!isValidHash(sha256)) {
+        return std::nullopt;
+    }
+    return mapFile(pathFor(sha256));
+}
+
+void ImageStore::remove(const QString& sha256)
+{
+    if (isValidHash(sha256)) {
+        QFile::remove(thumbnailPathFor(sha256));
+        QFile::remove(pathFor(sha256));
+    }
+}
+
+QSet<QString> ImageStore::listHashes() const
+{
+    QSet<QString> hashes;
+    QDirIterator it(rootPath_, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        QString name = it.fileName();
+        if (name.endsWith(QStringLiteral(".thumb"))) {
+            name.chop(6);
+        }
+        if (isValidHash(name)) {
+            hashes.insert(name);
+        }
+    }
+    return hashes;
+}
+
+void ImageStore::putThumbnail(const QString& sha256, const QByteArray& bytes)
+{
+    if (!isValidHash(sha256) || bytes.isEmpty()) {
+        return;
+    }
+    writeFile(thumbnailPathFor(sha256), bytes, sha256);
+}
+
+std::optional<ImageStore::MappedImage> ImageStore::mapThumbnail(const QString& sha256) const
+{
+    if (!isValidHash(sha256)) {
+        return std::nullopt;
+    }
+    return mapFile(thumbnailPathFor(sha256));
+}
+
+QString ImageStore::sha256Hex(const QByteArray& bytes)
+{
+    if (bytes.isEmpty()) {
+        return QString();
+    }
+    return QString::fromLatin1(QCryptographicHash::hash(bytes, QCryptographicHash::Sha256).toHex());
+}
+
+bool ImageStore::isValidHash(const QString& sha256)
+{
+    if (sha256.size() != 64) {
+        return false;
+    }
+    for (const QChar ch : sha256) {
+        if (!((ch >= QLatin1Char('0') && ch <= QLatin1Char('9')) || (ch >= QLatin1Char('a') && ch <= QLatin1Char('f')))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QString ImageStore::pathFor(const QString& sha256) const
+{
+    return rootPath_ + QLatin1Char('/') + sha256.left(2) + QLatin1Char('/') + sha256;
+}
+
+QString ImageStore::thumbnailPathFor(const QString& sha256) const
+{
+    return pathFor(sha256) + QStringLiteral(".thumb");
+}
+
+void ImageStore::writeFile(const QString& path, const QByteArray& bytes, const QString& sha256)
+{
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        throw std::runtime_error(QStringLiteral("Failed to create image directory for %1").arg(sha256).toStdString());
+    }
+
+    // Written beside the final name and renamed into place, so a reader never
+    // maps a partial file and concurrent writers of the same image are harmless.
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(bytes) != bytes.size()
+        || !file.commit()) {
+        throw std::runtime_error(QStringLiteral("Failed to store image %1: %2")
+                                     .arg(sha256, file.errorString())
+                                     .toStdString());
+    }
+}
+
+std::optional<ImageStore::MappedImage> ImageStore::mapFile(const QString& path)
+{
+    MappedImage image;
+    image.file_ = std::make_unique<QFile>(path);
+    if (!image.file_->open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    image.size_ = image.file_->size();
+    image.data_ = image.size_ > 0 ? image.file_->map(0, image.size_) : nullptr;
+    if (!image.data_) {
+        return std::nullopt;
+    }
+    // The mapping outlives the descriptor; only the QFile object must stay.
+    image.file_->close();
+    return image;
+}
@@ -0,0 +1,66 @@
+#ifndef KALANET_IMAGE_STORE_H
+#define KALANET_IMAGE_STORE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QSet>
+#include <QString>
+
+#include <memory>
+#include <optional>
+
+// Content-addressed image files: each image lives once under its SHA-256,
+// fanned out by the first two hex digits. Files are immutable once written,
+// so reads map them instead of copying. Reference counts are kept by the
+// owning repository; the store only knows about files. A downscaled
+// thumbnail may sit beside each image under the same hash.
+class ImageStore
+{
+public:
+    // Read-only mapping of one stored image. bytes() does not copy and stays
+    // valid for the lifetime of this object.
+    class MappedImage
+    {
+    public:
+        QByteArray bytes() const;
+        qint64 size() const;
+        QString path() const;
+
+    private:
+        friend class ImageStore;
+
+        std::unique_ptr<QFile> file_;
+        const uchar* data_ = nullptr;
+        qint64 size_ = 0;
+    };
+
+    explicit ImageStore(const QString& rootPath);
+
+    QString rootPath() const;
+
+    // Stores the bytes unless an identical image is already present and
+    // returns their SHA-256 in hex; empty input yields an empty hash.
+    QString put(const QByteArray& bytes);
+
+    std::optional<MappedImage> map(const QString& sha256) const;
+    // Removes the image together with its thumbnail.
+    void remove(const QString& sha256);
+    // Hashes with an image or thumbnail file on disk.
+    QSet<QString> listHashes() const;
+
+    void putThumbnail(const QString& sha256, const QByteArray& bytes);
+    std::optional<MappedImage> mapThumbnail(const QString& sha256) const;
+
+    static QString sha256Hex(const QByteArray& bytes);
+
+private:
+    static bool isValidHash(const QString& sha256);
+    QString pathFor(const QString& sha256) const;
+    QString thumbnailPathFor(const QString& sha256) const;
+    static void writeFile(const QString& path, const QByteArray& bytes, const QString& sha256);
+    static std::optional<MappedImage> mapFile(const QString& path);
+
+    QString rootPath_;
+};
+
+#endif // KALANET_IMAGE_STORE_H
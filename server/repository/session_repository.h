@@ -0,0 +1,41 @@
+#ifndef SESSION_REPOSITORY_H
+#define SESSION_REPOSITORY_H
+
+#include <optional>
+
+#include <QCryptographicHash>
+#include <QString>
+#include <QVector>
+
+class SessionRepository
+{
+public:
+    struct SessionRecord {
+        // Sessions are keyed by hashToken() of the bearer token, so a copy of
+        // the database does not hand out live sessions.
+        QString tokenHash;
+        QString username;
+        QString role;
+        qint64 createdAt = 0;
+    };
+
+    struct SessionWrite {
+        SessionRecord record;
+        bool remove = false;
+    };
+
+    virtual ~SessionRepository() = default;
+
+    static QString hashToken(const QString& token)
+    {
+        return QString::fromLatin1(QCryptographicHash::hash(token.toUtf8(), QCryptographicHash::Sha256).toHex());
+    }
+
+    // Applies a coalesced batch of upserts and deletes in one transaction.
+    virtual void applyWrites(const QVector<SessionWrite>& writes) = 0;
+    virtual std::optional<SessionRecord> findSession(const QString& tokenHash) = 0;
+    virtual QVector<QString> listTokenHashes() = 0;
+    virtual int purgeCreatedBefore(qint64 createdBefore) = 0;
+};
+
+#endif // SESSION_REPOSITORY_H
@@ -1,11 +1,19 @@
 #include "sqlite_ad_repository.h"
 
+#include "../ads/catalog_version.h"
+#include "../logging_audit_logger.h"
+
 #include <QCoreApplication>
 #include <QDir>
+#include <QFileInfo>
+#include <QHash>
 #include <QMutexLocker>
+#include <QSet>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QStringList>
 #include <QVariant>
+#include <limits>
 #include <stdexcept>
 
 namespace {
@@ -54,11 +62,258 @@ constexpr Migration kMigrations[] = {
         5,
         "CREATE INDEX IF NOT EXISTS idx_ad_status_history_ad_id_changed_at "
         "ON ad_status_history(ad_id, changed_at DESC);"
+    },
+    {
+        6,
+        "ALTER TABLE ads ADD COLUMN has_image INTEGER NOT NULL DEFAULT 0;"
+    },
+    {
+        7,
+        "ALTER TABLE ads ADD COLUMN image_size INTEGER NOT NULL DEFAULT 0;"
+    },
+    {
+        8,
+        "ALTER TABLE ads ADD COLUMN image_sha256 TEXT;"
+    },
+    {
+        9,
+        "UPDATE ads SET "
+        "    has_image = (image_bytes IS NOT NULL AND length(image_bytes) > 0),"
+        "    image_size = COALESCE(length(image_bytes), 0);"
+    },
+    {
+        10,
+        "CREATE INDEX IF NOT EXISTS idx_ads_status_created_at_id "
+        "ON ads(status, created_at, id);"
+    },
+    {
+        11,
+        "CREATE INDEX IF NOT EXISTS idx_ads_status_title_id "
+        "ON ads(status, title, id);"
+    },
+    {
+        12,
+        "CREATE INDEX IF NOT EXISTS idx_ads_status_price_tokens_id "
+        "ON ads(status, price_tokens, id);"
+    },
+    {
+        13,
+        "DROP INDEX IF EXISTS idx_ads_status_created_at;"
+    },
+    {
+        14,
+        "CREATE TABLE IF NOT EXISTS categories ("
+        "    id INTEGER PRIMARY KEY,"
+        "    name TEXT NOT NULL UNIQUE COLLATE NOCASE,"
+        "    ad_count INTEGER NOT NULL DEFAULT 0,"
+        "    approved_count INTEGER NOT NULL DEFAULT 0"
+        ");"
+    },
+    {
+        15,
+        "INSERT OR IGNORE INTO categories (name) "
+        "SELECT TRIM(category) FROM ads ORDER BY id;"
+    },
+    {
+        16,
+        "ALTER TABLE ads ADD COLUMN category_id INTEGER REFERENCES categories(id);"
+    },
+    {
+        17,
+        "UPDATE ads SET (category_id, category) = ("
+        "    SELECT id, name FROM categories WHERE categories.name = TRIM(ads.category)"
+        ");"
+    },
+    {
+        18,
+        "UPDATE categories SET "
+        "    ad_count = (SELECT COUNT(1) FROM ads WHERE ads.category_id = categories.id),"
+        "    approved_count = (SELECT COUNT(1) FROM ads"
+        "                      WHERE ads.category_id = categories.id AND ads.status = 'approved');"
+    },
+    {
+        19,
+        "CREATE INDEX IF NOT EXISTS idx_ads_status_category_id_created_at "
+        "ON ads(status, category_id, created_at, id);"
+    },
+    {
+        20,
+        "CREATE TRIGGER IF NOT EXISTS categories_count_after_insert AFTER INSERT ON ads BEGIN"
+        "    UPDATE categories SET ad_count = ad_count + 1,"
+        "        approved_count = approved_count + (new.status = 'approved')"
+        "    WHERE id = new.category_id;"
+        " END;"
+    },
+    {
+        21,
+        "CREATE TRIGGER IF NOT EXISTS categories_count_after_delete AFTER DELETE ON ads BEGIN"
+        "    UPDATE categories SET ad_count = ad_count - 1,"
+        "        approved_count = approved_count - (old.status = 'approved')"
+        "    WHERE id = old.category_id;"
+        " END;"
+    },
+    {
+        22,
+        "CREATE TRIGGER IF NOT EXISTS categories_count_after_update AFTER UPDATE OF status, category_id ON ads"
+        " WHEN old.status IS NOT new.status OR old.category_id IS NOT new.category_id BEGIN"
+        "    UPDATE categories SET ad_count = ad_count - 1,"
+        "        approved_count = approved_count - (old.status = 'approved')"
+        "    WHERE id = old.category_id;"
+        "    UPDATE categories SET ad_count = ad_count + 1,"
+        "        approved_count = approved_count + (new.status = 'approved')"
+        "    WHERE id = new.category_id;"
+        " END;"
+    },
+    {
+        23,
+        "CREATE TABLE IF NOT EXISTS image_blobs ("
+        "    sha256 TEXT PRIMARY KEY,"
+        "    size_bytes INTEGER NOT NULL,"
+        "    ref_count INTEGER NOT NULL DEFAULT 0,"
+        "    created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP"
+        ");"
+    },
+    {
+        24,
+        "CREATE INDEX IF NOT EXISTS idx_ads_image_sha256 "
+        "ON ads(image_sha256) WHERE image_sha256 IS NOT NULL;"
+    },
+    {
+        25,
+        "CREATE TRIGGER IF NOT EXISTS image_blobs_ref_after_insert AFTER INSERT ON ads"
+        " WHEN new.image_sha256 IS NOT NULL BEGIN"
+        "    UPDATE image_blobs SET ref_count = ref_count + 1 WHERE sha256 = new.image_sha256;"
+        " END;"
+    },
+    {
+        26,
+        "CREATE TRIGGER IF NOT EXISTS image_blobs_ref_after_delete AFTER DELETE ON ads"
+        " WHEN old.image_sha256 IS NOT NULL BEGIN"
+        "    UPDATE image_blobs SET ref_count = ref_count - 1 WHERE sha256 = old.image_sha256;"
+        " END;"
+    },
+    {
+        27,
+        "CREATE TRIGGER IF NOT EXISTS image_blobs_ref_after_update AFTER UPDATE OF image_sha256 ON ads"
+        " WHEN old.image_sha256 IS NOT new.image_sha256 BEGIN"
+        "    UPDATE image_blobs SET ref_count = ref_count - 1 WHERE sha256 = old.image_sha256;"
+        "    UPDATE image_blobs SET ref_count = ref_count + 1 WHERE sha256 = new.image_sha256;"
+        " END;"
+    },
+    {
+        28,
+        "CREATE TABLE IF NOT EXISTS ad_images ("
+        "    ad_id INTEGER PRIMARY KEY REFERENCES ads(id) ON DELETE CASCADE,"
+        "    image_bytes BLOB NOT NULL"
+        ");"
+    },
+    {
+        29,
+        "INSERT OR IGNORE INTO ad_images (ad_id, image_bytes) "
+        "SELECT id, image_bytes FROM ads WHERE image_bytes IS NOT NULL;"
+    },
+    {
+        // ads.image_bytes sits before the metadata columns, so a row holding
+        // a blob makes every list query walk its overflow pages. The column
+        // stays (DROP COLUMN needs SQLite 3.35) but is never written again.
+        30,
+        "UPDATE ads SET image_bytes = NULL WHERE image_bytes IS NOT NULL;"
     }
 };
 
+// Category filters resolve the name once through the NOCASE unique index and
+// then match on category_id, which the (status, category_id, ...) index covers.
+constexpr auto kCategoryIdFilter =
+    " AND category_id = (SELECT id FROM categories WHERE name = :category)";
+
 constexpr int kLatestSchemaVersion = sizeof(kMigrations) / sizeof(kMigrations[0]);
 
+// External-content FTS5 index over ads, kept in sync by triggers. The update
+// trigger is limited to the indexed columns so status changes never reach it.
+constexpr const char* kFullTextStatements[] = {
+    "CREATE VIRTUAL TABLE ads_fts USING fts5("
+    "    title, description, category,"
+    "    content = 'ads', content_rowid = 'id',"
+    "    tokenize = 'unicode61 remove_diacritics 2',"
+    "    prefix = '2 3'"
+    ");",
+    "CREATE TRIGGER ads_fts_after_insert AFTER INSERT ON ads BEGIN"
+    "    INSERT INTO ads_fts (rowid, title, description, category)"
+    "    VALUES (new.id, new.title, new.description, new.category);"
+    " END;",
+    "CREATE TRIGGER ads_fts_after_delete AFTER DELETE ON ads BEGIN"
+    "    INSERT INTO ads_fts (ads_fts, rowid, title, description, category)"
+    "    VALUES ('delete', old.id, old.title, old.description, old.category);"
+    " END;",
+    "CREATE TRIGGER ads_fts_after_update AFTER UPDATE OF title, description, category ON ads BEGIN"
+    "    INSERT INTO ads_fts (ads_fts, rowid, title, description, category)"
+    "    VALUES ('delete', old.id, old.title, old.description, old.category);"
+    "    INSERT INTO ads_fts (rowid, title, description, category)"
+    "    VALUES (new.id, new.title, new.description, new.category);"
+    " END;",
+    "INSERT INTO ads_fts (ads_fts) VALUES ('rebuild');"
+};
+
+// Title matches weigh most, then category, then description. bm25() is lower
+// for better matches, so it is negated to make DESC mean most relevant first.
+constexpr auto kRankedFromClause =
+    "ads JOIN ("
+    "    SELECT rowid AS match_id, -bm25(ads_fts, 10.0, 1.0, 2.0) AS relevance"
+    "    FROM ads_fts WHERE ads_fts MATCH :match"
+    ") AS matches ON matches.match_id = ads.id";
+
+
+// List queries read this metadata; image bytes are never stored in ads rows,
+// so no listing touches blob pages.
+constexpr auto kSummaryColumns =
+    "id, title, category, price_tokens, seller_username, status, created_at, updated_at, "
+    "has_image, image_size, image_sha256";
+
+AdRepository::AdSummaryRecord readSummaryRecord(const QSqlQuery& query)
+{
+    AdRepository::AdSummaryRecord record;
+    record.id = query.value(0).toInt();
+    record.title = query.value(1).toString();
+    record.category = query.value(2).toString();
+    record.priceTokens = query.value(3).toInt();
+    record.sellerUsername = query.value(4).toString();
+    record.status = query.value(5).toString();
+    record.createdAt = query.value(6).toString();
+    record.updatedAt = query.value(7).toString();
+    record.hasImage = query.value(8).toBool();
+    record.imageSize = query.value(9).toLongLong();
+    record.imageSha256 = query.value(10).toString();
+    return record;
+}
+
+constexpr auto kDetailColumns =
+    "id, title, description, category, price_tokens, seller_username, image_sha256, image_size, "
+    "status, created_at, updated_at";
+
+// Same positions as kDetailColumns, with the description left out.
+constexpr auto kDetailSummaryColumns =
+    "id, title, '', category, price_tokens, seller_username, image_sha256, image_size, "
+    "status, created_at, updated_at";
+
+// Stays well under SQLITE_MAX_VARIABLE_NUMBER on every SQLite version.
+constexpr int kMaxIdsPerQuery = 500;
+
+AdRepository::AdDetailRecord readDetailRecord(const QSqlQuery& query)
+{
+    AdRepository::AdDetailRecord record;
+    record.id = query.value(0).toInt();
+    record.title = query.value(1).toString();
+    record.description = query.value(2).toString();
+    record.category = query.value(3).toString();
+    record.priceTokens = query.value(4).toInt();
+    record.sellerUsername = query.value(5).toString();
+    record.imageSha256 = query.value(6).toString();
+    record.imageSize = query.value(7).toLongLong();
+    record.status = query.value(8).toString();
+    record.createdAt = query.value(9).toString();
+    record.updatedAt = query.value(10).toString();
+    return record;
+}
 
 QString sortFieldToSqlColumn(AdRepository::AdListSortField field)
 {
@@ -73,6 +328,80 @@ QString sortFieldToSqlColumn(AdRepository::AdListSortField field)
     }
 }
 
+QStringList searchWords(const QString& text)
+{
+    QStringList words;
+    QString current;
+    for (const QChar ch : text) {
+        if (ch.isLetterOrNumber()) {
+            current += ch;
+        } else if (!current.isEmpty()) {
+            words.append(current);
+            current.clear();
+        }
+    }
+    if (!current.isEmpty()) {
+        words.append(current);
+    }
+    return words;
+}
+
+// Every word becomes a quoted prefix term, so user input cannot inject FTS5
+// operators and partially typed words still match.
+QString fullTextMatchTerms(const QString& text, const QString& column = QString())
+{
+    QStringList terms;
+    for (const QString& word : searchWords(text)) {
+        const QString term = QStringLiteral("\"%1\"*").arg(word);
+        terms.append(column.isEmpty() ? term : column + QStringLiteral(" : ") + term);
+    }
+    return terms.join(QLatin1Char(' '));
+}
+
+QString listSelect(const QString& matchQuery)
+{
+    const bool ranked = !matchQuery.isEmpty();
+    return QStringLiteral("SELECT %1, %2 FROM %3 WHERE 1 = 1")
+        .arg(QLatin1String(kSummaryColumns),
+             ranked ? QStringLiteral("matches.relevance") : QStringLiteral("0.0"),
+             ranked ? QLatin1String(kRankedFromClause) : QLatin1String("ads"));
+}
+
+// Keyset paging: rows strictly past the cursor in (sort column, id) order, so
+// every page is an index range scan regardless of how deep it is.
+void appendPageClauses(QString& sql, const AdRepository::AdListFilters& filters, bool ranked)
+{
+    QString sortField = sortFieldToSqlColumn(filters.sortField);
+    if (filters.sortField == AdRepository::AdListSortField::Relevance) {
+        sortField = ranked ? QStringLiteral("matches.relevance") : QStringLiteral("0.0");
+    }
+    const bool ascending = filters.sortOrder == AdRepository::SortOrder::Asc;
+
+    if (filters.after.has_value()) {
+        sql += QStringLiteral(" AND (%1, id) %2 (:after_key, :after_id)")
+                   .arg(sortField, ascending ? QStringLiteral(">") : QStringLiteral("<"));
+    }
+
+    const QString sortOrder = ascending ? QStringLiteral("ASC") : QStringLiteral("DESC");
+    sql += QStringLiteral(" ORDER BY %1 %2, id %2").arg(sortField, sortOrder);
+
+    if (filters.limit > 0) {
+        sql += QStringLiteral(" LIMIT :limit");
+    }
+    sql += QLatin1Char(';');
+}
+
+void bindPageValues(QSqlQuery& query, const AdRepository::AdListFilters& filters)
+{
+    if (filters.after.has_value()) {
+        query.bindValue(QStringLiteral(":after_key"), filters.after->sortKey);
+        query.bindValue(QStringLiteral(":after_id"), filters.after->id);
+    }
+    if (filters.limit > 0) {
+        query.bindValue(QStringLiteral(":limit"), filters.limit);
+    }
+}
+
 QString moderationStatusToDb(AdRepository::AdModerationStatus status)
 {
     switch (status) {
@@ -92,7 +421,9 @@ QString moderationStatusToDb(AdRepository::AdModerationStatus status)
 
 }
 
-SqliteAdRepository::SqliteAdRepository(const QString& databasePath)
+SqliteAdRepository::SqliteAdRepository(const QString& databasePath,
+                                       CatalogVersion* catalogVersion)
+    : catalogVersion_(catalogVersion)
 {
     databasePath_ = databasePath;
     if (databasePath_.isEmpty()) {
@@ -104,6 +435,10 @@ SqliteAdRepository::SqliteAdRepository(const QString& databasePath)
     connectionName_ = QStringLiteral("kalanet_ads_repo_%1")
                           .arg(reinterpret_cast<quintptr>(this));
 
+    const QFileInfo databaseFile(databasePath_);
+    imageStore_ = std::make_unique<ImageStore>(
+        databaseFile.absoluteDir().filePath(databaseFile.completeBaseName() + QStringLiteral("_images")));
+
     db_ = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"),
                                     connectionName_);
     db_.setDatabaseName(databasePath_);
@@ -117,6 +452,7 @@ SqliteAdRepository::SqliteAdRepository(const QString& databasePath)
 
 SqliteAdRepository::~SqliteAdRepository()
 {
+    statements_.clear();
     if (db_.isValid()) {
         db_.close();
     }
@@ -128,12 +464,19 @@ bool SqliteAdRepository::ensureConnection()
     if (db_.isOpen())
         return true;
 
+    statements_.clear();
     if (!db_.open()) {
         throwDatabaseError(QStringLiteral("reopen database"), db_.lastError());
     }
     return true;
 }
 
+StatementCache::Stats SqliteAdRepository::statementStats()
+{
+    QMutexLocker locker(&mutex_);
+    return statements_.stats();
+}
+
 void SqliteAdRepository::initializeSchema()
 {
     QMutexLocker locker(&mutex_);
@@ -166,6 +509,235 @@ void SqliteAdRepository::initializeSchema()
     if (currentSchemaVersion() != kLatestSchemaVersion) {
         throw std::runtime_error("Ad schema migration did not reach latest version");
     }
+
+    backfillImageHashes();
+    moveInlineImagesToStore();
+    purgeUnreferencedImages();
+    initializeFullTextSearch();
+}
+
+// FTS5 is a compile-time option of SQLite, so the index is created outside the
+// numbered migrations; without it searches keep using LIKE.
+void SqliteAdRepository::initializeFullTextSearch()
+{
+    QSqlQuery existing(db_);
+    if (!existing.exec(QStringLiteral(
+            "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'ads_fts';"))) {
+        throwDatabaseError(QStringLiteral("look up full-text index"), existing.lastError());
+    }
+    if (existing.next()) {
+        fullTextSearch_ = true;
+        return;
+    }
+
+    if (!db_.transaction()) {
+        throwDatabaseError(QStringLiteral("begin full-text index creation"), db_.lastError());
+    }
+
+    for (const char* statement : kFullTextStatements) {
+        QSqlQuery query(db_);
+        if (!query.exec(QString::fromUtf8(statement))) {
+            db_.rollback();
+            AuditLogger::log(QStringLiteral("ads.fulltext"), QStringLiteral("failed"),
+                             QJsonObject{{QStringLiteral("reason"), QStringLiteral("unavailable_using_like")},
+                                         {QStringLiteral("error"), query.lastError().text()}});
+            return;
+        }
+    }
+
+    if (!db_.commit()) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("commit full-text index creation"), db_.lastError());
+    }
+    fullTextSearch_ = true;
+}
+
+// SQLite has no SHA-256, so rows migrated with an image get their hash here.
+// Runs once per row; new ads are hashed on insert.
+void SqliteAdRepository::backfillImageHashes()
+{
+    QSqlQuery pending(db_);
+    pending.setForwardOnly(true);
+    if (!pending.exec(QStringLiteral(
+            "SELECT id FROM ads WHERE has_image = 1 AND image_sha256 IS NULL;"))) {
+        throwDatabaseError(QStringLiteral("find ads without image hash"), pending.lastError());
+    }
+
+    QVector<int> adIds;
+    while (pending.next()) {
+        adIds.append(pending.value(0).toInt());
+    }
+    if (adIds.isEmpty()) {
+        return;
+    }
+
+    if (!db_.transaction()) {
+        throwDatabaseError(QStringLiteral("begin image hash backfill"), db_.lastError());
+    }
+
+    QSqlQuery select(db_);
+    select.prepare(QStringLiteral("SELECT image_bytes FROM ad_images WHERE ad_id = :id;"));
+    QSqlQuery update(db_);
+    update.prepare(QStringLiteral("UPDATE ads SET image_sha256 = :hash WHERE id = :id;"));
+    for (const int adId : std::as_const(adIds)) {
+        select.bindValue(QStringLiteral(":id"), adId);
+        if (!select.exec() || !select.next()) {
+            db_.rollback();
+            throwDatabaseError(QStringLiteral("read image for hash backfill"), select.lastError());
+        }
+        const QString hash = ImageStore::sha256Hex(select.value(0).toByteArray());
+        select.finish();
+
+        update.bindValue(QStringLiteral(":hash"), hash);
+        update.bindValue(QStringLiteral(":id"), adId);
+        if (!update.exec()) {
+            db_.rollback();
+            throwDatabaseError(QStringLiteral("store image hash"), update.lastError());
+        }
+    }
+
+    if (!db_.commit()) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("commit image hash backfill"), db_.lastError());
+    }
+}
+
+// Images used to live in ads.image_bytes and were parked in ad_images by
+// the migrations. Each one is written to the image store, its row is
+// deleted, and reference counts are recomputed once at the end; the
+// database is then vacuumed to hand the blob pages back.
+void SqliteAdRepository::moveInlineImagesToStore()
+{
+    QSqlQuery pending(db_);
+    pending.setForwardOnly(true);
+    if (!pending.exec(QStringLiteral("SELECT ad_id FROM ad_images;"))) {
+        throwDatabaseError(QStringLiteral("find inline images"), pending.lastError());
+    }
+
+    QVector<int> adIds;
+    while (pending.next()) {
+        adIds.append(pending.value(0).toInt());
+    }
+    if (adIds.isEmpty()) {
+        return;
+    }
+
+    if (!db_.transaction()) {
+        throwDatabaseError(QStringLiteral("begin inline image move"), db_.lastError());
+    }
+
+    QSqlQuery select(db_);
+    select.prepare(QStringLiteral("SELECT image_bytes FROM ad_images WHERE ad_id = :id;"));
+    QSqlQuery insertBlob(db_);
+    insertBlob.prepare(QStringLiteral(
+        "INSERT OR IGNORE INTO image_blobs (sha256, size_bytes) VALUES (:sha256, :size);"));
+    QSqlQuery update(db_);
+    update.prepare(QStringLiteral("UPDATE ads SET image_sha256 = :sha256 WHERE id = :id;"));
+    QSqlQuery removeInline(db_);
+    removeInline.prepare(QStringLiteral("DELETE FROM ad_images WHERE ad_id = :id;"));
+    for (const int adId : std::as_const(adIds)) {
+        select.bindValue(QStringLiteral(":id"), adId);
+        if (!select.exec() || !select.next()) {
+            db_.rollback();
+            throwDatabaseError(QStringLiteral("read inline image"), select.lastError());
+        }
+        const QByteArray imageBytes = select.value(0).toByteArray();
+        select.finish();
+
+        QString sha256;
+        try {
+            sha256 = imageStore_->put(imageBytes);
+        } catch (const std::exception&) {
+            db_.rollback();
+            throw;
+        }
+
+        if (!sha256.isEmpty()) {
+            insertBlob.bindValue(QStringLiteral(":sha256"), sha256);
+            insertBlob.bindValue(QStringLiteral(":size"), static_cast<qint64>(imageBytes.size()));
+            if (!insertBlob.exec()) {
+                db_.rollback();
+                throwDatabaseError(QStringLiteral("record moved image"), insertBlob.lastError());
+            }
+        }
+
+        update.bindValue(QStringLiteral(":sha256"), sha256.isEmpty() ? QVariant() : QVariant(sha256));
+        update.bindValue(QStringLiteral(":id"), adId);
+        if (!update.exec()) {
+            db_.rollback();
+            throwDatabaseError(QStringLiteral("store moved image hash"), update.lastError());
+        }
+
+        removeInline.bindValue(QStringLiteral(":id"), adId);
+        if (!removeInline.exec()) {
+            db_.rollback();
+            throwDatabaseError(QStringLiteral("clear inline image"), removeInline.lastError());
+        }
+    }
+
+    QSqlQuery recount(db_);
+    if (!recount.exec(QStringLiteral(
+            "UPDATE image_blobs SET ref_count = "
+            "(SELECT COUNT(1) FROM ads WHERE ads.image_sha256 = image_blobs.sha256);"))) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("recount image references"), recount.lastError());
+    }
+
+    if (!db_.commit()) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("commit inline image move"), db_.lastError());
+    }
+
+    QSqlQuery vacuum(db_);
+    if (!vacuum.exec(QStringLiteral("VACUUM;"))) {
+        AuditLogger::log(QStringLiteral("ads.vacuum"), QStringLiteral("failed"),
+                         QJsonObject{{QStringLiteral("error"), vacuum.lastError().text()}});
+    }
+}
+
+// Files whose last referencing ad is gone are removed at startup, after the
+// rows, so a crash in between leaves at worst an unreferenced file. Files are
+// written before the transaction that records them, so a rollback or crash
+// also leaves files without a row; the store is swept for those last.
+void SqliteAdRepository::purgeUnreferencedImages()
+{
+    QSqlQuery orphans(db_);
+    orphans.setForwardOnly(true);
+    if (!orphans.exec(QStringLiteral("SELECT sha256 FROM image_blobs WHERE ref_count <= 0;"))) {
+        throwDatabaseError(QStringLiteral("find unreferenced images"), orphans.lastError());
+    }
+
+    QStringList hashes;
+    while (orphans.next()) {
+        hashes.append(orphans.value(0).toString());
+    }
+
+    QSqlQuery remove(db_);
+    remove.prepare(QStringLiteral("DELETE FROM image_blobs WHERE sha256 = :sha256 AND ref_count <= 0;"));
+    for (const QString& sha256 : std::as_const(hashes)) {
+        remove.bindValue(QStringLiteral(":sha256"), sha256);
+        if (!remove.exec()) {
+            throwDatabaseError(QStringLiteral("delete unreferenced image"), remove.lastError());
+        }
+        imageStore_->remove(sha256);
+    }
+
+    QSqlQuery recorded(db_);
+    recorded.setForwardOnly(true);
+    if (!recorded.exec(QStringLiteral("SELECT sha256 FROM image_blobs;"))) {
+        throwDatabaseError(QStringLiteral("list recorded images"), recorded.lastError());
+    }
+    QSet<QString> known;
+    while (recorded.next()) {
+        known.insert(recorded.value(0).toString());
+    }
+
+    const QSet<QString> stored = imageStore_->listHashes();
+    for (const QString& sha256 : stored) {
+        if (!known.contains(sha256)) {
+            imageStore_->remove(sha256);
+        }
+    }
 }
 
 int SqliteAdRepository::currentSchemaVersion()
@@ -218,35 +790,71 @@ int SqliteAdRepository::createPendingAd(const NewAd& ad)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
+    // The file goes in first; if the insert below fails it is left
+    // unreferenced and removed at the next startup.
+    const QString imageHash = imageStore_->put(ad.imageBytes);
+
     if (!db_.transaction()) {
         throwDatabaseError(QStringLiteral("begin createPendingAd transaction"),
                            db_.lastError());
     }
 
-    QSqlQuery insertAd(db_);
-    insertAd.prepare(QStringLiteral(
+    // The first spelling of a category becomes its canonical name; later ads
+    // differing only in case share the row.
+    auto insertCategory = statements_.prepare(QStringLiteral("INSERT OR IGNORE INTO categories (name) VALUES (:name);"));
+    insertCategory->bindValue(QStringLiteral(":name"), ad.category.trimmed());
+    if (!insertCategory->exec()) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("insert category"), insertCategory->lastError());
+    }
+
+    auto category = statements_.prepare(QStringLiteral("SELECT id, name FROM categories WHERE name = :name;"));
+    category->bindValue(QStringLiteral(":name"), ad.category.trimmed());
+    if (!category->exec() || !category->next()) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("resolve category"), category->lastError());
+    }
+    const int categoryId = category->value(0).toInt();
+    const QString categoryName = category->value(1).toString();
+    category->finish();
+
+    if (!imageHash.isEmpty()) {
+        auto insertBlob = statements_.prepare(QStringLiteral(
+            "INSERT OR IGNORE INTO image_blobs (sha256, size_bytes) VALUES (:sha256, :size);"));
+        insertBlob->bindValue(QStringLiteral(":sha256"), imageHash);
+        insertBlob->bindValue(QStringLiteral(":size"), static_cast<qint64>(ad.imageBytes.size()));
+        if (!insertBlob->exec()) {
+            db_.rollback();
+            throwDatabaseError(QStringLiteral("insert image blob"), insertBlob->lastError());
+        }
+    }
+
+    auto insertAd = statements_.prepare(QStringLiteral(
         "INSERT INTO ads ("
-        "    title, description, category, price_tokens,"
-        "    seller_username, image_bytes, status"
+        "    title, description, category, category_id, price_tokens,"
+        "    seller_username, has_image, image_size, image_sha256, status"
         ") VALUES ("
-        "    :title, :description, :category, :price_tokens,"
-        "    :seller_username, :image_bytes, :status"
+        "    :title, :description, :category, :category_id, :price_tokens,"
+        "    :seller_username, :has_image, :image_size, :image_sha256, :status"
         ");"));
 
-    insertAd.bindValue(QStringLiteral(":title"), ad.title);
-    insertAd.bindValue(QStringLiteral(":description"), ad.description);
-    insertAd.bindValue(QStringLiteral(":category"), ad.category);
-    insertAd.bindValue(QStringLiteral(":price_tokens"), ad.priceTokens);
-    insertAd.bindValue(QStringLiteral(":seller_username"), ad.sellerUsername);
-    insertAd.bindValue(QStringLiteral(":image_bytes"), ad.imageBytes);
-    insertAd.bindValue(QStringLiteral(":status"), QStringLiteral("pending"));
-
-    if (!insertAd.exec()) {
+    insertAd->bindValue(QStringLiteral(":title"), ad.title);
+    insertAd->bindValue(QStringLiteral(":description"), ad.description);
+    insertAd->bindValue(QStringLiteral(":category"), categoryName);
+    insertAd->bindValue(QStringLiteral(":category_id"), categoryId);
+    insertAd->bindValue(QStringLiteral(":price_tokens"), ad.priceTokens);
+    insertAd->bindValue(QStringLiteral(":seller_username"), ad.sellerUsername);
+    insertAd->bindValue(QStringLiteral(":has_image"), ad.imageBytes.isEmpty() ? 0 : 1);
+    insertAd->bindValue(QStringLiteral(":image_size"), static_cast<qint64>(ad.imageBytes.size()));
+    insertAd->bindValue(QStringLiteral(":image_sha256"), imageHash.isEmpty() ? QVariant() : QVariant(imageHash));
+    insertAd->bindValue(QStringLiteral(":status"), QStringLiteral("pending"));
+
+    if (!insertAd->exec()) {
         db_.rollback();
-        throwDatabaseError(QStringLiteral("insert ad"), insertAd.lastError());
+        throwDatabaseError(QStringLiteral("insert ad"), insertAd->lastError());
     }
 
-    const QVariant adIdVariant = insertAd.lastInsertId();
+    const QVariant adIdVariant = insertAd->lastInsertId();
     if (!adIdVariant.isValid()) {
         db_.rollback();
         throw std::runtime_error("Failed to resolve inserted ad ID");
@@ -254,18 +862,17 @@ int SqliteAdRepository::createPendingAd(const NewAd& ad)
 
     const int adId = adIdVariant.toInt();
 
-    QSqlQuery insertHistory(db_);
-    insertHistory.prepare(QStringLiteral(
+    auto insertHistory = statements_.prepare(QStringLiteral(
         "INSERT INTO ad_status_history (ad_id, previous_status, new_status, reason) "
         "VALUES (:ad_id, NULL, :new_status, :reason);"));
-    insertHistory.bindValue(QStringLiteral(":ad_id"), adId);
-    insertHistory.bindValue(QStringLiteral(":new_status"), QStringLiteral("pending"));
-    insertHistory.bindValue(QStringLiteral(":reason"), QStringLiteral("ad created"));
+    insertHistory->bindValue(QStringLiteral(":ad_id"), adId);
+    insertHistory->bindValue(QStringLiteral(":new_status"), QStringLiteral("pending"));
+    insertHistory->bindValue(QStringLiteral(":reason"), QStringLiteral("ad created"));
 
-    if (!insertHistory.exec()) {
+    if (!insertHistory->exec()) {
         db_.rollback();
         throwDatabaseError(QStringLiteral("insert ad status history"),
-                           insertHistory.lastError());
+                           insertHistory->lastError());
     }
 
     if (!db_.commit()) {
@@ -274,6 +881,10 @@ int SqliteAdRepository::createPendingAd(const NewAd& ad)
                            db_.lastError());
     }
 
+    if (catalogVersion_) {
+        catalogVersion_->bump();
+    }
+
     return adId;
 }
 
@@ -284,16 +895,15 @@ QVector<AdRepository::AdSummaryRecord> SqliteAdRepository::listApprovedAds(
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QString sql = QStringLiteral(
-        "SELECT id, title, category, price_tokens, seller_username, status, created_at, updated_at, image_bytes "
-        "FROM ads WHERE status = :status");
+    const QString matchQuery = fullTextSearch_ ? fullTextMatchTerms(filters.nameContains) : QString();
+    QString sql = listSelect(matchQuery) + QStringLiteral(" AND status = :status");
 
-    if (!filters.nameContains.trimmed().isEmpty()) {
+    if (matchQuery.isEmpty() && !filters.nameContains.trimmed().isEmpty()) {
         sql += QStringLiteral(" AND title LIKE :title");
     }
 
     if (!filters.category.trimmed().isEmpty()) {
-        sql += QStringLiteral(" AND LOWER(category) = LOWER(:category)");
+        sql += QLatin1String(kCategoryIdFilter);
     }
 
     if (filters.minPriceTokens > 0) {
@@ -304,87 +914,138 @@ QVector<AdRepository::AdSummaryRecord> SqliteAdRepository::listApprovedAds(
         sql += QStringLiteral(" AND price_tokens <= :max_price");
     }
 
-    const QString sortField = sortFieldToSqlColumn(filters.sortField);
-    const QString sortOrder = filters.sortOrder == AdRepository::SortOrder::Asc
-                                  ? QStringLiteral("ASC")
-                                  : QStringLiteral("DESC");
+    appendPageClauses(sql, filters, !matchQuery.isEmpty());
 
-    sql += QStringLiteral(" ORDER BY %1 %2, id %2;").arg(sortField, sortOrder);
+    auto query = statements_.prepare(sql);
+    query->bindValue(QStringLiteral(":status"), QStringLiteral("approved"));
 
-    QSqlQuery query(db_);
-    query.prepare(sql);
-    query.bindValue(QStringLiteral(":status"), QStringLiteral("approved"));
-
-    if (!filters.nameContains.trimmed().isEmpty()) {
-        query.bindValue(QStringLiteral(":title"), QStringLiteral("%") + filters.nameContains.trimmed() + QStringLiteral("%"));
+    if (!matchQuery.isEmpty()) {
+        query->bindValue(QStringLiteral(":match"), matchQuery);
+    } else if (!filters.nameContains.trimmed().isEmpty()) {
+        query->bindValue(QStringLiteral(":title"), QStringLiteral("%") + filters.nameContains.trimmed() + QStringLiteral("%"));
     }
 
     if (!filters.category.trimmed().isEmpty()) {
-        query.bindValue(QStringLiteral(":category"), filters.category.trimmed());
+        query->bindValue(QStringLiteral(":category"), filters.category.trimmed());
     }
 
     if (filters.minPriceTokens > 0) {
-        query.bindValue(QStringLiteral(":min_price"), filters.minPriceTokens);
+        query->bindValue(QStringLiteral(":min_price"), filters.minPriceTokens);
     }
 
     if (filters.maxPriceTokens > 0) {
-        query.bindValue(QStringLiteral(":max_price"), filters.maxPriceTokens);
+        query->bindValue(QStringLiteral(":max_price"), filters.maxPriceTokens);
     }
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("list approved ads"), query.lastError());
+    bindPageValues(*query, filters);
+
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("list approved ads"), query->lastError());
     }
 
     QVector<AdSummaryRecord> ads;
-    while (query.next()) {
-        AdSummaryRecord record;
-        record.id = query.value(0).toInt();
-        record.title = query.value(1).toString();
-        record.category = query.value(2).toString();
-        record.priceTokens = query.value(3).toInt();
-        record.sellerUsername = query.value(4).toString();
-        record.status = query.value(5).toString();
-        record.createdAt = query.value(6).toString();
-        record.updatedAt = query.value(7).toString();
-        record.hasImage = !query.value(8).toByteArray().isEmpty();
+    while (query->next()) {
+        AdSummaryRecord record = readSummaryRecord(*query);
+        record.relevance = query->value(11).toDouble();
         ads.push_back(record);
     }
 
     return ads;
 }
 
+void SqliteAdRepository::countApprovedFacets(const AdListFilters& filters, AdListFacets& facets)
+{
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
+    // One grouped scan over the text matches: every (category, price bucket,
+    // inside price filter) combination with its count, folded into both facets
+    // below. Whether a group is in the selected category is decided in SQL, so
+    // it folds case the same way (NOCASE) as the list's category filter.
+    QString bucket = QStringLiteral("CASE");
+    for (int i = 0; i < facets.priceBounds.size(); ++i) {
+        bucket += QStringLiteral(" WHEN price_tokens < :bound%1 THEN %1").arg(i);
+    }
+    bucket += QStringLiteral(" ELSE %1 END").arg(facets.priceBounds.size());
+
+    const QString category = filters.category.trimmed();
+    const QString matchQuery = fullTextSearch_ ? fullTextMatchTerms(filters.nameContains) : QString();
+    QString sql = QStringLiteral(
+        "SELECT (SELECT name FROM categories WHERE id = ads.category_id), %1, "
+        "price_tokens BETWEEN :min_price AND :max_price, COUNT(*), %3 "
+        "FROM %2 WHERE status = :status")
+        .arg(bucket,
+             QLatin1String(matchQuery.isEmpty() ? "ads" : kRankedFromClause),
+             category.isEmpty() ? QStringLiteral("1")
+                                : QStringLiteral("category_id = (SELECT id FROM categories WHERE name = :category)"));
+    if (matchQuery.isEmpty() && !filters.nameContains.trimmed().isEmpty()) {
+        sql += QStringLiteral(" AND title LIKE :title");
+    }
+    sql += QStringLiteral(" GROUP BY category_id, 2, 3;");
+
+    auto query = statements_.prepare(sql);
+    query->bindValue(QStringLiteral(":status"), QStringLiteral("approved"));
+    query->bindValue(QStringLiteral(":min_price"), qMax(1, filters.minPriceTokens));
+    query->bindValue(QStringLiteral(":max_price"),
+                     filters.maxPriceTokens > 0 ? filters.maxPriceTokens : std::numeric_limits<int>::max());
+    for (int i = 0; i < facets.priceBounds.size(); ++i) {
+        query->bindValue(QStringLiteral(":bound%1").arg(i), facets.priceBounds.at(i));
+    }
+    if (!category.isEmpty()) {
+        query->bindValue(QStringLiteral(":category"), category);
+    }
+    if (!matchQuery.isEmpty()) {
+        query->bindValue(QStringLiteral(":match"), matchQuery);
+    } else if (!filters.nameContains.trimmed().isEmpty()) {
+        query->bindValue(QStringLiteral(":title"), QStringLiteral("%") + filters.nameContains.trimmed() + QStringLiteral("%"));
+    }
+
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("count approved facets"), query->lastError());
+    }
+
+    QHash<QString, int> categoryIndex;
+    facets.categories.clear();
+    facets.priceBucketCounts.fill(0, facets.priceBounds.size() + 1);
+    while (query->next()) {
+        const QString name = query->value(0).toString();
+        const int bucketIndex = query->value(1).toInt();
+        const int count = query->value(3).toInt();
+
+        if (query->value(2).toBool() && !name.isEmpty()) {
+            const auto it = categoryIndex.constFind(name);
+            if (it == categoryIndex.cend()) {
+                categoryIndex.insert(name, facets.categories.size());
+                facets.categories.push_back({name, count});
+            } else {
+                facets.categories[it.value()].count += count;
+            }
+        }
+        if (query->value(4).toBool()) {
+            facets.priceBucketCounts[bucketIndex] += count;
+        }
+    }
+}
+
 std::optional<AdRepository::AdDetailRecord> SqliteAdRepository::findApprovedAdById(int adId)
 {
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
-        "SELECT id, title, description, category, price_tokens, seller_username, image_bytes, status, created_at, updated_at "
-        "FROM ads WHERE id = :id AND status = :status LIMIT 1;"));
-    query.bindValue(QStringLiteral(":id"), adId);
-    query.bindValue(QStringLiteral(":status"), QStringLiteral("approved"));
+    auto query = statements_.prepare(QStringLiteral("SELECT %1 FROM ads WHERE id = :id AND status = :status LIMIT 1;")
+                                         .arg(QLatin1String(kDetailColumns)));
+    query->bindValue(QStringLiteral(":id"), adId);
+    query->bindValue(QStringLiteral(":status"), QStringLiteral("approved"));
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("find approved ad by id"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("find approved ad by id"), query->lastError());
     }
 
-    if (!query.next()) {
+    if (!query->next()) {
         return std::nullopt;
     }
 
-    AdDetailRecord record;
-    record.id = query.value(0).toInt();
-    record.title = query.value(1).toString();
-    record.description = query.value(2).toString();
-    record.category = query.value(3).toString();
-    record.priceTokens = query.value(4).toInt();
-    record.sellerUsername = query.value(5).toString();
-    record.imageBytes = query.value(6).toByteArray();
-    record.status = query.value(7).toString();
-    record.createdAt = query.value(8).toString();
-    record.updatedAt = query.value(9).toString();
-    return record;
+    return readDetailRecord(*query);
 }
 
 
@@ -395,32 +1056,77 @@ std::optional<AdRepository::AdDetailRecord> SqliteAdRepository::findAdById(int a
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
-        "SELECT id, title, description, category, price_tokens, seller_username, image_bytes, status, created_at, updated_at "
-        "FROM ads WHERE id = :id LIMIT 1;"));
-    query.bindValue(QStringLiteral(":id"), adId);
+    auto query = statements_.prepare(QStringLiteral("SELECT %1 FROM ads WHERE id = :id LIMIT 1;")
+                                         .arg(QLatin1String(kDetailColumns)));
+    query->bindValue(QStringLiteral(":id"), adId);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("find ad by id"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("find ad by id"), query->lastError());
     }
 
-    if (!query.next()) {
+    if (!query->next()) {
         return std::nullopt;
     }
 
-    AdDetailRecord record;
-    record.id = query.value(0).toInt();
-    record.title = query.value(1).toString();
-    record.description = query.value(2).toString();
-    record.category = query.value(3).toString();
-    record.priceTokens = query.value(4).toInt();
-    record.sellerUsername = query.value(5).toString();
-    record.imageBytes = query.value(6).toByteArray();
-    record.status = query.value(7).toString();
-    record.createdAt = query.value(8).toString();
-    record.updatedAt = query.value(9).toString();
-    return record;
+    return readDetailRecord(*query);
+}
+
+QVector<AdRepository::AdDetailRecord> SqliteAdRepository::findAdsByIds(const QVector<int>& adIds,
+                                                                       AdFieldSet fields,
+                                                                       bool approvedOnly)
+{
+    QVector<AdDetailRecord> records;
+    if (adIds.isEmpty()) {
+        return records;
+    }
+
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
+    QHash<int, AdDetailRecord> found;
+    found.reserve(adIds.size());
+    for (qsizetype first = 0; first < adIds.size(); first += kMaxIdsPerQuery) {
+        const QVector<int> chunk = adIds.mid(first, kMaxIdsPerQuery);
+
+        QStringList placeholders;
+        placeholders.reserve(chunk.size());
+        for (qsizetype i = 0; i < chunk.size(); ++i) {
+            placeholders.append(QStringLiteral("?"));
+        }
+
+        QString sql = QStringLiteral("SELECT %1 FROM ads WHERE id IN (%2)")
+                          .arg(QLatin1String(fields == AdFieldSet::Detail ? kDetailColumns : kDetailSummaryColumns),
+                               placeholders.join(QLatin1Char(',')));
+        if (approvedOnly) {
+            sql += QStringLiteral(" AND status = 'approved'");
+        }
+        sql += QLatin1Char(';');
+
+        QSqlQuery query(db_);
+        query.setForwardOnly(true);
+        query.prepare(sql);
+        for (const int adId : chunk) {
+            query.addBindValue(adId);
+        }
+
+        if (!query.exec()) {
+            throwDatabaseError(QStringLiteral("findAdsByIds"), query.lastError());
+        }
+
+        while (query.next()) {
+            AdDetailRecord record = readDetailRecord(query);
+            found.insert(record.id, std::move(record));
+        }
+    }
+
+    records.reserve(found.size());
+    for (const int adId : adIds) {
+        const auto it = found.constFind(adId);
+        if (it != found.cend()) {
+            records.push_back(it.value());
+        }
+    }
+    return records;
 }
 
 bool SqliteAdRepository::hasDuplicateActiveAdForSeller(const NewAd& ad)
@@ -428,30 +1134,29 @@ bool SqliteAdRepository::hasDuplicateActiveAdForSeller(const NewAd& ad)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT COUNT(1) "
         "FROM ads "
         "WHERE LOWER(title) = LOWER(:title) "
-        "  AND LOWER(category) = LOWER(:category) "
+        "  AND category_id = (SELECT id FROM categories WHERE name = :category) "
         "  AND price_tokens = :price_tokens "
         "  AND seller_username = :seller_username "
         "  AND status IN ('pending', 'approved', 'sold')"));
 
-    query.bindValue(QStringLiteral(":title"), ad.title.trimmed());
-    query.bindValue(QStringLiteral(":category"), ad.category.trimmed());
-    query.bindValue(QStringLiteral(":price_tokens"), ad.priceTokens);
-    query.bindValue(QStringLiteral(":seller_username"), ad.sellerUsername.trimmed());
+    query->bindValue(QStringLiteral(":title"), ad.title.trimmed());
+    query->bindValue(QStringLiteral(":category"), ad.category.trimmed());
+    query->bindValue(QStringLiteral(":price_tokens"), ad.priceTokens);
+    query->bindValue(QStringLiteral(":seller_username"), ad.sellerUsername.trimmed());
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("detect duplicate ad"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("detect duplicate ad"), query->lastError());
     }
 
-    if (!query.next()) {
+    if (!query->next()) {
         return false;
     }
 
-    return query.value(0).toInt() > 0;
+    return query->value(0).toInt() > 0;
 }
 
 
@@ -465,18 +1170,29 @@ QVector<AdRepository::AdSummaryRecord> SqliteAdRepository::listAdsForModeration(
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QString sql = QStringLiteral(
-        "SELECT id, title, category, price_tokens, seller_username, status, created_at, updated_at, image_bytes "
-        "FROM ads WHERE 1 = 1");
+    const QString titleTerms = fullTextSearch_
+                                   ? fullTextMatchTerms(filters.nameContains, QStringLiteral("title"))
+                                   : QString();
+    const QString textTerms = fullTextSearch_ ? fullTextMatchTerms(fullTextContains) : QString();
+    QStringList matchParts;
+    if (!titleTerms.isEmpty()) {
+        matchParts.append(titleTerms);
+    }
+    if (!textTerms.isEmpty()) {
+        matchParts.append(textTerms);
+    }
+    const QString matchQuery = matchParts.join(QLatin1Char(' '));
+
+    QString sql = listSelect(matchQuery);
 
     if (!statusFilter.trimmed().isEmpty() && statusFilter.compare(QStringLiteral("all"), Qt::CaseInsensitive) != 0) {
         sql += QStringLiteral(" AND status = :status");
     }
-    if (!filters.nameContains.trimmed().isEmpty()) {
+    if (titleTerms.isEmpty() && !filters.nameContains.trimmed().isEmpty()) {
         sql += QStringLiteral(" AND title LIKE :title");
     }
     if (!filters.category.trimmed().isEmpty()) {
-        sql += QStringLiteral(" AND LOWER(category) = LOWER(:category)");
+        sql += QLatin1String(kCategoryIdFilter);
     }
     if (filters.minPriceTokens > 0) {
         sql += QStringLiteral(" AND price_tokens >= :min_price");
@@ -485,62 +1201,53 @@ QVector<AdRepository::AdSummaryRecord> SqliteAdRepository::listAdsForModeration(
         sql += QStringLiteral(" AND price_tokens <= :max_price");
     }
     if (onlyWithImage) {
-        sql += QStringLiteral(" AND image_bytes IS NOT NULL AND length(image_bytes) > 0");
+        sql += QStringLiteral(" AND has_image = 1");
     }
     if (!sellerContains.trimmed().isEmpty()) {
         sql += QStringLiteral(" AND seller_username LIKE :seller");
     }
-    if (!fullTextContains.trimmed().isEmpty()) {
+    if (textTerms.isEmpty() && !fullTextContains.trimmed().isEmpty()) {
         sql += QStringLiteral(" AND (title LIKE :text_query OR description LIKE :text_query)");
     }
 
-    const QString sortField = sortFieldToSqlColumn(filters.sortField);
-    const QString sortOrder = filters.sortOrder == AdRepository::SortOrder::Asc
-                                  ? QStringLiteral("ASC")
-                                  : QStringLiteral("DESC");
-    sql += QStringLiteral(" ORDER BY %1 %2, id %2;").arg(sortField, sortOrder);
+    appendPageClauses(sql, filters, !matchQuery.isEmpty());
 
-    QSqlQuery query(db_);
-    query.prepare(sql);
+    auto query = statements_.prepare(sql);
 
     if (!statusFilter.trimmed().isEmpty() && statusFilter.compare(QStringLiteral("all"), Qt::CaseInsensitive) != 0) {
-        query.bindValue(QStringLiteral(":status"), statusFilter.trimmed().toLower());
+        query->bindValue(QStringLiteral(":status"), statusFilter.trimmed().toLower());
     }
-    if (!filters.nameContains.trimmed().isEmpty()) {
-        query.bindValue(QStringLiteral(":title"), QStringLiteral("%") + filters.nameContains.trimmed() + QStringLiteral("%"));
+    if (!matchQuery.isEmpty()) {
+        query->bindValue(QStringLiteral(":match"), matchQuery);
+    }
+    if (titleTerms.isEmpty() && !filters.nameContains.trimmed().isEmpty()) {
+        query->bindValue(QStringLiteral(":title"), QStringLiteral("%") + filters.nameContains.trimmed() + QStringLiteral("%"));
     }
     if (!filters.category.trimmed().isEmpty()) {
-        query.bindValue(QStringLiteral(":category"), filters.category.trimmed());
+        query->bindValue(QStringLiteral(":category"), filters.category.trimmed());
     }
     if (filters.minPriceTokens > 0) {
-        query.bindValue(QStringLiteral(":min_price"), filters.minPriceTokens);
+        query->bindValue(QStringLiteral(":min_price"), filters.minPriceTokens);
     }
     if (filters.maxPriceTokens > 0) {
-        query.bindValue(QStringLiteral(":max_price"), filters.maxPriceTokens);
+        query->bindValue(QStringLiteral(":max_price"), filters.maxPriceTokens);
     }
     if (!sellerContains.trimmed().isEmpty()) {
-        query.bindValue(QStringLiteral(":seller"), QStringLiteral("%") + sellerContains.trimmed() + QStringLiteral("%"));
+        query->bindValue(QStringLiteral(":seller"), QStringLiteral("%") + sellerContains.trimmed() + QStringLiteral("%"));
     }
-    if (!fullTextContains.trimmed().isEmpty()) {
-        query.bindValue(QStringLiteral(":text_query"), QStringLiteral("%") + fullTextContains.trimmed() + QStringLiteral("%"));
+    if (textTerms.isEmpty() && !fullTextContains.trimmed().isEmpty()) {
+        query->bindValue(QStringLiteral(":text_query"), QStringLiteral("%") + fullTextContains.trimmed() + QStringLiteral("%"));
     }
+    bindPageValues(*query, filters);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("list ads for moderation"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("list ads for moderation"), query->lastError());
     }
 
     QVector<AdSummaryRecord> ads;
-    while (query.next()) {
-        AdSummaryRecord record;
-        record.id = query.value(0).toInt();
-        record.title = query.value(1).toString();
-        record.category = query.value(2).toString();
-        record.priceTokens = query.value(3).toInt();
-        record.sellerUsername = query.value(4).toString();
-        record.status = query.value(5).toString();
-        record.createdAt = query.value(6).toString();
-        record.updatedAt = query.value(7).toString();
-        record.hasImage = !query.value(8).toByteArray().isEmpty();
+    while (query->next()) {
+        AdSummaryRecord record = readSummaryRecord(*query);
+        record.relevance = query->value(11).toDouble();
         ads.push_back(record);
     }
 
@@ -552,23 +1259,22 @@ QVector<AdRepository::AdStatusHistoryRecord> SqliteAdRepository::getStatusHistor
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT previous_status, new_status, reason, changed_at "
         "FROM ad_status_history WHERE ad_id = :ad_id ORDER BY changed_at DESC, id DESC;"));
-    query.bindValue(QStringLiteral(":ad_id"), adId);
+    query->bindValue(QStringLiteral(":ad_id"), adId);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("get ad status history"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("get ad status history"), query->lastError());
     }
 
     QVector<AdStatusHistoryRecord> history;
-    while (query.next()) {
+    while (query->next()) {
         AdStatusHistoryRecord item;
-        item.previousStatus = query.value(0).toString();
-        item.newStatus = query.value(1).toString();
-        item.reason = query.value(2).toString();
-        item.changedAt = query.value(3).toString();
+        item.previousStatus = query->value(0).toString();
+        item.newStatus = query->value(1).toString();
+        item.reason = query->value(2).toString();
+        item.changedAt = query->value(3).toString();
         history.push_back(item);
     }
 
@@ -581,29 +1287,28 @@ QVector<AdRepository::AdTransactionHistoryRecord> SqliteAdRepository::getTransac
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT created_at, type, username, counterparty, amount_tokens, balance_after "
         "FROM transaction_ledger "
         "WHERE ad_id = :ad_id "
         "ORDER BY created_at DESC, id DESC "
         "LIMIT :limit;"));
-    query.bindValue(QStringLiteral(":ad_id"), adId);
-    query.bindValue(QStringLiteral(":limit"), limit > 0 ? limit : 100);
+    query->bindValue(QStringLiteral(":ad_id"), adId);
+    query->bindValue(QStringLiteral(":limit"), limit > 0 ? limit : 100);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("get ad transaction history"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("get ad transaction history"), query->lastError());
     }
 
     QVector<AdTransactionHistoryRecord> records;
-    while (query.next()) {
+    while (query->next()) {
         AdTransactionHistoryRecord record;
-        record.createdAt = query.value(0).toString();
-        record.entryType = query.value(1).toString();
-        record.username = query.value(2).toString();
-        record.counterparty = query.value(3).toString();
-        record.amountTokens = query.value(4).toInt();
-        record.balanceAfter = query.value(5).toInt();
+        record.createdAt = query->value(0).toString();
+        record.entryType = query->value(1).toString();
+        record.username = query->value(2).toString();
+        record.counterparty = query->value(3).toString();
+        record.amountTokens = query->value(4).toInt();
+        record.balanceAfter = query->value(5).toInt();
         records.push_back(record);
     }
 
@@ -627,51 +1332,63 @@ bool SqliteAdRepository::updateStatus(int adId,
         throwDatabaseError(QStringLiteral("begin update ad status transaction"), db_.lastError());
     }
 
-    QSqlQuery currentStatusQuery(db_);
-    currentStatusQuery.prepare(QStringLiteral("SELECT status FROM ads WHERE id = :id LIMIT 1;"));
-    currentStatusQuery.bindValue(QStringLiteral(":id"), adId);
+    auto currentStatusQuery = statements_.prepare(QStringLiteral("SELECT status FROM ads WHERE id = :id LIMIT 1;"));
+    currentStatusQuery->bindValue(QStringLiteral(":id"), adId);
 
-    if (!currentStatusQuery.exec()) {
+    if (!currentStatusQuery->exec()) {
         db_.rollback();
-        throwDatabaseError(QStringLiteral("read current ad status"), currentStatusQuery.lastError());
+        throwDatabaseError(QStringLiteral("read current ad status"), currentStatusQuery->lastError());
     }
 
-    if (!currentStatusQuery.next()) {
+    if (!currentStatusQuery->next()) {
         db_.rollback();
         return false;
     }
 
-    const QString previousStatus = currentStatusQuery.value(0).toString();
+    const QString previousStatus = currentStatusQuery->value(0).toString();
 
-    QSqlQuery updateQuery(db_);
-    updateQuery.prepare(QStringLiteral(
+    auto updateQuery = statements_.prepare(QStringLiteral(
         "UPDATE ads SET status = :new_status, updated_at = CURRENT_TIMESTAMP "
         "WHERE id = :id;"));
-    updateQuery.bindValue(QStringLiteral(":new_status"), newStatusDb);
-    updateQuery.bindValue(QStringLiteral(":id"), adId);
+    updateQuery->bindValue(QStringLiteral(":new_status"), newStatusDb);
+    updateQuery->bindValue(QStringLiteral(":id"), adId);
 
-    if (!updateQuery.exec()) {
+    if (!updateQuery->exec()) {
         db_.rollback();
-        throwDatabaseError(QStringLiteral("update ad status"), updateQuery.lastError());
+        throwDatabaseError(QStringLiteral("update ad status"), updateQuery->lastError());
     }
 
-    if (updateQuery.numRowsAffected() <= 0) {
+    if (updateQuery->numRowsAffected() <= 0) {
         db_.rollback();
         return false;
     }
 
-    QSqlQuery insertHistory(db_);
-    insertHistory.prepare(QStringLiteral(
+    auto insertHistory = statements_.prepare(QStringLiteral(
         "INSERT INTO ad_status_history (ad_id, previous_status, new_status, reason) "
         "VALUES (:ad_id, :previous_status, :new_status, :reason);"));
-    insertHistory.bindValue(QStringLiteral(":ad_id"), adId);
-    insertHistory.bindValue(QStringLiteral(":previous_status"), previousStatus);
-    insertHistory.bindValue(QStringLiteral(":new_status"), newStatusDb);
-    insertHistory.bindValue(QStringLiteral(":reason"), reason.trimmed());
+    insertHistory->bindValue(QStringLiteral(":ad_id"), adId);
+    insertHistory->bindValue(QStringLiteral(":previous_status"), previousStatus);
+    insertHistory->bindValue(QStringLiteral(":new_status"), newStatusDb);
+    insertHistory->bindValue(QStringLiteral(":reason"), reason.trimmed());
 
-    if (!insertHistory.exec()) {
+    if (!insertHistory->exec()) {
         db_.rollback();
-        throwDatabaseError(QStringLiteral("insert ad status update history"), insertHistory.lastError());
+        throwDatabaseError(QStringLiteral("insert ad status update history"), insertHistory->lastError());
+    }
+
+    // Read before committing, so nothing after the commit can fail and leave
+    // the catalog index behind a change that was already written.
+    std::optional<AdSummaryRecord> listed;
+    if (catalogVersion_ && newStatus == AdModerationStatus::Approved) {
+        auto approved = statements_.prepare(QStringLiteral("SELECT %1 FROM ads WHERE id = :id;")
+                                                .arg(QLatin1String(kSummaryColumns)));
+        approved->bindValue(QStringLiteral(":id"), adId);
+        if (!approved->exec() || !approved->next()) {
+            db_.rollback();
+            throwDatabaseError(QStringLiteral("read approved ad"), approved->lastError());
+        }
+        listed = readSummaryRecord(*approved);
+        approved->finish();
     }
 
     if (!db_.commit()) {
@@ -679,6 +1396,14 @@ bool SqliteAdRepository::updateStatus(int adId,
         throwDatabaseError(QStringLiteral("commit ad status update transaction"), db_.lastError());
     }
 
+    if (catalogVersion_) {
+        if (listed.has_value()) {
+            catalogVersion_->adListed(*listed);
+        } else {
+            catalogVersion_->adUnlisted(adId);
+        }
+    }
+
     return true;
 }
 
@@ -697,38 +1422,26 @@ QVector<AdRepository::AdSummaryRecord> SqliteAdRepository::listAdsBySeller(const
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QString sql = QStringLiteral(
-        "SELECT id, title, category, price_tokens, seller_username, status, created_at, updated_at, image_bytes "
-        "FROM ads WHERE seller_username = :seller_username");
+    QString sql = QStringLiteral("SELECT %1 FROM ads WHERE seller_username = :seller_username")
+                      .arg(QLatin1String(kSummaryColumns));
     if (!statusFilter.trimmed().isEmpty()) {
         sql += QStringLiteral(" AND status = :status");
     }
     sql += QStringLiteral(" ORDER BY created_at DESC, id DESC;");
 
-    QSqlQuery query(db_);
-    query.prepare(sql);
-    query.bindValue(QStringLiteral(":seller_username"), sellerUsername.trimmed());
+    auto query = statements_.prepare(sql);
+    query->bindValue(QStringLiteral(":seller_username"), sellerUsername.trimmed());
     if (!statusFilter.trimmed().isEmpty()) {
-        query.bindValue(QStringLiteral(":status"), statusFilter.trimmed().toLower());
+        query->bindValue(QStringLiteral(":status"), statusFilter.trimmed().toLower());
     }
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("listAdsBySeller"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("listAdsBySeller"), query->lastError());
     }
 
     QVector<AdSummaryRecord> ads;
-    while (query.next()) {
-        AdSummaryRecord record;
-        record.id = query.value(0).toInt();
-        record.title = query.value(1).toString();
-        record.category = query.value(2).toString();
-        record.priceTokens = query.value(3).toInt();
-        record.sellerUsername = query.value(4).toString();
-        record.status = query.value(5).toString();
-        record.createdAt = query.value(6).toString();
-        record.updatedAt = query.value(7).toString();
-        record.hasImage = !query.value(8).toByteArray().isEmpty();
-        ads.push_back(record);
+    while (query->next()) {
+        ads.push_back(readSummaryRecord(*query));
     }
 
     return ads;
@@ -740,33 +1453,23 @@ QVector<AdRepository::AdSummaryRecord> SqliteAdRepository::listPurchasedAdsByBuy
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
-        "SELECT a.id, a.title, a.category, a.price_tokens, a.seller_username, a.status, tl.created_at, a.updated_at, a.image_bytes "
+    auto query = statements_.prepare(QStringLiteral(
+        "SELECT a.id, a.title, a.category, a.price_tokens, a.seller_username, a.status, tl.created_at, a.updated_at, "
+        "a.has_image, a.image_size, a.image_sha256 "
         "FROM transaction_ledger tl "
         "JOIN ads a ON a.id = tl.ad_id "
         "WHERE tl.username = :username AND tl.type = 'purchase_debit' "
         "ORDER BY tl.created_at DESC, tl.id DESC LIMIT :limit;"));
-    query.bindValue(QStringLiteral(":username"), buyerUsername.trimmed());
-    query.bindValue(QStringLiteral(":limit"), limit > 0 ? limit : 100);
+    query->bindValue(QStringLiteral(":username"), buyerUsername.trimmed());
+    query->bindValue(QStringLiteral(":limit"), limit > 0 ? limit : 100);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("listPurchasedAdsByBuyer"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("listPurchasedAdsByBuyer"), query->lastError());
     }
 
     QVector<AdSummaryRecord> ads;
-    while (query.next()) {
-        AdSummaryRecord record;
-        record.id = query.value(0).toInt();
-        record.title = query.value(1).toString();
-        record.category = query.value(2).toString();
-        record.priceTokens = query.value(3).toInt();
-        record.sellerUsername = query.value(4).toString();
-        record.status = query.value(5).toString();
-        record.createdAt = query.value(6).toString();
-        record.updatedAt = query.value(7).toString();
-        record.hasImage = !query.value(8).toByteArray().isEmpty();
-        ads.push_back(record);
+    while (query->next()) {
+        ads.push_back(readSummaryRecord(*query));
     }
 
     return ads;
@@ -814,3 +1517,49 @@ AdRepository::SalesTotals SqliteAdRepository::getSalesTotals()
 
     return totals;
 }
+
+// Counts are maintained by triggers on ads, so this never scans the ads table.
+QVector<AdRepository::CategoryRecord> SqliteAdRepository::listCategories()
+{
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
+    QSqlQuery query(db_);
+    if (!query.exec(QStringLiteral(
+            "SELECT id, name, ad_count, approved_count FROM categories ORDER BY name;"))) {
+        throwDatabaseError(QStringLiteral("listCategories"), query.lastError());
+    }
+
+    QVector<CategoryRecord> categories;
+    while (query.next()) {
+        CategoryRecord record;
+        record.id = query.value(0).toInt();
+        record.name = query.value(1).toString();
+        record.adCount = query.value(2).toInt();
+        record.approvedCount = query.value(3).toInt();
+        categories.push_back(record);
+    }
+
+    return categories;
+}
+
+std::optional<ImageStore::MappedImage> SqliteAdRepository::openImage(const QString& sha256)
+{
+    if (sha256.isEmpty()) {
+        return std::nullopt;
+    }
+    return imageStore_->map(sha256);
+}
+
+std::optional<ImageStore::MappedImage> SqliteAdRepository::openThumbnail(const QString& sha256)
+{
+    if (sha256.isEmpty()) {
+        return std::nullopt;
+    }
+    return imageStore_->mapThumbnail(sha256);
+}
+
+void SqliteAdRepository::storeThumbnail(const QString& sha256, const QByteArray& bytes)
+{
+    imageStore_->putThumbnail(sha256, bytes);
+}
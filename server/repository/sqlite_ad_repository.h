@@ -2,23 +2,32 @@
 #define SQLITE_AD_REPOSITORY_H
 
 #include "ad_repository.h"
+#include "image_store.h"
+#include "statement_cache.h"
 
 #include <QMutex>
 #include <QSqlDatabase>
 #include <QSqlError>
 
+#include <memory>
 #include <optional>
 
+class CatalogVersion;
+
 class SqliteAdRepository : public AdRepository
 {
 public:
-    explicit SqliteAdRepository(const QString& databasePath = QString());
+    explicit SqliteAdRepository(const QString& databasePath = QString(),
+                                CatalogVersion* catalogVersion = nullptr);
     ~SqliteAdRepository() override;
 
     int createPendingAd(const NewAd& ad) override;
     QVector<AdSummaryRecord> listApprovedAds(const AdListFilters& filters) override;
     std::optional<AdDetailRecord> findApprovedAdById(int adId) override;
     std::optional<AdDetailRecord> findAdById(int adId) override;
+    QVector<AdDetailRecord> findAdsByIds(const QVector<int>& adIds,
+                                         AdFieldSet fields,
+                                         bool approvedOnly) override;
     bool hasDuplicateActiveAdForSeller(const NewAd& ad) override;
     bool updateStatus(int adId,
                       AdModerationStatus newStatus,
@@ -34,11 +43,23 @@ public:
     QVector<AdSummaryRecord> listPurchasedAdsByBuyer(const QString& buyerUsername, int limit) override;
     AdStatusCounts getAdStatusCounts() override;
     SalesTotals getSalesTotals() override;
+    QVector<CategoryRecord> listCategories() override;
+    void countApprovedFacets(const AdListFilters& filters, AdListFacets& facets) override;
+    std::optional<ImageStore::MappedImage> openImage(const QString& sha256) override;
+    std::optional<ImageStore::MappedImage> openThumbnail(const QString& sha256) override;
+    void storeThumbnail(const QString& sha256, const QByteArray& bytes) override;
+
+    // Prepared statement reuse on this repository's connection.
+    StatementCache::Stats statementStats();
 
 private:
     bool ensureConnection();
     void initializeSchema();
     int currentSchemaVersion();
+    void backfillImageHashes();
+    void moveInlineImagesToStore();
+    void purgeUnreferencedImages();
+    void initializeFullTextSearch();
     void applyMigration(int version, const char* statement);
     [[noreturn]] void throwDatabaseError(const QString& context,
                                          const QSqlError& error) const;
@@ -47,6 +68,10 @@ private:
     QString connectionName_;
     QString databasePath_;
     QMutex mutex_;
+    StatementCache statements_{db_};
+    CatalogVersion* catalogVersion_ = nullptr;
+    std::unique_ptr<ImageStore> imageStore_;
+    bool fullTextSearch_ = false;
 };
 
 #endif // SQLITE_AD_REPOSITORY_H
@@ -32,6 +32,7 @@ SqliteCartRepository::SqliteCartRepository(const QString& databasePath)
 
 SqliteCartRepository::~SqliteCartRepository()
 {
+    statements_.clear();
     if (db_.isValid()) {
         db_.close();
     }
@@ -44,12 +45,19 @@ bool SqliteCartRepository::ensureConnection()
         return true;
     }
 
+    statements_.clear();
     if (!db_.open()) {
         throwDatabaseError(QStringLiteral("reopen database"), db_.lastError());
     }
     return true;
 }
 
+StatementCache::Stats SqliteCartRepository::statementStats()
+{
+    QMutexLocker locker(&mutex_);
+    return statements_.stats();
+}
+
 void SqliteCartRepository::initializeSchema()
 {
     QMutexLocker locker(&mutex_);
@@ -79,17 +87,16 @@ bool SqliteCartRepository::addItem(const QString& username, int adId)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "INSERT OR IGNORE INTO cart_items (username, ad_id) VALUES (:username, :ad_id);"));
-    query.bindValue(QStringLiteral(":username"), username.trimmed());
-    query.bindValue(QStringLiteral(":ad_id"), adId);
+    query->bindValue(QStringLiteral(":username"), username.trimmed());
+    query->bindValue(QStringLiteral(":ad_id"), adId);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("add cart item"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("add cart item"), query->lastError());
     }
 
-    return query.numRowsAffected() > 0;
+    return query->numRowsAffected() > 0;
 }
 
 bool SqliteCartRepository::removeItem(const QString& username, int adId)
@@ -97,17 +104,16 @@ bool SqliteCartRepository::removeItem(const QString& username, int adId)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "DELETE FROM cart_items WHERE username = :username AND ad_id = :ad_id;"));
-    query.bindValue(QStringLiteral(":username"), username.trimmed());
-    query.bindValue(QStringLiteral(":ad_id"), adId);
+    query->bindValue(QStringLiteral(":username"), username.trimmed());
+    query->bindValue(QStringLiteral(":ad_id"), adId);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("remove cart item"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("remove cart item"), query->lastError());
     }
 
-    return query.numRowsAffected() > 0;
+    return query->numRowsAffected() > 0;
 }
 
 QVector<int> SqliteCartRepository::listItems(const QString& username)
@@ -115,18 +121,17 @@ QVector<int> SqliteCartRepository::listItems(const QString& username)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT ad_id FROM cart_items WHERE username = :username ORDER BY created_at DESC, ad_id DESC;"));
-    query.bindValue(QStringLiteral(":username"), username.trimmed());
+    query->bindValue(QStringLiteral(":username"), username.trimmed());
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("list cart items"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("list cart items"), query->lastError());
     }
 
     QVector<int> adIds;
-    while (query.next()) {
-        adIds.push_back(query.value(0).toInt());
+    while (query->next()) {
+        adIds.push_back(query->value(0).toInt());
     }
     return adIds;
 }
@@ -136,15 +141,14 @@ int SqliteCartRepository::clearItems(const QString& username)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral("DELETE FROM cart_items WHERE username = :username;"));
-    query.bindValue(QStringLiteral(":username"), username.trimmed());
+    auto query = statements_.prepare(QStringLiteral("DELETE FROM cart_items WHERE username = :username;"));
+    query->bindValue(QStringLiteral(":username"), username.trimmed());
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("clear cart items"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("clear cart items"), query->lastError());
     }
 
-    return query.numRowsAffected();
+    return query->numRowsAffected();
 }
 
 bool SqliteCartRepository::hasItem(const QString& username, int adId)
@@ -152,17 +156,16 @@ bool SqliteCartRepository::hasItem(const QString& username, int adId)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT 1 FROM cart_items WHERE username = :username AND ad_id = :ad_id LIMIT 1;"));
-    query.bindValue(QStringLiteral(":username"), username.trimmed());
-    query.bindValue(QStringLiteral(":ad_id"), adId);
+    query->bindValue(QStringLiteral(":username"), username.trimmed());
+    query->bindValue(QStringLiteral(":ad_id"), adId);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("check cart item"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("check cart item"), query->lastError());
     }
 
-    return query.next();
+    return query->next();
 }
 
 [[noreturn]] void SqliteCartRepository::throwDatabaseError(
@@ -2,6 +2,7 @@
 #define SQLITE_CART_REPOSITORY_H
 
 #include "cart_repository.h"
+#include "statement_cache.h"
 
 #include <QMutex>
 #include <QSqlDatabase>
@@ -19,6 +20,9 @@ public:
     int clearItems(const QString& username) override;
     bool hasItem(const QString& username, int adId) override;
 
+    // Prepared statement reuse on this repository's connection.
+    StatementCache::Stats statementStats();
+
 private:
     bool ensureConnection();
     void initializeSchema();
@@ -29,6 +33,7 @@ private:
     QString connectionName_;
     QString databasePath_;
     QMutex mutex_;
+    StatementCache statements_{db_};
 };
 
 #endif // SQLITE_CART_REPOSITORY_H
@@ -0,0 +1,277 @@
+#include "sqlite_session_repository.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+#include <stdexcept>
+
+SqliteSessionRepository::SqliteSessionRepository(const QString& databasePath)
+{
+    databasePath_ = databasePath;
+    if (databasePath_.isEmpty()) {
+        databasePath_ = QCoreApplication::applicationDirPath()
+                        + QDir::separator()
+                        + QStringLiteral("kalanet.db");
+    }
+
+    connectionName_ = QStringLiteral("kalanet_session_repo_%1")
+                          .arg(reinterpret_cast<quintptr>(this));
+
+    db_ = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName_);
+    db_.setDatabaseName(databasePath_);
+
+    if (!db_.open()) {
+        throwDatabaseError(QStringLiteral("open database"), db_.lastError());
+    }
+
+    initializeSchema();
+}
+
+SqliteSessionRepository::~SqliteSessionRepository()
+{
+    statements_.clear();
+    if (db_.isValid()) {
+        db_.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName_);
+}
+
+bool SqliteSessionRepository::ensureConnection()
+{
+    if (db_.isOpen()) {
+        return true;
+    }
+
+    statements_.clear();
+    if (!db_.open()) {
+        throwDatabaseError(QStringLiteral("reopen database"), db_.lastError());
+    }
+    return true;
+}
+
+StatementCache::Stats SqliteSessionRepository::statementStats()
+{
+    QMutexLocker locker(&mutex_);
+    return statements_.stats();
+}
+
+void SqliteSessionRepository::initializeSchema()
+{
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
+    migratePlaintextTokens();
+
+    QSqlQuery create(db_);
+    if (!create.exec(QStringLiteral(
+            "CREATE TABLE IF NOT EXISTS sessions ("
+            "  token_hash TEXT PRIMARY KEY,"
+            "  username TEXT NOT NULL,"
+            "  role TEXT NOT NULL,"
+            "  created_at INTEGER NOT NULL"
+            ");"))) {
+        throwDatabaseError(QStringLiteral("create sessions table"), create.lastError());
+    }
+
+    QSqlQuery createIndex(db_);
+    if (!createIndex.exec(QStringLiteral(
+            "CREATE INDEX IF NOT EXISTS idx_sessions_created_at ON sessions(created_at);"))) {
+        throwDatabaseError(QStringLiteral("create sessions index"), createIndex.lastError());
+    }
+}
+
+// Tables written before tokens were hashed key sessions by the token itself.
+// Rows are rehashed into a fresh table so no plaintext token survives.
+void SqliteSessionRepository::migratePlaintextTokens()
+{
+    QSqlQuery columns(db_);
+    if (!columns.exec(QStringLiteral("PRAGMA table_info(sessions);"))) {
+        throwDatabaseError(QStringLiteral("inspect sessions table"), columns.lastError());
+    }
+    bool plaintext = false;
+    while (columns.next()) {
+        if (columns.value(1).toString() == QStringLiteral("token")) {
+            plaintext = true;
+        }
+    }
+    columns.finish();
+    if (!plaintext) {
+        return;
+    }
+
+    if (!db_.transaction()) {
+        throwDatabaseError(QStringLiteral("begin session token migration"), db_.lastError());
+    }
+
+    const auto run = [this](const QString& sql, const QString& context) {
+        QSqlQuery query(db_);
+        if (!query.exec(sql)) {
+            const QSqlError error = query.lastError();
+            db_.rollback();
+            throwDatabaseError(context, error);
+        }
+    };
+
+    run(QStringLiteral("DROP INDEX IF EXISTS idx_sessions_created_at;"),
+        QStringLiteral("drop plaintext sessions index"));
+    run(QStringLiteral("ALTER TABLE sessions RENAME TO sessions_plaintext;"),
+        QStringLiteral("rename plaintext sessions"));
+    run(QStringLiteral(
+            "CREATE TABLE sessions ("
+            "  token_hash TEXT PRIMARY KEY,"
+            "  username TEXT NOT NULL,"
+            "  role TEXT NOT NULL,"
+            "  created_at INTEGER NOT NULL"
+            ");"),
+        QStringLiteral("create hashed sessions table"));
+
+    QSqlQuery select(db_);
+    select.setForwardOnly(true);
+    if (!select.exec(QStringLiteral("SELECT token, username, role, created_at FROM sessions_plaintext;"))) {
+        const QSqlError error = select.lastError();
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("read plaintext sessions"), error);
+    }
+
+    QSqlQuery insert(db_);
+    insert.prepare(QStringLiteral(
+        "INSERT OR REPLACE INTO sessions (token_hash, username, role, created_at) "
+        "VALUES (:token_hash, :username, :role, :created_at);"));
+    while (select.next()) {
+        insert.bindValue(QStringLiteral(":token_hash"), hashToken(select.value(0).toString()));
+        insert.bindValue(QStringLiteral(":username"), select.value(1));
+        insert.bindValue(QStringLiteral(":role"), select.value(2));
+        insert.bindValue(QStringLiteral(":created_at"), select.value(3));
+        if (!insert.exec()) {
+            const QSqlError error = insert.lastError();
+            db_.rollback();
+            throwDatabaseError(QStringLiteral("rehash session token"), error);
+        }
+    }
+    select.finish();
+
+    run(QStringLiteral("DROP TABLE sessions_plaintext;"),
+        QStringLiteral("drop plaintext sessions"));
+
+    if (!db_.commit()) {
+        const QSqlError error = db_.lastError();
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("commit session token migration"), error);
+    }
+}
+
+void SqliteSessionRepository::applyWrites(const QVector<SessionWrite>& writes)
+{
+    if (writes.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
+    if (!db_.transaction()) {
+        throwDatabaseError(QStringLiteral("begin session batch"), db_.lastError());
+    }
+
+    auto upsert = statements_.prepare(QStringLiteral(
+        "INSERT INTO sessions (token_hash, username, role, created_at) "
+        "VALUES (:token_hash, :username, :role, :created_at) "
+        "ON CONFLICT(token_hash) DO UPDATE SET "
+        "  username = excluded.username,"
+        "  role = excluded.role,"
+        "  created_at = excluded.created_at;"));
+
+    auto remove = statements_.prepare(QStringLiteral("DELETE FROM sessions WHERE token_hash = :token_hash;"));
+
+    for (const SessionWrite& write : writes) {
+        QSqlQuery& query = write.remove ? *remove : *upsert;
+        query.bindValue(QStringLiteral(":token_hash"), write.record.tokenHash);
+        if (!write.remove) {
+            query.bindValue(QStringLiteral(":username"), write.record.username);
+            query.bindValue(QStringLiteral(":role"), write.record.role);
+            query.bindValue(QStringLiteral(":created_at"), write.record.createdAt);
+        }
+
+        if (!query.exec()) {
+            const QSqlError error = query.lastError();
+            db_.rollback();
+            throwDatabaseError(QStringLiteral("apply session batch"), error);
+        }
+    }
+
+    if (!db_.commit()) {
+        const QSqlError error = db_.lastError();
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("commit session batch"), error);
+    }
+}
+
+std::optional<SessionRepository::SessionRecord> SqliteSessionRepository::findSession(const QString& tokenHash)
+{
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
+    auto query = statements_.prepare(QStringLiteral(
+        "SELECT token_hash, username, role, created_at FROM sessions WHERE token_hash = :token_hash LIMIT 1;"));
+    query->bindValue(QStringLiteral(":token_hash"), tokenHash);
+
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("find session"), query->lastError());
+    }
+
+    if (!query->next()) {
+        return std::nullopt;
+    }
+
+    SessionRecord record;
+    record.tokenHash = query->value(0).toString();
+    record.username = query->value(1).toString();
+    record.role = query->value(2).toString();
+    record.createdAt = query->value(3).toLongLong();
+    return record;
+}
+
+QVector<QString> SqliteSessionRepository::listTokenHashes()
+{
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
+    auto query = statements_.prepare(QStringLiteral("SELECT token_hash FROM sessions;"));
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("list session hashes"), query->lastError());
+    }
+
+    QVector<QString> hashes;
+    while (query->next()) {
+        hashes.append(query->value(0).toString());
+    }
+    return hashes;
+}
+
+int SqliteSessionRepository::purgeCreatedBefore(qint64 createdBefore)
+{
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
+    auto query = statements_.prepare(QStringLiteral("DELETE FROM sessions WHERE created_at < :created_before;"));
+    query->bindValue(QStringLiteral(":created_before"), createdBefore);
+
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("purge sessions"), query->lastError());
+    }
+
+    return query->numRowsAffected();
+}
+
+[[noreturn]] void SqliteSessionRepository::throwDatabaseError(
+    const QString& context,
+    const QSqlError& error) const
+{
+    const QString message = QStringLiteral("Database error (%1): %2")
+                                .arg(context, error.text());
+    throw std::runtime_error(message.toStdString());
+}
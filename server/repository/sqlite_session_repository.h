@@ -0,0 +1,39 @@
+#ifndef SQLITE_SESSION_REPOSITORY_H
+#define SQLITE_SESSION_REPOSITORY_H
+
+#include "session_repository.h"
+#include "statement_cache.h"
+
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlError>
+
+class SqliteSessionRepository : public SessionRepository
+{
+public:
+    explicit SqliteSessionRepository(const QString& databasePath = QString());
+    ~SqliteSessionRepository() override;
+
+    void applyWrites(const QVector<SessionWrite>& writes) override;
+    std::optional<SessionRecord> findSession(const QString& tokenHash) override;
+    QVector<QString> listTokenHashes() override;
+    int purgeCreatedBefore(qint64 createdBefore) override;
+
+    // Prepared statement reuse on this repository's connection.
+    StatementCache::Stats statementStats();
+
+private:
+    bool ensureConnection();
+    void initializeSchema();
+    void migratePlaintextTokens();
+    [[noreturn]] void throwDatabaseError(const QString& context,
+                                         const QSqlError& error) const;
+
+    QSqlDatabase db_;
+    QString connectionName_;
+    QString databasePath_;
+    QMutex mutex_;
+    StatementCache statements_{db_};
+};
+
+#endif // SQLITE_SESSION_REPOSITORY_H
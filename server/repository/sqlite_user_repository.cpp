@@ -31,6 +31,7 @@ SqliteUserRepository::SqliteUserRepository(const QString& databasePath)
 
 SqliteUserRepository::~SqliteUserRepository()
 {
+    statements_.clear();
     if (db_.isValid()) {
         db_.close();
     }
@@ -42,12 +43,19 @@ bool SqliteUserRepository::ensureConnection()
     if (db_.isOpen())
         return true;
 
+    statements_.clear();
     if (!db_.open()) {
         throwDatabaseError(QStringLiteral("reopen database"), db_.lastError());
     }
     return true;
 }
 
+StatementCache::Stats SqliteUserRepository::statementStats()
+{
+    QMutexLocker locker(&mutex_);
+    return statements_.stats();
+}
+
 void SqliteUserRepository::initializeSchema()
 {
     QMutexLocker locker(&mutex_);
@@ -81,16 +89,15 @@ bool SqliteUserRepository::userExists(const QString& username)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT 1 FROM users WHERE username = :username LIMIT 1;"));
-    query.bindValue(QStringLiteral(":username"), username);
+    query->bindValue(QStringLiteral(":username"), username);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("userExists"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("userExists"), query->lastError());
     }
 
-    return query.next();
+    return query->next();
 }
 
 bool SqliteUserRepository::checkPassword(const QString& username,
@@ -99,19 +106,18 @@ bool SqliteUserRepository::checkPassword(const QString& username,
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT passwordHash FROM users WHERE username = :username LIMIT 1;"));
-    query.bindValue(QStringLiteral(":username"), username);
+    query->bindValue(QStringLiteral(":username"), username);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("checkPassword"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("checkPassword"), query->lastError());
     }
 
-    if (!query.next())
+    if (!query->next())
         return false;
 
-    const QString storedHash = query.value(0).toString();
+    const QString storedHash = query->value(0).toString();
     return storedHash == passwordHash;
 }
 
@@ -120,25 +126,24 @@ bool SqliteUserRepository::getUser(const QString& username, User& outUser)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT full_name, username, phone, email, passwordHash, role "
         "FROM users WHERE username = :username LIMIT 1;"));
-    query.bindValue(QStringLiteral(":username"), username);
+    query->bindValue(QStringLiteral(":username"), username);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("getUser"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("getUser"), query->lastError());
     }
 
-    if (!query.next())
+    if (!query->next())
         return false;
 
-    outUser.fullName     = query.value(0).toString();
-    outUser.username     = query.value(1).toString();
-    outUser.phone        = query.value(2).toString();
-    outUser.email        = query.value(3).toString();
-    outUser.passwordHash = query.value(4).toString();
-    outUser.role         = query.value(5).toString();
+    outUser.fullName     = query->value(0).toString();
+    outUser.username     = query->value(1).toString();
+    outUser.phone        = query->value(2).toString();
+    outUser.email        = query->value(3).toString();
+    outUser.passwordHash = query->value(4).toString();
+    outUser.role         = query->value(5).toString();
 
     return true;
 }
@@ -157,23 +162,22 @@ void SqliteUserRepository::createUser(const User& user)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "INSERT INTO users (full_name, username, phone, email, passwordHash, role) "
         "VALUES (:full_name, :username, :phone, :email, :passwordHash, :role);"));
-    query.bindValue(QStringLiteral(":full_name"), user.fullName);
-    query.bindValue(QStringLiteral(":username"), user.username);
-    query.bindValue(QStringLiteral(":phone"), user.phone);
-    query.bindValue(QStringLiteral(":email"), user.email);
-    query.bindValue(QStringLiteral(":passwordHash"), user.passwordHash);
-    query.bindValue(QStringLiteral(":role"), user.role);
-
-    if (!query.exec()) {
-        if (query.lastError().nativeErrorCode() == QStringLiteral("2067")) {
+    query->bindValue(QStringLiteral(":full_name"), user.fullName);
+    query->bindValue(QStringLiteral(":username"), user.username);
+    query->bindValue(QStringLiteral(":phone"), user.phone);
+    query->bindValue(QStringLiteral(":email"), user.email);
+    query->bindValue(QStringLiteral(":passwordHash"), user.passwordHash);
+    query->bindValue(QStringLiteral(":role"), user.role);
+
+    if (!query->exec()) {
+        if (query->lastError().nativeErrorCode() == QStringLiteral("2067")) {
             // SQLITE_CONSTRAINT_UNIQUE
             throw std::runtime_error("Duplicate username or email");
         }
-        throwDatabaseError(QStringLiteral("createUser"), query.lastError());
+        throwDatabaseError(QStringLiteral("createUser"), query->lastError());
     }
 }
 
@@ -190,44 +194,75 @@ bool SqliteUserRepository::emailExists(const QString& email)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT 1 FROM users WHERE email = :email LIMIT 1;"));
-    query.bindValue(QStringLiteral(":email"), email);
+    query->bindValue(QStringLiteral(":email"), email);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("emailExists"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("emailExists"), query->lastError());
     }
 
-    return query.next();
+    return query->next();
 }
 
-bool SqliteUserRepository::updateUser(const QString& currentUsername, const User& updatedUser)
+bool SqliteUserRepository::updateProfile(const QString& currentUsername,
+                                         const User& profile,
+                                         const QString& expectedPasswordHash,
+                                         const QString& newPasswordHash)
 {
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
-        "UPDATE users "
-        "SET full_name = :full_name, username = :username, phone = :phone, "
-        "email = :email, passwordHash = :passwordHash "
-        "WHERE username = :current_username;"));
-    query.bindValue(QStringLiteral(":full_name"), updatedUser.fullName);
-    query.bindValue(QStringLiteral(":username"), updatedUser.username);
-    query.bindValue(QStringLiteral(":phone"), updatedUser.phone);
-    query.bindValue(QStringLiteral(":email"), updatedUser.email);
-    query.bindValue(QStringLiteral(":passwordHash"), updatedUser.passwordHash);
-    query.bindValue(QStringLiteral(":current_username"), currentUsername);
+    const bool changePassword = !newPasswordHash.isEmpty();
+    auto query = statements_.prepare(changePassword
+        ? QStringLiteral(
+              "UPDATE users "
+              "SET full_name = :full_name, username = :username, phone = :phone, "
+              "email = :email, passwordHash = :new_hash "
+              "WHERE username = :current_username AND passwordHash = :expected_hash;")
+        : QStringLiteral(
+              "UPDATE users "
+              "SET full_name = :full_name, username = :username, phone = :phone, email = :email "
+              "WHERE username = :current_username;"));
+    query->bindValue(QStringLiteral(":full_name"), profile.fullName);
+    query->bindValue(QStringLiteral(":username"), profile.username);
+    query->bindValue(QStringLiteral(":phone"), profile.phone);
+    query->bindValue(QStringLiteral(":email"), profile.email);
+    query->bindValue(QStringLiteral(":current_username"), currentUsername);
+    if (changePassword) {
+        query->bindValue(QStringLiteral(":new_hash"), newPasswordHash);
+        query->bindValue(QStringLiteral(":expected_hash"), expectedPasswordHash);
+    }
 
-    if (!query.exec()) {
-        if (query.lastError().nativeErrorCode() == QStringLiteral("2067")) {
+    if (!query->exec()) {
+        if (query->lastError().nativeErrorCode() == QStringLiteral("2067")) {
             return false;
         }
-        throwDatabaseError(QStringLiteral("updateUser"), query.lastError());
+        throwDatabaseError(QStringLiteral("updateProfile"), query->lastError());
     }
 
-    return query.numRowsAffected() > 0;
+    return query->numRowsAffected() > 0;
+}
+
+bool SqliteUserRepository::updatePasswordHash(const QString& username,
+                                              const QString& expectedHash,
+                                              const QString& newHash)
+{
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
+    auto query = statements_.prepare(QStringLiteral(
+        "UPDATE users SET passwordHash = :new_hash "
+        "WHERE username = :username AND passwordHash = :expected_hash;"));
+    query->bindValue(QStringLiteral(":new_hash"), newHash);
+    query->bindValue(QStringLiteral(":username"), username);
+    query->bindValue(QStringLiteral(":expected_hash"), expectedHash);
+
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("updatePasswordHash"), query->lastError());
+    }
+
+    return query->numRowsAffected() > 0;
 }
 
 int SqliteUserRepository::countAllUsers()
@@ -254,9 +289,8 @@ QVector<AdminUserInfo> SqliteUserRepository::listUsersForAdmin(const QString& se
     QSqlQuery query(db_);
     QString sql = QStringLiteral(
         "SELECT u.full_name, u.username, u.phone, u.passwordHash, u.role, "
-        "COALESCE((SELECT COUNT(1) FROM ads a WHERE a.seller_username = u.username AND LOWER(a.status) = 'sold'), 0) AS sold_count, "
-        "COALESCE((SELECT COUNT(1) FROM transaction_ledger t WHERE t.username = u.username AND t.type = 'purchase_debit'), 0) AS bought_count "
-        "FROM users u");
+        "COALESCE(s.sold_count, 0), COALESCE(s.bought_count, 0) "
+        "FROM users u LEFT JOIN user_stats s ON s.username = u.username");
 
     if (!normalizedSearch.isEmpty()) {
         sql += QStringLiteral(" WHERE LOWER(u.full_name) LIKE :search OR LOWER(u.username) LIKE :search");
@@ -294,12 +328,29 @@ int SqliteUserRepository::countUsersByRole(const QString& role)
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
+    auto query = statements_.prepare(QStringLiteral("SELECT COUNT(1) FROM users WHERE role = :role;"));
+    query->bindValue(QStringLiteral(":role"), role);
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("countUsersByRole"), query->lastError());
+    }
+
+    return query->next() ? query->value(0).toInt() : 0;
+}
+
+QVector<UserIdentity> SqliteUserRepository::listIdentities()
+{
+    QMutexLocker locker(&mutex_);
+    ensureConnection();
+
     QSqlQuery query(db_);
-    query.prepare(QStringLiteral("SELECT COUNT(1) FROM users WHERE role = :role;"));
-    query.bindValue(QStringLiteral(":role"), role);
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("countUsersByRole"), query.lastError());
+    query.setForwardOnly(true);
+    if (!query.exec(QStringLiteral("SELECT username, email FROM users;"))) {
+        throwDatabaseError(QStringLiteral("listIdentities"), query.lastError());
     }
 
-    return query.next() ? query.value(0).toInt() : 0;
+    QVector<UserIdentity> identities;
+    while (query.next()) {
+        identities.append(UserIdentity{query.value(0).toString(), query.value(1).toString()});
+    }
+    return identities;
 }
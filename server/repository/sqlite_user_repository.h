@@ -2,6 +2,7 @@
 #define SQLITE_USER_REPOSITORY_H
 
 #include "user_repository.h"
+#include "statement_cache.h"
 #include <QMutex>
 #include <QSqlDatabase>
 #include <optional>
@@ -19,10 +20,20 @@ public:
     bool getUser(const QString& username, User& outUser) override;
     std::optional<User> findByUsername(const QString& username) override;
     void createUser(const User& user) override;
-    bool updateUser(const QString& currentUsername, const User& updatedUser) override;
+    bool updateProfile(const QString& currentUsername,
+                       const User& profile,
+                       const QString& expectedPasswordHash = {},
+                       const QString& newPasswordHash = {}) override;
+    bool updatePasswordHash(const QString& username,
+                            const QString& expectedHash,
+                            const QString& newHash) override;
     int countAllUsers() override;
     int countUsersByRole(const QString& role) override;
     QVector<AdminUserInfo> listUsersForAdmin(const QString& searchTerm = {}) override;
+    QVector<UserIdentity> listIdentities() override;
+
+    // Prepared statement reuse on this repository's connection.
+    StatementCache::Stats statementStats();
 
 private:
     bool ensureConnection();
@@ -34,6 +45,7 @@ private:
     QString connectionName_;
     QString databasePath_;
     QMutex mutex_;
+    StatementCache statements_{db_};
 };
 
 #endif // SQLITE_USER_REPOSITORY_H
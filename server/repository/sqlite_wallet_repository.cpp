@@ -1,5 +1,7 @@
 #include "sqlite_wallet_repository.h"
 
+#include "../ads/catalog_version.h"
+
 #include <QCoreApplication>
 #include <QDir>
 #include <QMap>
@@ -10,7 +12,9 @@
 #include <stdexcept>
 #include <utility>
 
-SqliteWalletRepository::SqliteWalletRepository(const QString& databasePath)
+SqliteWalletRepository::SqliteWalletRepository(const QString& databasePath,
+                                               CatalogVersion* catalogVersion)
+    : catalogVersion_(catalogVersion)
 {
     databasePath_ = databasePath;
     if (databasePath_.isEmpty()) {
@@ -34,6 +38,7 @@ SqliteWalletRepository::SqliteWalletRepository(const QString& databasePath)
 
 SqliteWalletRepository::~SqliteWalletRepository()
 {
+    statements_.clear();
     if (db_.isValid()) {
         db_.close();
     }
@@ -46,12 +51,19 @@ bool SqliteWalletRepository::ensureConnection()
         return true;
     }
 
+    statements_.clear();
     if (!db_.open()) {
         throwDatabaseError(QStringLiteral("reopen database"), db_.lastError());
     }
     return true;
 }
 
+StatementCache::Stats SqliteWalletRepository::statementStats()
+{
+    QMutexLocker locker(&mutex_);
+    return statements_.stats();
+}
+
 void SqliteWalletRepository::initializeSchema()
 {
     QMutexLocker locker(&mutex_);
@@ -112,6 +124,15 @@ void SqliteWalletRepository::initializeSchema()
         throwDatabaseError(QStringLiteral("create discount_codes index"), createDiscountIndex.lastError());
     }
 
+    QSqlQuery statsExists(db_);
+    if (!statsExists.exec(QStringLiteral(
+            "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'user_stats';"))) {
+        throwDatabaseError(QStringLiteral("check user_stats table"), statsExists.lastError());
+    }
+    if (!statsExists.next()) {
+        createUserStats();
+    }
+
     QSqlQuery seedDiscount(db_);
     if (!seedDiscount.exec(QStringLiteral(
             "INSERT OR IGNORE INTO discount_codes(code, type, value_tokens, max_discount_tokens, min_subtotal_tokens, usage_limit, is_active) "
@@ -122,15 +143,82 @@ void SqliteWalletRepository::initializeSchema()
     }
 }
 
+// Per-user sale and purchase counters for the admin user listing, maintained
+// by checkout. Created once with a backfill from the existing ads and ledger.
+void SqliteWalletRepository::createUserStats()
+{
+    if (!db_.transaction()) {
+        throwDatabaseError(QStringLiteral("begin user_stats migration"), db_.lastError());
+    }
+
+    QSqlQuery create(db_);
+    if (!create.exec(QStringLiteral(
+            "CREATE TABLE user_stats ("
+            " username TEXT PRIMARY KEY,"
+            " sold_count INTEGER NOT NULL DEFAULT 0,"
+            " bought_count INTEGER NOT NULL DEFAULT 0"
+            ");"))) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("create user_stats table"), create.lastError());
+    }
+
+    QSqlQuery adsExists(db_);
+    if (!adsExists.exec(QStringLiteral(
+            "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'ads';"))) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("check ads table"), adsExists.lastError());
+    }
+    const bool hasAds = adsExists.next();
+
+    QString backfill = QStringLiteral(
+        "INSERT INTO user_stats (username, sold_count, bought_count) "
+        "SELECT username, SUM(sold), SUM(bought) FROM ("
+        " SELECT username, 0 AS sold, COUNT(1) AS bought FROM transaction_ledger"
+        " WHERE type = 'purchase_debit' GROUP BY username");
+    if (hasAds) {
+        backfill += QStringLiteral(
+            " UNION ALL"
+            " SELECT seller_username, COUNT(1), 0 FROM ads"
+            " WHERE LOWER(status) = 'sold' GROUP BY seller_username");
+    }
+    backfill += QStringLiteral(") GROUP BY username;");
+
+    QSqlQuery populate(db_);
+    if (!populate.exec(backfill)) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("backfill user_stats"), populate.lastError());
+    }
+
+    if (!db_.commit()) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("commit user_stats migration"), db_.lastError());
+    }
+}
+
+void SqliteWalletRepository::bumpUserStats(const QString& username, int sold, int bought)
+{
+    auto upsert = statements_.prepare(QStringLiteral(
+        "INSERT INTO user_stats (username, sold_count, bought_count) VALUES (:username, :sold, :bought) "
+        "ON CONFLICT(username) DO UPDATE SET "
+        "sold_count = sold_count + excluded.sold_count, "
+        "bought_count = bought_count + excluded.bought_count;"));
+    upsert->bindValue(QStringLiteral(":username"), username);
+    upsert->bindValue(QStringLiteral(":sold"), sold);
+    upsert->bindValue(QStringLiteral(":bought"), bought);
+    if (!upsert->exec()) {
+        db_.rollback();
+        throwDatabaseError(QStringLiteral("update user_stats"), upsert->lastError());
+    }
+}
+
 void SqliteWalletRepository::ensureWalletRow(const QString& username)
 {
-    QSqlQuery insert(db_);
-    insert.prepare(QStringLiteral(
+    auto insert = statements_.prepare(QStringLiteral(
         "INSERT OR IGNORE INTO wallets (username, balance_tokens) VALUES (:username, 0);"));
-    insert.bindValue(QStringLiteral(":username"), username.trimmed());
+    insert->bindValue(QStringLiteral(":username"), username.trimmed());
 
-    if (!insert.exec()) {
-        throwDatabaseError(QStringLiteral("ensure wallet row"), insert.lastError());
+    if (!insert->exec()) {
+        throwDatabaseError(QStringLiteral("ensure wallet row"), insert->lastError());
     }
 }
 
@@ -142,16 +230,15 @@ int SqliteWalletRepository::getBalance(const QString& username)
     const QString normalized = username.trimmed();
     ensureWalletRow(normalized);
 
-    QSqlQuery select(db_);
-    select.prepare(QStringLiteral(
+    auto select = statements_.prepare(QStringLiteral(
         "SELECT balance_tokens FROM wallets WHERE username = :username LIMIT 1;"));
-    select.bindValue(QStringLiteral(":username"), normalized);
+    select->bindValue(QStringLiteral(":username"), normalized);
 
-    if (!select.exec()) {
-        throwDatabaseError(QStringLiteral("get wallet balance"), select.lastError());
+    if (!select->exec()) {
+        throwDatabaseError(QStringLiteral("get wallet balance"), select->lastError());
     }
 
-    return select.next() ? select.value(0).toInt() : 0;
+    return select->next() ? select->value(0).toInt() : 0;
 }
 
 int SqliteWalletRepository::topUp(const QString& username, int amountTokens)
@@ -166,38 +253,35 @@ int SqliteWalletRepository::topUp(const QString& username, int amountTokens)
         throwDatabaseError(QStringLiteral("begin top-up transaction"), db_.lastError());
     }
 
-    QSqlQuery update(db_);
-    update.prepare(QStringLiteral(
+    auto update = statements_.prepare(QStringLiteral(
         "UPDATE wallets SET balance_tokens = balance_tokens + :amount WHERE username = :username;"));
-    update.bindValue(QStringLiteral(":amount"), amountTokens);
-    update.bindValue(QStringLiteral(":username"), normalized);
+    update->bindValue(QStringLiteral(":amount"), amountTokens);
+    update->bindValue(QStringLiteral(":username"), normalized);
 
-    if (!update.exec()) {
+    if (!update->exec()) {
         db_.rollback();
-        throwDatabaseError(QStringLiteral("top-up wallet"), update.lastError());
+        throwDatabaseError(QStringLiteral("top-up wallet"), update->lastError());
     }
 
-    QSqlQuery balanceQuery(db_);
-    balanceQuery.prepare(QStringLiteral(
+    auto balanceQuery = statements_.prepare(QStringLiteral(
         "SELECT balance_tokens FROM wallets WHERE username = :username LIMIT 1;"));
-    balanceQuery.bindValue(QStringLiteral(":username"), normalized);
-    if (!balanceQuery.exec() || !balanceQuery.next()) {
+    balanceQuery->bindValue(QStringLiteral(":username"), normalized);
+    if (!balanceQuery->exec() || !balanceQuery->next()) {
         db_.rollback();
-        throwDatabaseError(QStringLiteral("load top-up balance"), balanceQuery.lastError());
+        throwDatabaseError(QStringLiteral("load top-up balance"), balanceQuery->lastError());
     }
-    const int newBalance = balanceQuery.value(0).toInt();
+    const int newBalance = balanceQuery->value(0).toInt();
 
-    QSqlQuery ledger(db_);
-    ledger.prepare(QStringLiteral(
+    auto ledger = statements_.prepare(QStringLiteral(
         "INSERT INTO transaction_ledger(username, type, amount_tokens, balance_after, ad_id, counterparty) "
         "VALUES(:username, 'topup', :amount, :balance_after, NULL, NULL);"));
-    ledger.bindValue(QStringLiteral(":username"), normalized);
-    ledger.bindValue(QStringLiteral(":amount"), amountTokens);
-    ledger.bindValue(QStringLiteral(":balance_after"), newBalance);
+    ledger->bindValue(QStringLiteral(":username"), normalized);
+    ledger->bindValue(QStringLiteral(":amount"), amountTokens);
+    ledger->bindValue(QStringLiteral(":balance_after"), newBalance);
 
-    if (!ledger.exec()) {
+    if (!ledger->exec()) {
         db_.rollback();
-        throwDatabaseError(QStringLiteral("insert top-up ledger"), ledger.lastError());
+        throwDatabaseError(QStringLiteral("insert top-up ledger"), ledger->lastError());
     }
 
     if (!db_.commit()) {
@@ -224,29 +308,28 @@ WalletRepository::DiscountValidationResult SqliteWalletRepository::validateDisco
         return result;
     }
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT code, type, value_tokens, max_discount_tokens, min_subtotal_tokens, usage_limit, used_count, is_active, expires_at "
         "FROM discount_codes WHERE code = :code LIMIT 1;"));
-    query.bindValue(QStringLiteral(":code"), result.code);
+    query->bindValue(QStringLiteral(":code"), result.code);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("validate discount code"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("validate discount code"), query->lastError());
     }
 
-    if (!query.next()) {
+    if (!query->next()) {
         result.message = QStringLiteral("Discount code not found");
         return result;
     }
 
-    result.type = query.value(1).toString().trimmed().toLower();
-    result.valueTokens = query.value(2).toInt();
-    result.maxDiscountTokens = qMax(0, query.value(3).toInt());
-    result.minSubtotalTokens = qMax(0, query.value(4).toInt());
-    result.usageLimit = query.value(5).isNull() ? -1 : query.value(5).toInt();
-    result.usedCount = query.value(6).toInt();
-    result.active = query.value(7).toInt() != 0;
-    result.expiresAt = QDateTime::fromString(query.value(8).toString(), Qt::ISODate);
+    result.type = query->value(1).toString().trimmed().toLower();
+    result.valueTokens = query->value(2).toInt();
+    result.maxDiscountTokens = qMax(0, query->value(3).toInt());
+    result.minSubtotalTokens = qMax(0, query->value(4).toInt());
+    result.usageLimit = query->value(5).isNull() ? -1 : query->value(5).toInt();
+    result.usedCount = query->value(6).toInt();
+    result.active = query->value(7).toInt() != 0;
+    result.expiresAt = QDateTime::fromString(query->value(8).toString(), Qt::ISODate);
 
     if (!result.active) {
         result.message = QStringLiteral("Discount code is inactive");
@@ -343,8 +426,7 @@ bool SqliteWalletRepository::upsertDiscountCode(const DiscountValidationResult&
         return false;
     }
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "INSERT INTO discount_codes(code, type, value_tokens, max_discount_tokens, min_subtotal_tokens, usage_limit, used_count, is_active, expires_at, updated_at) "
         "VALUES(:code, :type, :value, :max_discount, :min_subtotal, :usage_limit, :used_count, :is_active, :expires_at, CURRENT_TIMESTAMP) "
         "ON CONFLICT(code) DO UPDATE SET "
@@ -357,27 +439,27 @@ bool SqliteWalletRepository::upsertDiscountCode(const DiscountValidationResult&
         " expires_at = excluded.expires_at,"
         " updated_at = CURRENT_TIMESTAMP;"));
 
-    query.bindValue(QStringLiteral(":code"), code);
-    query.bindValue(QStringLiteral(":type"), type);
-    query.bindValue(QStringLiteral(":value"), record.valueTokens);
-    query.bindValue(QStringLiteral(":max_discount"), qMax(0, record.maxDiscountTokens));
-    query.bindValue(QStringLiteral(":min_subtotal"), qMax(0, record.minSubtotalTokens));
+    query->bindValue(QStringLiteral(":code"), code);
+    query->bindValue(QStringLiteral(":type"), type);
+    query->bindValue(QStringLiteral(":value"), record.valueTokens);
+    query->bindValue(QStringLiteral(":max_discount"), qMax(0, record.maxDiscountTokens));
+    query->bindValue(QStringLiteral(":min_subtotal"), qMax(0, record.minSubtotalTokens));
     if (record.usageLimit < 0) {
-        query.bindValue(QStringLiteral(":usage_limit"), QVariant(QMetaType::fromType<int>()));
+        query->bindValue(QStringLiteral(":usage_limit"), QVariant(QMetaType::fromType<int>()));
     } else {
-        query.bindValue(QStringLiteral(":usage_limit"), record.usageLimit);
+        query->bindValue(QStringLiteral(":usage_limit"), record.usageLimit);
     }
-    query.bindValue(QStringLiteral(":used_count"), qMax(0, record.usedCount));
-    query.bindValue(QStringLiteral(":is_active"), record.active ? 1 : 0);
+    query->bindValue(QStringLiteral(":used_count"), qMax(0, record.usedCount));
+    query->bindValue(QStringLiteral(":is_active"), record.active ? 1 : 0);
     if (record.expiresAt.isValid()) {
-        query.bindValue(QStringLiteral(":expires_at"), record.expiresAt.toUTC().toString(Qt::ISODate));
+        query->bindValue(QStringLiteral(":expires_at"), record.expiresAt.toUTC().toString(Qt::ISODate));
     } else {
-        query.bindValue(QStringLiteral(":expires_at"), QVariant(QMetaType::fromType<QString>()));
+        query->bindValue(QStringLiteral(":expires_at"), QVariant(QMetaType::fromType<QString>()));
     }
 
-    if (!query.exec()) {
+    if (!query->exec()) {
         if (errorMessage) {
-            *errorMessage = query.lastError().text();
+            *errorMessage = query->lastError().text();
         }
         return false;
     }
@@ -390,18 +472,17 @@ bool SqliteWalletRepository::deleteDiscountCode(const QString& code,
     QMutexLocker locker(&mutex_);
     ensureConnection();
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral("DELETE FROM discount_codes WHERE code = :code;"));
-    query.bindValue(QStringLiteral(":code"), code.trimmed().toUpper());
+    auto query = statements_.prepare(QStringLiteral("DELETE FROM discount_codes WHERE code = :code;"));
+    query->bindValue(QStringLiteral(":code"), code.trimmed().toUpper());
 
-    if (!query.exec()) {
+    if (!query->exec()) {
         if (errorMessage) {
-            *errorMessage = query.lastError().text();
+            *errorMessage = query->lastError().text();
         }
         return false;
     }
 
-    if (query.numRowsAffected() != 1) {
+    if (query->numRowsAffected() != 1) {
         if (errorMessage) {
             *errorMessage = QStringLiteral("Discount code not found");
         }
@@ -432,17 +513,16 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
     int subtotal = 0;
 
     for (const int adId : adIds) {
-        QSqlQuery adQuery(db_);
-        adQuery.prepare(QStringLiteral(
+        auto adQuery = statements_.prepare(QStringLiteral(
             "SELECT seller_username, price_tokens, status FROM ads WHERE id = :id LIMIT 1;"));
-        adQuery.bindValue(QStringLiteral(":id"), adId);
+        adQuery->bindValue(QStringLiteral(":id"), adId);
 
-        if (!adQuery.exec()) {
+        if (!adQuery->exec()) {
             db_.rollback();
-            throwDatabaseError(QStringLiteral("load ad for checkout"), adQuery.lastError());
+            throwDatabaseError(QStringLiteral("load ad for checkout"), adQuery->lastError());
         }
 
-        if (!adQuery.next()) {
+        if (!adQuery->next()) {
             db_.rollback();
             if (errorMessage) {
                 *errorMessage = QStringLiteral("Advertisement %1 not found").arg(adId);
@@ -450,9 +530,9 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
             return false;
         }
 
-        const QString seller = adQuery.value(0).toString().trimmed();
-        const int price = adQuery.value(1).toInt();
-        const QString status = adQuery.value(2).toString().trimmed().toLower();
+        const QString seller = adQuery->value(0).toString().trimmed();
+        const int price = adQuery->value(1).toInt();
+        const QString status = adQuery->value(2).toString().trimmed().toLower();
 
         if (status != QStringLiteral("approved")) {
             db_.rollback();
@@ -486,17 +566,16 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
         discountResult.code = normalizedCode;
         discountResult.subtotalTokens = subtotal;
 
-        QSqlQuery discountQuery(db_);
-        discountQuery.prepare(QStringLiteral(
+        auto discountQuery = statements_.prepare(QStringLiteral(
             "SELECT type, value_tokens, max_discount_tokens, min_subtotal_tokens, usage_limit, used_count, is_active, expires_at "
             "FROM discount_codes WHERE code = :code LIMIT 1;"));
-        discountQuery.bindValue(QStringLiteral(":code"), normalizedCode);
-        if (!discountQuery.exec()) {
+        discountQuery->bindValue(QStringLiteral(":code"), normalizedCode);
+        if (!discountQuery->exec()) {
             db_.rollback();
-            throwDatabaseError(QStringLiteral("load discount for checkout"), discountQuery.lastError());
+            throwDatabaseError(QStringLiteral("load discount for checkout"), discountQuery->lastError());
         }
 
-        if (!discountQuery.next()) {
+        if (!discountQuery->next()) {
             db_.rollback();
             if (errorMessage) {
                 *errorMessage = QStringLiteral("Discount code not found");
@@ -504,14 +583,14 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
             return false;
         }
 
-        discountResult.type = discountQuery.value(0).toString().trimmed().toLower();
-        discountResult.valueTokens = discountQuery.value(1).toInt();
-        discountResult.maxDiscountTokens = qMax(0, discountQuery.value(2).toInt());
-        discountResult.minSubtotalTokens = qMax(0, discountQuery.value(3).toInt());
-        discountResult.usageLimit = discountQuery.value(4).isNull() ? -1 : discountQuery.value(4).toInt();
-        discountResult.usedCount = discountQuery.value(5).toInt();
-        discountResult.active = discountQuery.value(6).toInt() != 0;
-        discountResult.expiresAt = QDateTime::fromString(discountQuery.value(7).toString(), Qt::ISODate);
+        discountResult.type = discountQuery->value(0).toString().trimmed().toLower();
+        discountResult.valueTokens = discountQuery->value(1).toInt();
+        discountResult.maxDiscountTokens = qMax(0, discountQuery->value(2).toInt());
+        discountResult.minSubtotalTokens = qMax(0, discountQuery->value(3).toInt());
+        discountResult.usageLimit = discountQuery->value(4).isNull() ? -1 : discountQuery->value(4).toInt();
+        discountResult.usedCount = discountQuery->value(5).toInt();
+        discountResult.active = discountQuery->value(6).toInt() != 0;
+        discountResult.expiresAt = QDateTime::fromString(discountQuery->value(7).toString(), Qt::ISODate);
 
         if (!discountResult.active) {
             db_.rollback();
@@ -564,13 +643,12 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
             return false;
         }
 
-        QSqlQuery consumeCode(db_);
-        consumeCode.prepare(QStringLiteral(
+        auto consumeCode = statements_.prepare(QStringLiteral(
             "UPDATE discount_codes "
             "SET used_count = used_count + 1, updated_at = CURRENT_TIMESTAMP "
             "WHERE code = :code AND is_active = 1 AND (usage_limit IS NULL OR used_count < usage_limit);"));
-        consumeCode.bindValue(QStringLiteral(":code"), normalizedCode);
-        if (!consumeCode.exec() || consumeCode.numRowsAffected() != 1) {
+        consumeCode->bindValue(QStringLiteral(":code"), normalizedCode);
+        if (!consumeCode->exec() || consumeCode->numRowsAffected() != 1) {
             db_.rollback();
             if (errorMessage) {
                 *errorMessage = QStringLiteral("Discount code could not be consumed");
@@ -581,17 +659,16 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
 
     const int totalCost = qMax(0, subtotal - discountResult.discountTokens);
 
-    QSqlQuery buyerBalanceQuery(db_);
-    buyerBalanceQuery.prepare(QStringLiteral(
+    auto buyerBalanceQuery = statements_.prepare(QStringLiteral(
         "SELECT balance_tokens FROM wallets WHERE username = :username LIMIT 1;"));
-    buyerBalanceQuery.bindValue(QStringLiteral(":username"), buyer);
+    buyerBalanceQuery->bindValue(QStringLiteral(":username"), buyer);
 
-    if (!buyerBalanceQuery.exec() || !buyerBalanceQuery.next()) {
+    if (!buyerBalanceQuery->exec() || !buyerBalanceQuery->next()) {
         db_.rollback();
-        throwDatabaseError(QStringLiteral("load buyer balance"), buyerBalanceQuery.lastError());
+        throwDatabaseError(QStringLiteral("load buyer balance"), buyerBalanceQuery->lastError());
     }
 
-    const int buyerBalance = buyerBalanceQuery.value(0).toInt();
+    const int buyerBalance = buyerBalanceQuery->value(0).toInt();
     if (buyerBalance < totalCost) {
         db_.rollback();
         if (errorMessage) {
@@ -600,14 +677,13 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
         return false;
     }
 
-    QSqlQuery debit(db_);
-    debit.prepare(QStringLiteral(
+    auto debit = statements_.prepare(QStringLiteral(
         "UPDATE wallets SET balance_tokens = balance_tokens - :amount WHERE username = :username;"));
-    debit.bindValue(QStringLiteral(":amount"), totalCost);
-    debit.bindValue(QStringLiteral(":username"), buyer);
-    if (!debit.exec()) {
+    debit->bindValue(QStringLiteral(":amount"), totalCost);
+    debit->bindValue(QStringLiteral(":username"), buyer);
+    if (!debit->exec()) {
         db_.rollback();
-        throwDatabaseError(QStringLiteral("debit buyer"), debit.lastError());
+        throwDatabaseError(QStringLiteral("debit buyer"), debit->lastError());
     }
 
     result.subtotalTokens = subtotal;
@@ -619,24 +695,22 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
     for (auto it = sellerCredits.cbegin(); it != sellerCredits.cend(); ++it) {
         ensureWalletRow(it.key());
 
-        QSqlQuery credit(db_);
-        credit.prepare(QStringLiteral(
+        auto credit = statements_.prepare(QStringLiteral(
             "UPDATE wallets SET balance_tokens = balance_tokens + :amount WHERE username = :username;"));
-        credit.bindValue(QStringLiteral(":amount"), it.value());
-        credit.bindValue(QStringLiteral(":username"), it.key());
-        if (!credit.exec()) {
+        credit->bindValue(QStringLiteral(":amount"), it.value());
+        credit->bindValue(QStringLiteral(":username"), it.key());
+        if (!credit->exec()) {
             db_.rollback();
-            throwDatabaseError(QStringLiteral("credit seller"), credit.lastError());
+            throwDatabaseError(QStringLiteral("credit seller"), credit->lastError());
         }
     }
 
     for (const CheckoutItem& item : std::as_const(result.purchasedItems)) {
-        QSqlQuery markSold(db_);
-        markSold.prepare(QStringLiteral(
+        auto markSold = statements_.prepare(QStringLiteral(
             "UPDATE ads SET status = 'sold', updated_at = CURRENT_TIMESTAMP "
             "WHERE id = :id AND status = 'approved';"));
-        markSold.bindValue(QStringLiteral(":id"), item.adId);
-        if (!markSold.exec() || markSold.numRowsAffected() != 1) {
+        markSold->bindValue(QStringLiteral(":id"), item.adId);
+        if (!markSold->exec() || markSold->numRowsAffected() != 1) {
             db_.rollback();
             if (errorMessage) {
                 *errorMessage = QStringLiteral("Advertisement %1 is no longer available").arg(item.adId);
@@ -644,69 +718,73 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
             return false;
         }
 
-        QSqlQuery adHistory(db_);
-        adHistory.prepare(QStringLiteral(
+        auto adHistory = statements_.prepare(QStringLiteral(
             "INSERT INTO ad_status_history (ad_id, previous_status, new_status, reason) "
             "VALUES (:ad_id, 'approved', 'sold', :reason);"));
-        adHistory.bindValue(QStringLiteral(":ad_id"), item.adId);
-        adHistory.bindValue(QStringLiteral(":reason"),
+        adHistory->bindValue(QStringLiteral(":ad_id"), item.adId);
+        adHistory->bindValue(QStringLiteral(":reason"),
                             QStringLiteral("sold to %1").arg(buyer));
-        if (!adHistory.exec()) {
+        if (!adHistory->exec()) {
             db_.rollback();
-            throwDatabaseError(QStringLiteral("insert sold ad history"), adHistory.lastError());
+            throwDatabaseError(QStringLiteral("insert sold ad history"), adHistory->lastError());
         }
 
-        QSqlQuery buyerLedger(db_);
-        buyerLedger.prepare(QStringLiteral(
+        auto buyerLedger = statements_.prepare(QStringLiteral(
             "INSERT INTO transaction_ledger(username, type, amount_tokens, balance_after, ad_id, counterparty) "
             "VALUES(:username, 'purchase_debit', :amount, "
             "(SELECT balance_tokens FROM wallets WHERE username = :username), :ad_id, :counterparty);"));
-        buyerLedger.bindValue(QStringLiteral(":username"), buyer);
-        buyerLedger.bindValue(QStringLiteral(":amount"), -item.priceTokens);
-        buyerLedger.bindValue(QStringLiteral(":ad_id"), item.adId);
-        buyerLedger.bindValue(QStringLiteral(":counterparty"), item.sellerUsername);
-        if (!buyerLedger.exec()) {
+        buyerLedger->bindValue(QStringLiteral(":username"), buyer);
+        buyerLedger->bindValue(QStringLiteral(":amount"), -item.priceTokens);
+        buyerLedger->bindValue(QStringLiteral(":ad_id"), item.adId);
+        buyerLedger->bindValue(QStringLiteral(":counterparty"), item.sellerUsername);
+        if (!buyerLedger->exec()) {
             db_.rollback();
-            throwDatabaseError(QStringLiteral("insert buyer ledger"), buyerLedger.lastError());
+            throwDatabaseError(QStringLiteral("insert buyer ledger"), buyerLedger->lastError());
         }
 
-        QSqlQuery sellerLedger(db_);
-        sellerLedger.prepare(QStringLiteral(
+        auto sellerLedger = statements_.prepare(QStringLiteral(
             "INSERT INTO transaction_ledger(username, type, amount_tokens, balance_after, ad_id, counterparty) "
             "VALUES(:username, 'sale_credit', :amount, "
             "(SELECT balance_tokens FROM wallets WHERE username = :username), :ad_id, :counterparty);"));
-        sellerLedger.bindValue(QStringLiteral(":username"), item.sellerUsername);
-        sellerLedger.bindValue(QStringLiteral(":amount"), item.priceTokens);
-        sellerLedger.bindValue(QStringLiteral(":ad_id"), item.adId);
-        sellerLedger.bindValue(QStringLiteral(":counterparty"), buyer);
-        if (!sellerLedger.exec()) {
+        sellerLedger->bindValue(QStringLiteral(":username"), item.sellerUsername);
+        sellerLedger->bindValue(QStringLiteral(":amount"), item.priceTokens);
+        sellerLedger->bindValue(QStringLiteral(":ad_id"), item.adId);
+        sellerLedger->bindValue(QStringLiteral(":counterparty"), buyer);
+        if (!sellerLedger->exec()) {
             db_.rollback();
-            throwDatabaseError(QStringLiteral("insert seller ledger"), sellerLedger.lastError());
+            throwDatabaseError(QStringLiteral("insert seller ledger"), sellerLedger->lastError());
         }
 
-        QSqlQuery cartCleanup(db_);
-        cartCleanup.prepare(QStringLiteral(
+        auto cartCleanup = statements_.prepare(QStringLiteral(
             "DELETE FROM cart_items WHERE username = :username AND ad_id = :ad_id;"));
-        cartCleanup.bindValue(QStringLiteral(":username"), buyer);
-        cartCleanup.bindValue(QStringLiteral(":ad_id"), item.adId);
-        if (!cartCleanup.exec()) {
+        cartCleanup->bindValue(QStringLiteral(":username"), buyer);
+        cartCleanup->bindValue(QStringLiteral(":ad_id"), item.adId);
+        if (!cartCleanup->exec()) {
             db_.rollback();
-            throwDatabaseError(QStringLiteral("cleanup cart item"), cartCleanup.lastError());
+            throwDatabaseError(QStringLiteral("cleanup cart item"), cartCleanup->lastError());
         }
     }
 
+    QMap<QString, int> soldBySeller;
+    for (const CheckoutItem& item : std::as_const(result.purchasedItems)) {
+        ++soldBySeller[item.sellerUsername];
+    }
+    for (auto it = soldBySeller.cbegin(); it != soldBySeller.cend(); ++it) {
+        bumpUserStats(it.key(), it.value(), 0);
+    }
+    bumpUserStats(buyer, 0, static_cast<int>(result.purchasedItems.size()));
+
     if (result.discountTokens > 0) {
-        QSqlQuery discountLedger(db_);
-        discountLedger.prepare(QStringLiteral(
+        auto discountLedger = statements_.prepare(QStringLiteral(
             "INSERT INTO transaction_ledger(username, type, amount_tokens, balance_after, ad_id, counterparty) "
             "VALUES(:username, 'discount_credit', :amount, "
             "(SELECT balance_tokens FROM wallets WHERE username = :username), NULL, :counterparty);"));
-        discountLedger.bindValue(QStringLiteral(":username"), buyer);
-        discountLedger.bindValue(QStringLiteral(":amount"), result.discountTokens);
-        discountLedger.bindValue(QStringLiteral(":counterparty"), result.appliedDiscountCode);
-        if (!discountLedger.exec()) {
+        discountLedger->bindValue(QStringLiteral(":username"), buyer);
+        discountLedger->bindValue(QStringLiteral(":amount"), result.discountTokens);
+        discountLedger->bindValue(QStringLiteral(":counterparty"), result.appliedDiscountCode);
+        if (!discountLedger->exec()) {
             db_.rollback();
-            throwDatabaseError(QStringLiteral("insert discount ledger"), discountLedger.lastError());
+            throwDatabaseError(QStringLiteral("insert discount ledger"), discountLedger->lastError());
         }
     }
 
@@ -714,6 +792,12 @@ bool SqliteWalletRepository::checkout(const QString& buyerUsername,
         throwDatabaseError(QStringLiteral("commit checkout"), db_.lastError());
     }
 
+    if (catalogVersion_) {
+        for (const CheckoutItem& item : std::as_const(result.purchasedItems)) {
+            catalogVersion_->adUnlisted(item.adId);
+        }
+    }
+
     return true;
 }
 
@@ -724,29 +808,28 @@ QVector<WalletRepository::LedgerEntry> SqliteWalletRepository::transactionHistor
     ensureConnection();
     ensureWalletRow(username.trimmed());
 
-    QSqlQuery query(db_);
-    query.prepare(QStringLiteral(
+    auto query = statements_.prepare(QStringLiteral(
         "SELECT id, username, type, amount_tokens, balance_after, ad_id, counterparty, created_at "
         "FROM transaction_ledger WHERE username = :username "
         "ORDER BY created_at DESC, id DESC LIMIT :limit;"));
-    query.bindValue(QStringLiteral(":username"), username.trimmed());
-    query.bindValue(QStringLiteral(":limit"), limit > 0 ? limit : 100);
+    query->bindValue(QStringLiteral(":username"), username.trimmed());
+    query->bindValue(QStringLiteral(":limit"), limit > 0 ? limit : 100);
 
-    if (!query.exec()) {
-        throwDatabaseError(QStringLiteral("transaction history"), query.lastError());
+    if (!query->exec()) {
+        throwDatabaseError(QStringLiteral("transaction history"), query->lastError());
     }
 
     QVector<LedgerEntry> entries;
-    while (query.next()) {
+    while (query->next()) {
         LedgerEntry entry;
-        entry.id = query.value(0).toInt();
-        entry.username = query.value(1).toString();
-        entry.type = query.value(2).toString();
-        entry.amountTokens = query.value(3).toInt();
-        entry.balanceAfter = query.value(4).toInt();
-        entry.adId = query.value(5).isNull() ? -1 : query.value(5).toInt();
-        entry.counterparty = query.value(6).toString();
-        entry.createdAt = QDateTime::fromString(query.value(7).toString(), QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+        entry.id = query->value(0).toInt();
+        entry.username = query->value(1).toString();
+        entry.type = query->value(2).toString();
+        entry.amountTokens = query->value(3).toInt();
+        entry.balanceAfter = query->value(4).toInt();
+        entry.adId = query->value(5).isNull() ? -1 : query->value(5).toInt();
+        entry.counterparty = query->value(6).toString();
+        entry.createdAt = QDateTime::fromString(query->value(7).toString(), QStringLiteral("yyyy-MM-dd HH:mm:ss"));
         entries.push_back(entry);
     }
     return entries;
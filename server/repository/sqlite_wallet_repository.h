@@ -2,15 +2,19 @@
 #define SQLITE_WALLET_REPOSITORY_H
 
 #include "wallet_repository.h"
+#include "statement_cache.h"
 
 #include <QMutex>
 #include <QSqlDatabase>
 #include <QSqlError>
 
+class CatalogVersion;
+
 class SqliteWalletRepository : public WalletRepository
 {
 public:
-    explicit SqliteWalletRepository(const QString& databasePath = QString());
+    explicit SqliteWalletRepository(const QString& databasePath = QString(),
+                                    CatalogVersion* catalogVersion = nullptr);
     ~SqliteWalletRepository() override;
 
     int getBalance(const QString& username) override;
@@ -30,10 +34,15 @@ public:
                             QString* errorMessage) override;
     QVector<LedgerEntry> transactionHistory(const QString& username, int limit) override;
 
+    // Prepared statement reuse on this repository's connection.
+    StatementCache::Stats statementStats();
+
 private:
     bool ensureConnection();
     void initializeSchema();
     void ensureWalletRow(const QString& username);
+    void createUserStats();
+    void bumpUserStats(const QString& username, int sold, int bought);
     [[noreturn]] void throwDatabaseError(const QString& context,
                                          const QSqlError& error) const;
 
@@ -41,6 +50,8 @@ private:
     QString connectionName_;
     QString databasePath_;
     QMutex mutex_;
+    StatementCache statements_{db_};
+    CatalogVersion* catalogVersion_ = nullptr;
 };
 
 #endif // SQLITE_WALLET_REPOSITORY_H
@@ -0,0 +1,87 @@
+#include "statement_cache.h"
+
+#include <utility>
+
+StatementCache::Statement::Statement(QSqlQuery* query, bool* inUse, std::unique_ptr<QSqlQuery> owned)
+    : query_(query),
+      inUse_(inUse),
+      owned_(std::move(owned))
+{
+}
+
+StatementCache::Statement::Statement(Statement&& other) noexcept
+    : query_(std::exchange(other.query_, nullptr)),
+      inUse_(std::exchange(other.inUse_, nullptr)),
+      owned_(std::move(other.owned_))
+{
+}
+
+StatementCache::Statement::~Statement()
+{
+    if (query_ && !owned_) {
+        query_->finish();
+    }
+    if (inUse_) {
+        *inUse_ = false;
+    }
+}
+
+StatementCache::StatementCache(const QSqlDatabase& db, int capacity)
+    : db_(db),
+      capacity_(qMax(1, capacity))
+{
+}
+
+StatementCache::Statement StatementCache::prepare(const QString& sql)
+{
+    const auto found = entries_.find(sql);
+    if (found != entries_.end() && !found->second.inUse) {
+        ++hits_;
+        found->second.inUse = true;
+        return Statement(found->second.query.get(), &found->second.inUse, nullptr);
+    }
+
+    ++misses_;
+    auto query = std::make_unique<QSqlQuery>(db_);
+    query->setForwardOnly(true);
+    const bool prepared = query->prepare(sql);
+
+    // The same SQL borrowed twice at once gets a one-off statement rather
+    // than having the outstanding one reset underneath its caller.
+    if (!prepared || found != entries_.end()) {
+        QSqlQuery* raw = query.get();
+        return Statement(raw, nullptr, std::move(query));
+    }
+
+    // Dynamic SQL could otherwise grow the cache without bound; starting
+    // over is cheap next to tracking recency on every hit.
+    if (static_cast<int>(entries_.size()) >= capacity_) {
+        clear();
+    }
+
+    Entry& entry = entries_[sql];
+    entry.query = std::move(query);
+    entry.inUse = true;
+    return Statement(entry.query.get(), &entry.inUse, nullptr);
+}
+
+void StatementCache::clear()
+{
+    // Entries still borrowed stay so their handles remain valid.
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.inUse) {
+            ++it;
+        } else {
+            it = entries_.erase(it);
+        }
+    }
+}
+
+StatementCache::Stats StatementCache::stats() const
+{
+    Stats result;
+    result.hits = hits_;
+    result.misses = misses_;
+    result.size = static_cast<int>(entries_.size());
+    return result;
+}
@@ -0,0 +1,76 @@
+#ifndef KALANET_STATEMENT_CACHE_H
+#define KALANET_STATEMENT_CACHE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+#include <memory>
+#include <unordered_map>
+
+// Prepared statements of one connection, keyed by SQL text. A statement is
+// prepared the first time its SQL is seen; later uses only reset and rebind
+// it, so SQLite parses and plans each query once per connection. Not
+// thread-safe: callers hold the owning repository's mutex.
+class StatementCache
+{
+public:
+    static constexpr int kDefaultCapacity = 256;
+
+    struct Stats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        int size = 0;
+    };
+
+    // Borrowed statement. It is reset when the handle goes out of scope, so
+    // no read transaction stays open between repository calls.
+    class Statement
+    {
+    public:
+        Statement(Statement&& other) noexcept;
+        Statement(const Statement&) = delete;
+        Statement& operator=(const Statement&) = delete;
+        Statement& operator=(Statement&&) = delete;
+        ~Statement();
+
+        QSqlQuery* operator->() const { return query_; }
+        QSqlQuery& operator*() const { return *query_; }
+
+    private:
+        friend class StatementCache;
+
+        Statement(QSqlQuery* query, bool* inUse, std::unique_ptr<QSqlQuery> owned);
+
+        QSqlQuery* query_ = nullptr;
+        bool* inUse_ = nullptr;
+        std::unique_ptr<QSqlQuery> owned_;
+    };
+
+    // Keeps a reference to the connection, which must outlive the cache.
+    explicit StatementCache(const QSqlDatabase& db, int capacity = kDefaultCapacity);
+
+    // SQL that fails to prepare is not cached; exec() on the returned
+    // statement then reports the error as an uncached query would.
+    Statement prepare(const QString& sql);
+
+    // Drops every statement; required before the connection is closed or
+    // reopened.
+    void clear();
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::unique_ptr<QSqlQuery> query;
+        bool inUse = false;
+    };
+
+    const QSqlDatabase& db_;
+    const int capacity_;
+    std::unordered_map<QString, Entry> entries_;
+    qint64 hits_ = 0;
+    qint64 misses_ = 0;
+};
+
+#endif // KALANET_STATEMENT_CACHE_H
@@ -15,6 +15,23 @@ struct User
     QString role;
 };
 
+struct UserIdentity
+{
+    QString username;
+    QString email;
+};
+
+struct UserCacheStats
+{
+    qint64 recordHits = 0;
+    qint64 recordMisses = 0;
+    qint64 existenceChecks = 0;
+    qint64 bloomRejects = 0;
+    qint64 existenceFallbacks = 0;
+    int cachedUsers = 0;
+    int knownIdentities = 0;
+};
+
 struct AdminUserInfo
 {
     QString fullName;
@@ -48,10 +65,23 @@ public:
         const User& user
     ) = 0;
 
-    virtual bool updateUser(const QString& currentUsername, const User& updatedUser) = 0;
+    // Rewrites name, username, phone and email; role and password are left
+    // alone. With a newPasswordHash the password changes in the same write,
+    // but only while the stored hash still equals expectedPasswordHash.
+    virtual bool updateProfile(const QString& currentUsername,
+                               const User& profile,
+                               const QString& expectedPasswordHash = {},
+                               const QString& newPasswordHash = {}) = 0;
+    // Compare-and-set: false when the stored hash is no longer expectedHash.
+    virtual bool updatePasswordHash(const QString& username,
+                                    const QString& expectedHash,
+                                    const QString& newHash) = 0;
     virtual int countAllUsers() = 0;
     virtual int countUsersByRole(const QString& role) = 0;
     virtual QVector<AdminUserInfo> listUsersForAdmin(const QString& searchTerm = {}) = 0;
+    virtual QVector<UserIdentity> listIdentities() = 0;
+    // Only repositories that cache report anything here.
+    virtual std::optional<UserCacheStats> cacheStats() const { return std::nullopt; }
 
     virtual ~UserRepository() = default;
 };
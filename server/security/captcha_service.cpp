@@ -2,30 +2,93 @@
 
 #include <QMutexLocker>
 #include <QRandomGenerator>
-#include <QUuid>
+
+#include <algorithm>
+#include <functional>
 
 namespace {
 constexpr int kMinOperand = 1;
 constexpr int kMaxOperandExclusive = 25;
 constexpr int kTtlSeconds = 120;
+// Below this many heap entries, stale nonces are not worth a rebuild.
+constexpr std::size_t kMinHeapToCompact = 64;
 }
 
-CaptchaService::Challenge CaptchaService::createChallenge(const QString& scope)
+CaptchaService::CaptchaService(int maxOutstandingPerScope, int maxOutstandingPerClient)
+    : maxOutstandingPerShard_(qMax(1, maxOutstandingPerScope / kShardCount)),
+      maxOutstandingPerClient_(qMax(1, maxOutstandingPerClient))
 {
-    const int left = QRandomGenerator::global()->bounded(kMinOperand, kMaxOperandExclusive);
-    const int right = QRandomGenerator::global()->bounded(kMinOperand, kMaxOperandExclusive);
+    clock_.start();
+}
+
+bool CaptchaService::isKnownScope(const QString& scope)
+{
+    return scope == QStringLiteral("login") || scope == QStringLiteral("wallet_topup");
+}
+
+std::optional<CaptchaService::Challenge> CaptchaService::createChallenge(const QString& scope,
+                                                                         const QString& client,
+                                                                         const QString& connection)
+{
+    const QString normalizedScope = scope.trimmed().toLower();
+    if (!isKnownScope(normalizedScope)) {
+        return std::nullopt;
+    }
+
+    const QString connectionScope = connection + QLatin1Char('/') + normalizedScope;
+    QUuid previous;
+    {
+        QMutexLocker locker(&clientMutex_);
+        previous = latestByConnectionScope_.value(connectionScope);
+    }
+    if (!previous.isNull()) {
+        discard(previous);
+    }
+
+    const qint64 now = nowMs();
+    // The client count spans every shard, but each shard only drops its own
+    // expired entries when touched; sweep them all before refusing.
+    if (!reserveClientSlot(client)) {
+        cleanupAllExpired(now);
+        if (!reserveClientSlot(client)) {
+            return std::nullopt;
+        }
+    }
+
+    // One draw covers both operands; the global generator is shared by all threads.
+    constexpr quint32 kOperandRange = kMaxOperandExclusive - kMinOperand;
+    const quint32 random = QRandomGenerator::global()->generate();
+    const int left = kMinOperand + static_cast<int>((random & 0xFFFF) % kOperandRange);
+    const int right = kMinOperand + static_cast<int>((random >> 16) % kOperandRange);
+
+    const QUuid nonce = QUuid::createUuid();
+    const qint64 expiresAtMs = now + kTtlSeconds * 1000LL;
+
+    Shard& shard = shardFor(nonce);
+    {
+        QMutexLocker locker(&shard.mutex);
+        cleanupExpiredLocked(shard, now);
+
+        if (shard.outstandingByScope.value(normalizedScope) >= maxOutstandingPerShard_) {
+            releaseClientSlot(client);
+            return std::nullopt;
+        }
+        ++shard.outstandingByScope[normalizedScope];
+        {
+            QMutexLocker clientLocker(&clientMutex_);
+            latestByConnectionScope_.insert(connectionScope, nonce);
+        }
+
+        shard.challenges.insert(nonce, CaptchaEntry{left + right, normalizedScope, client, connectionScope, expiresAtMs});
+        shard.expiryHeap.push_back(ExpiryItem{expiresAtMs, nonce});
+        std::push_heap(shard.expiryHeap.begin(), shard.expiryHeap.end(), std::greater<>{});
+    }
 
     Challenge challenge;
-    challenge.nonce = QUuid::createUuid().toString(QUuid::WithoutBraces);
-    challenge.scope = scope.trimmed().toLower();
+    challenge.nonce = nonce.toString(QUuid::WithoutBraces);
+    challenge.scope = normalizedScope;
     challenge.challengeText = QStringLiteral("%1 + %2 = ?").arg(left).arg(right);
     challenge.expiresAt = QDateTime::currentDateTimeUtc().addSecs(kTtlSeconds);
-
-    QMutexLocker locker(&mutex_);
-    cleanupExpiredLocked(QDateTime::currentDateTimeUtc());
-    challenges_.insert(challenge.nonce,
-                       CaptchaEntry{left + right, challenge.scope, challenge.expiresAt});
-
     return challenge;
 }
 
@@ -34,24 +97,33 @@ bool CaptchaService::verifyAndConsume(const QString& nonce,
                                       const QString& scope,
                                       QString* failureReason)
 {
-    const QString normalizedNonce = nonce.trimmed();
+    const QUuid key = QUuid::fromString(QStringView(nonce).trimmed());
     const QString normalizedScope = scope.trimmed().toLower();
-    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const qint64 now = nowMs();
 
-    QMutexLocker locker(&mutex_);
-    cleanupExpiredLocked(now);
+    CaptchaEntry entry;
+    bool found = false;
+    if (!key.isNull()) {
+        Shard& shard = shardFor(key);
+        QMutexLocker locker(&shard.mutex);
+        cleanupExpiredLocked(shard, now);
 
-    auto it = challenges_.find(normalizedNonce);
-    if (it == challenges_.end()) {
+        auto it = shard.challenges.find(key);
+        if (it != shard.challenges.end()) {
+            entry = it.value();
+            found = true;
+            eraseLocked(shard, it);
+            compactHeapLocked(shard);
+        }
+    }
+
+    if (!found) {
         if (failureReason) {
             *failureReason = QStringLiteral("CAPTCHA challenge is missing or expired");
         }
         return false;
     }
 
-    const CaptchaEntry entry = it.value();
-    challenges_.erase(it);
-
     if (entry.scope != normalizedScope) {
         if (failureReason) {
             *failureReason = QStringLiteral("CAPTCHA scope is invalid");
@@ -59,7 +131,7 @@ bool CaptchaService::verifyAndConsume(const QString& nonce,
         return false;
     }
 
-    if (entry.expiresAt < now) {
+    if (entry.expiresAtMs < now) {
         if (failureReason) {
             *failureReason = QStringLiteral("CAPTCHA challenge expired");
         }
@@ -76,13 +148,100 @@ bool CaptchaService::verifyAndConsume(const QString& nonce,
     return true;
 }
 
-void CaptchaService::cleanupExpiredLocked(const QDateTime& now)
+CaptchaService::Shard& CaptchaService::shardFor(const QUuid& nonce)
+{
+    return shards_[nonce.data1 % kShardCount];
+}
+
+qint64 CaptchaService::nowMs() const
 {
-    for (auto it = challenges_.begin(); it != challenges_.end();) {
-        if (it.value().expiresAt < now) {
-            it = challenges_.erase(it);
-        } else {
-            ++it;
+    return clock_.elapsed();
+}
+
+void CaptchaService::eraseLocked(Shard& shard, QHash<QUuid, CaptchaEntry>::iterator it)
+{
+    auto scopeIt = shard.outstandingByScope.find(it->scope);
+    if (scopeIt != shard.outstandingByScope.end() && --scopeIt.value() <= 0) {
+        shard.outstandingByScope.erase(scopeIt);
+    }
+    {
+        QMutexLocker locker(&clientMutex_);
+        auto clientIt = outstandingByClient_.find(it->client);
+        if (clientIt != outstandingByClient_.end() && --clientIt.value() <= 0) {
+            outstandingByClient_.erase(clientIt);
+        }
+        auto latestIt = latestByConnectionScope_.find(it->connectionScope);
+        if (latestIt != latestByConnectionScope_.end() && latestIt.value() == it.key()) {
+            latestByConnectionScope_.erase(latestIt);
+        }
+    }
+    shard.challenges.erase(it);
+}
+
+bool CaptchaService::reserveClientSlot(const QString& client)
+{
+    QMutexLocker locker(&clientMutex_);
+    int& outstanding = outstandingByClient_[client];
+    if (outstanding >= maxOutstandingPerClient_) {
+        return false;
+    }
+    ++outstanding;
+    return true;
+}
+
+void CaptchaService::releaseClientSlot(const QString& client)
+{
+    QMutexLocker locker(&clientMutex_);
+    auto it = outstandingByClient_.find(client);
+    if (it != outstandingByClient_.end() && --it.value() <= 0) {
+        outstandingByClient_.erase(it);
+    }
+}
+
+void CaptchaService::discard(const QUuid& nonce)
+{
+    Shard& shard = shardFor(nonce);
+    QMutexLocker locker(&shard.mutex);
+    auto it = shard.challenges.find(nonce);
+    if (it != shard.challenges.end()) {
+        eraseLocked(shard, it);
+        compactHeapLocked(shard);
+    }
+}
+
+void CaptchaService::cleanupAllExpired(qint64 nowMs)
+{
+    for (Shard& shard : shards_) {
+        QMutexLocker locker(&shard.mutex);
+        cleanupExpiredLocked(shard, nowMs);
+    }
+}
+
+void CaptchaService::compactHeapLocked(Shard& shard)
+{
+    const std::size_t live = static_cast<std::size_t>(shard.challenges.size());
+    if (shard.expiryHeap.size() < kMinHeapToCompact || shard.expiryHeap.size() <= 2 * live) {
+        return;
+    }
+
+    shard.expiryHeap.clear();
+    shard.expiryHeap.reserve(live);
+    for (auto it = shard.challenges.cbegin(); it != shard.challenges.cend(); ++it) {
+        shard.expiryHeap.push_back(ExpiryItem{it->expiresAtMs, it.key()});
+    }
+    std::make_heap(shard.expiryHeap.begin(), shard.expiryHeap.end(), std::greater<>{});
+}
+
+void CaptchaService::cleanupExpiredLocked(Shard& shard, qint64 nowMs)
+{
+    while (!shard.expiryHeap.empty() && shard.expiryHeap.front().expiresAtMs < nowMs) {
+        const QUuid nonce = shard.expiryHeap.front().nonce;
+        std::pop_heap(shard.expiryHeap.begin(), shard.expiryHeap.end(), std::greater<>{});
+        shard.expiryHeap.pop_back();
+
+        auto it = shard.challenges.find(nonce);
+        if (it != shard.challenges.end()) {
+            eraseLocked(shard, it);
         }
     }
 }
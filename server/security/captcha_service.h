@@ -1,14 +1,23 @@
 #ifndef CAPTCHA_SERVICE_H
 #define CAPTCHA_SERVICE_H
 
+#include <array>
+#include <optional>
+#include <vector>
+
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QMutex>
 #include <QString>
+#include <QUuid>
 
 class CaptchaService
 {
 public:
+    static constexpr int kDefaultMaxOutstandingPerScope = 16384;
+    static constexpr int kDefaultMaxOutstandingPerClient = 32;
+
     struct Challenge {
         QString nonce;
         QString challengeText;
@@ -16,23 +25,74 @@ public:
         QDateTime expiresAt;
     };
 
-    Challenge createChallenge(const QString& scope);
+    explicit CaptchaService(int maxOutstandingPerScope = kDefaultMaxOutstandingPerScope,
+                            int maxOutstandingPerClient = kDefaultMaxOutstandingPerClient);
+
+    // Scopes some request actually verifies; challenges for others are refused.
+    static bool isKnownScope(const QString& scope);
+
+    // Returns nullopt when the scope is unknown, or when the scope or the
+    // client (identified by its address) already has the maximum number of
+    // unanswered challenges outstanding. A new challenge replaces the one the
+    // same connection was last given for the scope.
+    std::optional<Challenge> createChallenge(const QString& scope,
+                                             const QString& client,
+                                             const QString& connection);
     bool verifyAndConsume(const QString& nonce,
                           int answer,
                           const QString& scope,
                           QString* failureReason = nullptr);
 
 private:
+    static constexpr int kShardCount = 16;
+
     struct CaptchaEntry {
         int answer = 0;
         QString scope;
-        QDateTime expiresAt;
+        QString client;
+        QString connectionScope;
+        qint64 expiresAtMs = 0;
     };
 
-    void cleanupExpiredLocked(const QDateTime& now);
+    struct ExpiryItem {
+        qint64 expiresAtMs = 0;
+        QUuid nonce;
+
+        bool operator>(const ExpiryItem& other) const { return expiresAtMs > other.expiresAtMs; }
+    };
+
+    // Nonces are random UUIDs, so shards fill evenly and the scope cap is
+    // split between them. The heap may hold nonces that were already
+    // consumed; they are dropped when they reach the top, and the heap is
+    // rebuilt once they outnumber the live challenges.
+    struct alignas(64) Shard {
+        QMutex mutex;
+        QHash<QUuid, CaptchaEntry> challenges;
+        std::vector<ExpiryItem> expiryHeap;
+        QHash<QString, int> outstandingByScope;
+    };
+
+    Shard& shardFor(const QUuid& nonce);
+    qint64 nowMs() const;
+    void eraseLocked(Shard& shard, QHash<QUuid, CaptchaEntry>::iterator it);
+    void cleanupExpiredLocked(Shard& shard, qint64 nowMs);
+    static void compactHeapLocked(Shard& shard);
+    bool reserveClientSlot(const QString& client);
+    void releaseClientSlot(const QString& client);
+    void discard(const QUuid& nonce);
+    void cleanupAllExpired(qint64 nowMs);
+
+    const int maxOutstandingPerShard_;
+    const int maxOutstandingPerClient_;
+    QElapsedTimer clock_;
+    std::array<Shard, kShardCount> shards_;
 
-    QHash<QString, CaptchaEntry> challenges_;
-    QMutex mutex_;
+    // Across all shards, so one client cannot exhaust a scope. Lock order is
+    // shard, then client.
+    QMutex clientMutex_;
+    QHash<QString, int> outstandingByClient_;
+    // Latest nonce handed to each connection, keyed by connection and scope.
+    QHash<QString, QUuid> latestByConnectionScope_;
 };
 
 #endif // CAPTCHA_SERVICE_H
@@ -0,0 +1,96 @@
+#include "kdf_worker_pool.h"
+
+#include "password_hasher.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+KdfWorkerPool::KdfWorkerPool(int threadCount, int maxQueueDepth, QObject* parent)
+    : QObject(parent),
+      maxQueueDepth_(qMax(1, maxQueueDepth))
+{
+    if (threadCount <= 0) {
+        threadCount = qMax(1, QThread::idealThreadCount() / 2);
+    }
+    pool_.setMaxThreadCount(threadCount);
+    pool_.setObjectName(QStringLiteral("kalanet-kdf"));
+}
+
+KdfWorkerPool::~KdfWorkerPool()
+{
+    pool_.clear();
+    pool_.waitForDone();
+}
+
+bool KdfWorkerPool::verify(const QString& password,
+                           const QString& storedHash,
+                           std::function<void(bool, QString)> done)
+{
+    return submit<VerifyResult>(
+        [password, storedHash]() {
+            VerifyResult result;
+            result.valid = PasswordHasher::verify(password, storedHash, &result.upgradedHash);
+            return result;
+        },
+        [done = std::move(done)](VerifyResult result) { done(result.valid, result.upgradedHash); });
+}
+
+bool KdfWorkerPool::hash(const QString& password, std::function<void(QString)> done)
+{
+    return submit<QString>([password]() { return PasswordHasher::hash(password); }, std::move(done));
+}
+
+KdfWorkerPool::Metrics KdfWorkerPool::metrics() const
+{
+    Metrics result;
+    result.threadCount = pool_.maxThreadCount();
+    result.maxQueueDepth = maxQueueDepth_;
+    result.inFlight = inFlight_.load(std::memory_order_relaxed);
+    result.peakInFlight = peakInFlight_.load(std::memory_order_relaxed);
+    result.completed = completed_.load(std::memory_order_relaxed);
+    result.rejected = rejected_.load(std::memory_order_relaxed);
+    if (result.completed > 0) {
+        result.averageWaitMs = totalWaitUs_.load(std::memory_order_relaxed) / 1000.0 / result.completed;
+        result.averageRunMs = totalRunUs_.load(std::memory_order_relaxed) / 1000.0 / result.completed;
+    }
+    return result;
+}
+
+template <typename Result>
+bool KdfWorkerPool::submit(std::function<Result()> work, std::function<void(Result)> done)
+{
+    int current = inFlight_.load(std::memory_order_relaxed);
+    do {
+        if (current >= maxQueueDepth_) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!inFlight_.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+
+    int peak = peakInFlight_.load(std::memory_order_relaxed);
+    while (peak < current + 1 && !peakInFlight_.compare_exchange_weak(peak, current + 1, std::memory_order_relaxed)) {
+    }
+
+    QElapsedTimer queued;
+    queued.start();
+    pool_.start([this, queued, work = std::move(work), done = std::move(done)]() mutable {
+        const qint64 waitUs = queued.nsecsElapsed() / 1000;
+        QElapsedTimer running;
+        running.start();
+        Result result = work();
+        const qint64 runUs = running.nsecsElapsed() / 1000;
+
+        totalWaitUs_.fetch_add(waitUs, std::memory_order_relaxed);
+        totalRunUs_.fetch_add(runUs, std::memory_order_relaxed);
+        completed_.fetch_add(1, std::memory_order_relaxed);
+        inFlight_.fetch_sub(1, std::memory_order_relaxed);
+
+        // The destructor drains the pool, so `this` outlives every job; a
+        // completion still queued at destruction is dropped with the context.
+        QMetaObject::invokeMethod(
+            this,
+            [done = std::move(done), result = std::move(result)]() { done(result); },
+            Qt::QueuedConnection);
+    });
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef KDF_WORKER_POOL_H
+#define KDF_WORKER_POOL_H
+
+#include <atomic>
+#include <functional>
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+// Runs password hashing off the dispatcher thread. Completions are posted
+// back to the thread that owns the pool, so callers may touch repositories
+// and sockets from them. Submissions beyond the queue limit are rejected
+// rather than queued, which keeps a login burst from starving other traffic.
+class KdfWorkerPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kDefaultMaxQueueDepth = 64;
+
+    struct Metrics {
+        int threadCount = 0;
+        int maxQueueDepth = 0;
+        int inFlight = 0;
+        int peakInFlight = 0;
+        qint64 completed = 0;
+        qint64 rejected = 0;
+        double averageWaitMs = 0.0;
+        double averageRunMs = 0.0;
+    };
+
+    explicit KdfWorkerPool(int threadCount = 0,
+                           int maxQueueDepth = kDefaultMaxQueueDepth,
+                           QObject* parent = nullptr);
+    ~KdfWorkerPool() override;
+
+    // Both return false, without calling done, when the queue is full.
+    // verify passes a replacement hash when the stored one is due for an upgrade.
+    bool verify(const QString& password,
+                const QString& storedHash,
+                std::function<void(bool, QString)> done);
+    bool hash(const QString& password, std::function<void(QString)> done);
+
+    Metrics metrics() const;
+
+private:
+    struct VerifyResult {
+        bool valid = false;
+        QString upgradedHash;
+    };
+
+    template <typename Result>
+    bool submit(std::function<Result()> work, std::function<void(Result)> done);
+
+    QThreadPool pool_;
+    const int maxQueueDepth_;
+    std::atomic<int> inFlight_{0};
+    std::atomic<int> peakInFlight_{0};
+    std::atomic<qint64> completed_{0};
+    std::atomic<qint64> rejected_{0};
+    std::atomic<qint64> totalWaitUs_{0};
+    std::atomic<qint64> totalRunUs_{0};
+};
+
+#endif // KDF_WORKER_POOL_H
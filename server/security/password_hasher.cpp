@@ -1,12 +1,17 @@
 #include "password_hasher.h"
 
-#include <QCryptographicHash>
+#include "simd/sha256.h"
+
 #include <QRandomGenerator>
 #include <QStringList>
 
+#include <cstring>
+
 namespace {
-constexpr auto kScheme = "knet_sha256";
-constexpr int kDefaultIterations = 120000;
+constexpr auto kScheme = "pbkdf2_sha256";
+constexpr int kDefaultIterations = 310000;
+constexpr int kDerivedKeyBytes = 32;
+constexpr auto kLegacyScheme = "knet_sha256";
 constexpr int kSaltLengthBytes = 16;
 
 QByteArray generateSalt()
@@ -18,65 +23,124 @@ QByteArray generateSalt()
     return salt;
 }
 
-QByteArray sha256(const QByteArray& input)
+const unsigned char* bytes(const QByteArray& data)
 {
-    return QCryptographicHash::hash(input, QCryptographicHash::Sha256);
+    return reinterpret_cast<const unsigned char*>(data.constData());
+}
+
+QByteArray pbkdf2(const QByteArray& password, const QByteArray& salt, int iterations)
+{
+    QByteArray derived(kDerivedKeyBytes, Qt::Uninitialized);
+    common::simd::pbkdf2HmacSha256(bytes(password),
+                                   static_cast<std::size_t>(password.size()),
+                                   bytes(salt),
+                                   static_cast<std::size_t>(salt.size()),
+                                   static_cast<unsigned int>(iterations),
+                                   reinterpret_cast<unsigned char*>(derived.data()),
+                                   static_cast<std::size_t>(derived.size()));
+    return derived;
+}
+
+// knet_sha256: digest_i = SHA256(digest_{i-1} || salt || password). Kept only
+// to verify old rows; the working buffer is laid out once and the digest is
+// rewritten in place each round.
+QByteArray legacyDerive(const QByteArray& password, const QByteArray& salt, int iterations)
+{
+    constexpr int kDigestBytes = static_cast<int>(common::simd::kSha256DigestSize);
+    QByteArray buffer(kDigestBytes + salt.size() + password.size(), Qt::Uninitialized);
+    unsigned char* data = reinterpret_cast<unsigned char*>(buffer.data());
+    std::memcpy(data + kDigestBytes, salt.constData(), static_cast<std::size_t>(salt.size()));
+    std::memcpy(data + kDigestBytes + salt.size(), password.constData(), static_cast<std::size_t>(password.size()));
+
+    common::simd::sha256(data + kDigestBytes, static_cast<std::size_t>(salt.size() + password.size()), data);
+    for (int i = 1; i < iterations; ++i) {
+        common::simd::sha256(data, static_cast<std::size_t>(buffer.size()), data);
+    }
+
+    buffer.truncate(kDigestBytes);
+    return buffer;
 }
 }
 
 QString PasswordHasher::hash(const QString& rawPassword)
 {
     const QByteArray salt = generateSalt();
-    const QString digestHex = deriveHash(rawPassword, salt, kDefaultIterations);
+    const QByteArray derived = pbkdf2(rawPassword.toUtf8(), salt, kDefaultIterations);
 
     return QStringLiteral("%1$%2$%3$%4")
         .arg(QString::fromLatin1(kScheme))
         .arg(kDefaultIterations)
         .arg(QString::fromLatin1(salt.toHex()))
-        .arg(digestHex);
+        .arg(QString::fromLatin1(derived.toHex()));
 }
 
-bool PasswordHasher::verify(const QString& rawPassword, const QString& storedHash)
+bool PasswordHasher::verify(const QString& rawPassword, const QString& storedHash, QString* upgradedHash)
 {
+    const QByteArray passwordBytes = rawPassword.toUtf8();
     const QStringList parts = storedHash.split('$');
+
+    bool valid = false;
     if (parts.size() == 4 && parts[0] == QLatin1String(kScheme)) {
-        bool ok = false;
-        const int iterations = parts[1].toInt(&ok);
-        if (!ok || iterations <= 0) {
-            return false;
-        }
-
-        const QByteArray salt = QByteArray::fromHex(parts[2].toLatin1());
-        const QByteArray expected = QByteArray::fromHex(parts[3].toLatin1());
-        if (salt.isEmpty() || expected.isEmpty()) {
-            return false;
-        }
-
-        const QByteArray actual = QByteArray::fromHex(
-            deriveHash(rawPassword, salt, iterations).toLatin1());
-        return constantTimeEquals(actual, expected);
+        valid = verifyPbkdf2(passwordBytes, parts);
+    } else if (parts.size() == 4 && parts[0] == QLatin1String(kLegacyScheme)) {
+        valid = verifyLegacy(passwordBytes, parts);
+    } else {
+        unsigned char digest[common::simd::kSha256DigestSize];
+        common::simd::sha256(bytes(passwordBytes), static_cast<std::size_t>(passwordBytes.size()), digest);
+        const QByteArray rawSha256Hex = QByteArray::fromRawData(reinterpret_cast<const char*>(digest),
+                                                                sizeof(digest)).toHex();
+        const QByteArray storedBytes = storedHash.toUtf8();
+        valid = constantTimeEquals(storedBytes, passwordBytes) ||
+                constantTimeEquals(storedBytes, rawSha256Hex);
     }
 
-    const QByteArray storedBytes = storedHash.toUtf8();
-    const QByteArray rawBytes = rawPassword.toUtf8();
-    const QByteArray rawSha256Hex = sha256(rawBytes).toHex();
+    if (valid && upgradedHash && needsRehash(storedHash)) {
+        *upgradedHash = hash(rawPassword);
+    }
+    return valid;
+}
 
-    return constantTimeEquals(storedBytes, rawBytes) ||
-           constantTimeEquals(storedBytes, rawSha256Hex);
+bool PasswordHasher::needsRehash(const QString& storedHash)
+{
+    const QStringList parts = storedHash.split('$');
+    if (parts.size() != 4 || parts[0] != QLatin1String(kScheme)) {
+        return true;
+    }
+    return parts[1].toInt() < kDefaultIterations;
 }
 
-QString PasswordHasher::deriveHash(const QString& rawPassword,
-                                   const QByteArray& salt,
-                                   int iterations)
+bool PasswordHasher::verifyPbkdf2(const QByteArray& password, const QStringList& parts)
 {
-    const QByteArray passwordBytes = rawPassword.toUtf8();
+    bool ok = false;
+    const int iterations = parts[1].toInt(&ok);
+    if (!ok || iterations <= 0) {
+        return false;
+    }
 
-    QByteArray digest = sha256(salt + passwordBytes);
-    for (int i = 1; i < iterations; ++i) {
-        digest = sha256(digest + salt + passwordBytes);
+    const QByteArray salt = QByteArray::fromHex(parts[2].toLatin1());
+    const QByteArray expected = QByteArray::fromHex(parts[3].toLatin1());
+    if (salt.isEmpty() || expected.size() != kDerivedKeyBytes) {
+        return false;
+    }
+
+    return constantTimeEquals(pbkdf2(password, salt, iterations), expected);
+}
+
+bool PasswordHasher::verifyLegacy(const QByteArray& password, const QStringList& parts)
+{
+    bool ok = false;
+    const int iterations = parts[1].toInt(&ok);
+    if (!ok || iterations <= 0) {
+        return false;
+    }
+
+    const QByteArray salt = QByteArray::fromHex(parts[2].toLatin1());
+    const QByteArray expected = QByteArray::fromHex(parts[3].toLatin1());
+    if (salt.isEmpty() || expected.isEmpty()) {
+        return false;
     }
 
-    return QString::fromLatin1(digest.toHex());
+    return constantTimeEquals(legacyDerive(password, salt, iterations), expected);
 }
 
 bool PasswordHasher::constantTimeEquals(const QByteArray& lhs,
@@ -2,17 +2,24 @@
 #define PASSWORD_HASHER_H
 
 #include <QString>
+#include <QStringList>
 
 class PasswordHasher
 {
 public:
     static QString hash(const QString& rawPassword);
-    static bool verify(const QString& rawPassword, const QString& storedHash);
+
+    // When the password matches a hash stored with a legacy scheme or fewer
+    // iterations than current policy, upgradedHash receives a fresh hash that
+    // the caller should persist.
+    static bool verify(const QString& rawPassword,
+                       const QString& storedHash,
+                       QString* upgradedHash = nullptr);
+    static bool needsRehash(const QString& storedHash);
 
 private:
-    static QString deriveHash(const QString& rawPassword,
-                              const QByteArray& salt,
-                              int iterations);
+    static bool verifyPbkdf2(const QByteArray& password, const QStringList& parts);
+    static bool verifyLegacy(const QByteArray& password, const QStringList& parts);
     static bool constantTimeEquals(const QByteArray& lhs,
                                    const QByteArray& rhs);
 };
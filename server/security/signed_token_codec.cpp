@@ -0,0 +1,166 @@
+#include "signed_token_codec.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMessageAuthenticationCode>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace {
+constexpr auto kTokenPrefix = "v1.";
+constexpr auto kKeyLabel = "kalanet.session.";
+constexpr qsizetype kMaxTokenLength = 1024;
+
+constexpr QByteArray::Base64Options kBase64UrlOptions =
+    QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+
+bool constantTimeEquals(const QByteArray& lhs, const QByteArray& rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+
+    unsigned char diff = 0;
+    for (qsizetype i = 0; i < lhs.size(); ++i) {
+        diff |= static_cast<unsigned char>(lhs[i] ^ rhs[i]);
+    }
+    return diff == 0;
+}
+
+std::optional<QByteArray> decodeBase64Url(QByteArrayView encoded)
+{
+    const auto result = QByteArray::fromBase64Encoding(encoded.toByteArray(),
+                                                       kBase64UrlOptions | QByteArray::AbortOnBase64DecodingErrors);
+    if (!result) {
+        return std::nullopt;
+    }
+    return result.decoded;
+}
+}
+
+SignedTokenCodec::SignedTokenCodec(const QByteArray& secret, qint64 keyRotationSecs)
+    : masterKey_(secret.isEmpty() ? QByteArray() : QCryptographicHash::hash(secret, QCryptographicHash::Sha256)),
+      keyRotationSecs_(qMax<qint64>(60, keyRotationSecs))
+{
+}
+
+bool SignedTokenCodec::isSignedToken(QStringView token)
+{
+    return token.startsWith(QLatin1String(kTokenPrefix));
+}
+
+qint64 SignedTokenCodec::currentSecs()
+{
+    return QDateTime::currentSecsSinceEpoch();
+}
+
+QString SignedTokenCodec::issue(const QString& username,
+                                const QString& role,
+                                const QUuid& tokenId,
+                                qint64 issuedAt,
+                                qint64 expiresAt) const
+{
+    if (!isEnabled()) {
+        return {};
+    }
+
+    const qint64 epoch = currentSecs() / keyRotationSecs_;
+    const QJsonObject claims{
+        {QStringLiteral("u"), username},
+        {QStringLiteral("r"), role},
+        {QStringLiteral("jti"), tokenId.toString(QUuid::WithoutBraces)},
+        {QStringLiteral("iat"), issuedAt},
+        {QStringLiteral("exp"), expiresAt},
+        {QStringLiteral("kid"), epoch},
+    };
+
+    QByteArray signingInput(kTokenPrefix);
+    signingInput.append(QJsonDocument(claims).toJson(QJsonDocument::Compact).toBase64(kBase64UrlOptions));
+
+    const QByteArray signature = QMessageAuthenticationCode::hash(signingInput,
+                                                                  keyForEpoch(epoch),
+                                                                  QCryptographicHash::Sha256);
+    signingInput.append('.');
+    signingInput.append(signature.toBase64(kBase64UrlOptions));
+    return QString::fromLatin1(signingInput);
+}
+
+std::optional<SignedTokenCodec::Claims> SignedTokenCodec::verify(QStringView token, qint64 now) const
+{
+    if (!isEnabled() || !isSignedToken(token) || token.size() > kMaxTokenLength) {
+        return std::nullopt;
+    }
+
+    const QByteArray bytes = token.toLatin1();
+    const qsizetype signatureDot = bytes.lastIndexOf('.');
+    const qsizetype prefixLength = static_cast<qsizetype>(qstrlen(kTokenPrefix));
+    if (signatureDot <= prefixLength) {
+        return std::nullopt;
+    }
+
+    const QByteArrayView signingInput(bytes.constData(), signatureDot);
+    const std::optional<QByteArray> signature = decodeBase64Url(QByteArrayView(bytes).sliced(signatureDot + 1));
+    const std::optional<QByteArray> claimsJson =
+        decodeBase64Url(QByteArrayView(bytes).sliced(prefixLength, signatureDot - prefixLength));
+    if (!signature || !claimsJson) {
+        return std::nullopt;
+    }
+
+    const QJsonObject claims = QJsonDocument::fromJson(*claimsJson).object();
+    const qint64 epoch = claims.value(QStringLiteral("kid")).toInteger(-1);
+    const qint64 currentEpoch = now / keyRotationSecs_;
+    if (epoch != currentEpoch && epoch != currentEpoch - 1) {
+        return std::nullopt;
+    }
+
+    const QByteArray expected = QMessageAuthenticationCode::hash(signingInput.toByteArray(),
+                                                                 keyForEpoch(epoch),
+                                                                 QCryptographicHash::Sha256);
+    if (!constantTimeEquals(expected, *signature)) {
+        return std::nullopt;
+    }
+
+    Claims result;
+    result.username = claims.value(QStringLiteral("u")).toString();
+    result.role = claims.value(QStringLiteral("r")).toString();
+    result.tokenId = QUuid::fromString(claims.value(QStringLiteral("jti")).toString());
+    result.issuedAt = claims.value(QStringLiteral("iat")).toInteger();
+    result.expiresAt = claims.value(QStringLiteral("exp")).toInteger();
+    result.keyEpoch = epoch;
+
+    if (result.username.isEmpty() || result.tokenId.isNull() || result.expiresAt <= now) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+void SignedTokenCodec::revoke(const QUuid& tokenId, qint64 expiresAt)
+{
+    const qint64 now = currentSecs();
+    QWriteLocker locker(&revokedLock_);
+    for (auto it = revoked_.begin(); it != revoked_.end();) {
+        if (it.value() <= now) {
+            it = revoked_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (expiresAt > now) {
+        revoked_.insert(tokenId, expiresAt);
+    }
+}
+
+bool SignedTokenCodec::isRevoked(const QUuid& tokenId) const
+{
+    QReadLocker locker(&revokedLock_);
+    return revoked_.contains(tokenId);
+}
+
+QByteArray SignedTokenCodec::keyForEpoch(qint64 epoch) const
+{
+    return QMessageAuthenticationCode::hash(QByteArray(kKeyLabel) + QByteArray::number(epoch),
+                                            masterKey_,
+                                            QCryptographicHash::Sha256);
+}
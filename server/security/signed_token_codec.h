@@ -0,0 +1,59 @@
+#ifndef SIGNED_TOKEN_CODEC_H
+#define SIGNED_TOKEN_CODEC_H
+
+#include <optional>
+
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringView>
+#include <QUuid>
+
+// Stateless session tokens: "v1.<base64url claims>.<base64url HMAC-SHA256>".
+// Signing keys are derived per epoch from a shared secret, so any process
+// holding the secret can verify a token without a session lookup. Tokens
+// signed under the current or the previous epoch are accepted.
+class SignedTokenCodec
+{
+public:
+    static constexpr qint64 kDefaultKeyRotationSecs = 24 * 60 * 60;
+
+    struct Claims {
+        QString username;
+        QString role;
+        QUuid tokenId;
+        qint64 issuedAt = 0;
+        qint64 expiresAt = 0;
+        qint64 keyEpoch = 0;
+    };
+
+    explicit SignedTokenCodec(const QByteArray& secret,
+                              qint64 keyRotationSecs = kDefaultKeyRotationSecs);
+
+    bool isEnabled() const { return !masterKey_.isEmpty(); }
+    static bool isSignedToken(QStringView token);
+    static qint64 currentSecs();
+
+    QString issue(const QString& username,
+                  const QString& role,
+                  const QUuid& tokenId,
+                  qint64 issuedAt,
+                  qint64 expiresAt) const;
+    std::optional<Claims> verify(QStringView token, qint64 now) const;
+
+    // Revocations are held until the token would have expired anyway.
+    void revoke(const QUuid& tokenId, qint64 expiresAt);
+    bool isRevoked(const QUuid& tokenId) const;
+
+private:
+    QByteArray keyForEpoch(qint64 epoch) const;
+
+    QByteArray masterKey_;
+    qint64 keyRotationSecs_;
+
+    mutable QReadWriteLock revokedLock_;
+    QHash<QUuid, qint64> revoked_;
+};
+
+#endif // SIGNED_TOKEN_CODEC_H
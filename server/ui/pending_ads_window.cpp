@@ -6,7 +6,6 @@
 #include <QMessageBox>
 #include <QPixmap>
 #include <QSignalBlocker>
-#include <QSet>
 #include <QStandardItemModel>
 
 #include "ui_pending_ads_window.h"
@@ -191,29 +190,22 @@ void PendingAdsWindow::loadCategoryFilter()
 {
     const QSignalBlocker blocker(ui->comboBoxCategoryFilter);
 
-    QString currentSelection = ui->comboBoxCategoryFilter->currentText();
+    const QString currentSelection = ui->comboBoxCategoryFilter->currentData().toString();
     ui->comboBoxCategoryFilter->clear();
-    ui->comboBoxCategoryFilter->addItem(tr("All Categories"));
+    ui->comboBoxCategoryFilter->addItem(tr("All Categories"), QString());
 
-    AdRepository::AdListFilters filters;
-    filters.sortField = AdRepository::AdListSortField::Title;
-    filters.sortOrder = AdRepository::SortOrder::Asc;
-
-    const auto allAds = adRepository_.listAdsForModeration(filters, QStringLiteral("all"), false, {}, {});
-    QSet<QString> categories;
-    for (const auto& ad : allAds) {
-        if (!ad.category.trimmed().isEmpty()) {
-            categories.insert(ad.category.trimmed());
+    const QVector<AdRepository::CategoryRecord> categories = adRepository_.listCategories();
+    for (const auto& category : categories) {
+        if (category.adCount <= 0) {
+            continue;
         }
+        ui->comboBoxCategoryFilter->addItem(tr("%1 (%2)")
+                                                .arg(category.name)
+                                                .arg(category.adCount),
+                                            category.name);
     }
 
-    QStringList sorted = categories.values();
-    sorted.sort(Qt::CaseInsensitive);
-    for (const QString& category : sorted) {
-        ui->comboBoxCategoryFilter->addItem(category);
-    }
-
-    const int restoredIndex = ui->comboBoxCategoryFilter->findText(currentSelection);
+    const int restoredIndex = ui->comboBoxCategoryFilter->findData(currentSelection);
     if (restoredIndex >= 0) {
         ui->comboBoxCategoryFilter->setCurrentIndex(restoredIndex);
     }
@@ -241,10 +233,7 @@ void PendingAdsWindow::loadPendingAds()
 {
     AdRepository::AdListFilters filters;
     filters.nameContains = ui->lineEditSearch->text().trimmed();
-    const QString category = ui->comboBoxCategoryFilter->currentText().trimmed();
-    if (category.compare(tr("All Categories"), Qt::CaseInsensitive) != 0) {
-        filters.category = category;
-    }
+    filters.category = ui->comboBoxCategoryFilter->currentData().toString();
 
     const int maxPrice = ui->spinBoxMaxPrice->value();
     if (maxPrice > 0) {
@@ -345,15 +334,16 @@ void PendingAdsWindow::loadAdDetail(int adId)
     ui->labelTagsValue->setText(tr("N/A"));
     ui->textBrowserDescription->setText(ad->description);
 
-    if (ad->imageBytes.isEmpty()) {
+    const auto image = adRepository_.openImage(ad->imageSha256);
+    if (!image) {
         ui->labelImagePreview->setText(tr("No image available"));
         ui->labelImagePreview->setPixmap(QPixmap());
-        ui->labelImagePath->setText(tr("Path: [stored in database]"));
+        ui->labelImagePath->setText(tr("Path: N/A"));
     } else {
         QPixmap preview;
-        preview.loadFromData(ad->imageBytes);
+        preview.loadFromData(image->bytes());
         ui->labelImagePreview->setPixmap(preview.scaled(ui->labelImagePreview->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        ui->labelImagePath->setText(tr("Path: [binary image in database]"));
+        ui->labelImagePath->setText(tr("Path: %1").arg(image->path()));
     }
 
     const auto history = adRepository_.getStatusHistory(adId);
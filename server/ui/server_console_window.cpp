@@ -123,8 +123,17 @@ void ServerConsoleWindow::populateCommandFilter() {
         tr("Ad List Result"),
         tr("Ad Detail"),
         tr("Ad Detail Result"),
+        tr("Ad Detail Batch"),
+        tr("Ad Detail Batch Result"),
+        tr("Ad Thumbnail Batch"),
+        tr("Ad Thumbnail Batch Result"),
         tr("Ad Status Update"),
         tr("Ad Status Notify"),
+        tr("Ad Upload Init"),
+        tr("Ad Upload Init Result"),
+        tr("Ad Upload Chunk"),
+        tr("Ad Upload Chunk Result"),
+        tr("Ad Upload Commit"),
         tr("Category List"),
         tr("Category List Result"),
         tr("Cart Add Item"),
@@ -152,6 +161,8 @@ void ServerConsoleWindow::populateCommandFilter() {
         tr("Discount Code Upsert Result"),
         tr("Discount Code Delete"),
         tr("Discount Code Delete Result"),
+        tr("Batch"),
+        tr("Batch Result"),
         tr("System Notification"),
         tr("Error")
     };
@@ -396,8 +407,17 @@ QString ServerConsoleWindow::mapCommandToText(common::Command command) const
     case common::Command::AdListResult:         return tr("Ad List Result");
     case common::Command::AdDetail:             return tr("Ad Detail");
     case common::Command::AdDetailResult:       return tr("Ad Detail Result");
+    case common::Command::AdDetailBatch:        return tr("Ad Detail Batch");
+    case common::Command::AdDetailBatchResult:  return tr("Ad Detail Batch Result");
+    case common::Command::AdThumbnailBatch:     return tr("Ad Thumbnail Batch");
+    case common::Command::AdThumbnailBatchResult:return tr("Ad Thumbnail Batch Result");
     case common::Command::AdStatusUpdate:       return tr("Ad Status Update");
     case common::Command::AdStatusNotify:       return tr("Ad Status Notify");
+    case common::Command::AdUploadInit:         return tr("Ad Upload Init");
+    case common::Command::AdUploadInitResult:   return tr("Ad Upload Init Result");
+    case common::Command::AdUploadChunk:        return tr("Ad Upload Chunk");
+    case common::Command::AdUploadChunkResult:  return tr("Ad Upload Chunk Result");
+    case common::Command::AdUploadCommit:       return tr("Ad Upload Commit");
     case common::Command::CategoryList:         return tr("Category List");
     case common::Command::CategoryListResult:   return tr("Category List Result");
     case common::Command::CartAddItem:          return tr("Cart Add Item");
@@ -425,6 +445,8 @@ QString ServerConsoleWindow::mapCommandToText(common::Command command) const
     case common::Command::DiscountCodeUpsertResult:return tr("Discount Code Upsert Result");
     case common::Command::DiscountCodeDelete:   return tr("Discount Code Delete");
     case common::Command::DiscountCodeDeleteResult:return tr("Discount Code Delete Result");
+    case common::Command::Batch:                return tr("Batch");
+    case common::Command::BatchResult:          return tr("Batch Result");
     case common::Command::SystemNotification:   return tr("System Notification");
     }
     return tr("Unknown (%1)").arg(static_cast<int>(command));